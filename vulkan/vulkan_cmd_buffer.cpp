@@ -4,16 +4,18 @@
 //
 
 inline vk_commands VkCommandsCreate(VkDevice Device, VkCommandPool Pool, platform_block_arena* Arena, u32 FlushAlignment,
-                                    u32 StagingTypeId)
+                                    u32 StagingTypeId, VkCommandBufferLevel Level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                    u64 StagingBlockSize = MegaBytes(64), b32 StagingIsCoherent = false)
 {
     vk_commands Result = {};
 
     VkCommandBufferAllocateInfo CmdBufferAllocateInfo = {};
     CmdBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     CmdBufferAllocateInfo.commandPool = Pool;
-    CmdBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    CmdBufferAllocateInfo.level = Level;
     CmdBufferAllocateInfo.commandBufferCount = 1;
     VkCheckResult(vkAllocateCommandBuffers(Device, &CmdBufferAllocateInfo, &Result.Buffer));
+    Result.IsSecondary = Level == VK_COMMAND_BUFFER_LEVEL_SECONDARY;
 
     VkFenceCreateInfo FenceCreateInfo = {};
     FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
@@ -32,30 +34,66 @@ inline vk_commands VkCommandsCreate(VkDevice Device, VkCommandPool Pool, platfor
         Result.BufferTransferArena = BlockArenaCreate(Arena);
         Result.ImageTransferArena = BlockArenaCreate(Arena);
         Result.FlushAlignment = FlushAlignment;
-        Result.StagingArena = VkStagingArenaCreate(Device, MegaBytes(64), FlushAlignment, StagingTypeId);
+        Result.StagingArena = VkStagingArenaCreate(Device, StagingBlockSize, FlushAlignment, StagingTypeId, StagingIsCoherent);
+    }
+
+    // NOTE: Init Readback Data
+    {
+        Result.BufferReadbackArena = BlockArenaCreate(Arena);
+        Result.ImageReadbackArena = BlockArenaCreate(Arena);
     }
     
     return Result;
 }
 
-inline void VkCommandsBegin(vk_commands* Commands, VkDevice Device)
+inline f32 VkCommandsFenceWait(vk_commands* Commands, VkDevice Device)
 {
+    // NOTE: Returns how long we blocked in ms
+    LARGE_INTEGER Frequency, StartTime, EndTime;
+    QueryPerformanceFrequency(&Frequency);
+    QueryPerformanceCounter(&StartTime);
+    
     VkCheckResult(vkWaitForFences(Device, 1, &Commands->Fence, VK_TRUE, 0xFFFFFFFF));
+
+    QueryPerformanceCounter(&EndTime);
+    f32 Result = f32(f64(EndTime.QuadPart - StartTime.QuadPart) * 1000.0 / f64(Frequency.QuadPart));
+    return Result;
+}
+
+inline void VkCommandsBeginSignaled(vk_commands* Commands, VkDevice Device)
+{
+    // IMPORTANT: The fence must already be signaled, use VkCommandsBegin if you don't know
     VkCheckResult(vkResetFences(Device, 1, &Commands->Fence));
 
     // NOTE: Clear our staging buffer if it was populated before
     ArenaClear(&Commands->StagingArena);
+
+    // NOTE: The gpu is done with the last submit, so its readbacks are complete and their memory gets reused
+    Commands->ReadbackArena.Used = 0;
+    Commands->Generation += 1;
+    VkCommandsEventPoolReset(Commands, Device);
     
     VkCommandBufferBeginInfo BeginInfo = {};
     BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     VkCheckResult(vkBeginCommandBuffer(Commands->Buffer, &BeginInfo));
+
+    Commands->LastFrameBindStats = Commands->BindStats;
+    Commands->BindStats = {};
+    VkCommandsBindStateReset(Commands);
+}
+
+inline void VkCommandsBegin(vk_commands* Commands, VkDevice Device)
+{
+    Commands->FenceWaitMs = VkCommandsFenceWait(Commands, Device);
+    VkCommandsBeginSignaled(Commands, Device);
 }
 
 inline void VkCommandsEnd(vk_commands* Commands, VkDevice Device)
 {
     VkCommandsBarrierFlush(Commands);
     VkCommandsTransferFlush(Commands, Device);
+    VkCommandsReadbackFlush(Commands);
     VkCheckResult(vkEndCommandBuffer(Commands->Buffer));
 }
 
@@ -64,6 +102,7 @@ inline void VkCommandsSubmit(vk_commands* Commands, VkDevice Device, VkQueue Que
     // NOTE: Flush any remaining barriers/transfers
     VkCommandsBarrierFlush(Commands);
     VkCommandsTransferFlush(Commands, Device);
+    VkCommandsReadbackFlush(Commands);
     
     VkCheckResult(vkEndCommandBuffer(Commands->Buffer));
 
@@ -74,6 +113,766 @@ inline void VkCommandsSubmit(vk_commands* Commands, VkDevice Device, VkQueue Que
     VkCheckResult(vkQueueSubmit(Queue, 1, &SubmitInfo, Commands->Fence));
 }
 
+//
+// NOTE: Command Ring
+//
+
+inline vk_commands_ring VkCommandsRingCreate(VkDevice Device, VkCommandPool Pool, linear_arena* Arena, platform_block_arena* BlockArena,
+                                             u32 NumContexts, u32 FlushAlignment, u32 StagingTypeId, b32 StagingIsCoherent = false)
+{
+    vk_commands_ring Result = {};
+    Result.NumContexts = NumContexts;
+    Result.Contexts = PushArray(Arena, vk_commands, NumContexts);
+    for (u32 ContextId = 0; ContextId < NumContexts; ++ContextId)
+    {
+        Result.Contexts[ContextId] = VkCommandsCreate(Device, Pool, BlockArena, FlushAlignment, StagingTypeId,
+                                                      VK_COMMAND_BUFFER_LEVEL_PRIMARY, MegaBytes(64), StagingIsCoherent);
+    }
+
+    // NOTE: Acquire advances before using a context, so the first acquire gets context 0
+    Result.CurrContextId = NumContexts - 1;
+    
+    return Result;
+}
+
+inline vk_commands* VkCommandsRingTryAcquire(vk_commands_ring* Ring, VkDevice Device)
+{
+    // NOTE: Returns 0 if the gpu still owns the next context, lets the caller do other work instead of blocking
+    vk_commands* Result = 0;
+    
+    u32 NextContextId = (Ring->CurrContextId + 1) % Ring->NumContexts;
+    vk_commands* Next = Ring->Contexts + NextContextId;
+    VkResult FenceStatus = vkGetFenceStatus(Device, Next->Fence);
+    if (FenceStatus == VK_SUCCESS)
+    {
+        Next->FenceWaitMs = 0.0f;
+        VkCommandsBeginSignaled(Next, Device);
+        
+        Ring->CurrContextId = NextContextId;
+        Ring->Stats.NumAcquires += 1;
+        Ring->Stats.LastWaitMs = 0.0f;
+        Result = Next;
+    }
+    else
+    {
+        Assert(FenceStatus == VK_NOT_READY);
+        Ring->Stats.NumTryFails += 1;
+    }
+
+    return Result;
+}
+
+inline vk_commands* VkCommandsRingAcquire(vk_commands_ring* Ring, VkDevice Device)
+{
+    u32 NextContextId = (Ring->CurrContextId + 1) % Ring->NumContexts;
+    vk_commands* Result = Ring->Contexts + NextContextId;
+
+    b32 Stalled = vkGetFenceStatus(Device, Result->Fence) == VK_NOT_READY;
+    VkCommandsBegin(Result, Device);
+
+    vk_commands_ring_stats* Stats = &Ring->Stats;
+    Stats->NumAcquires += 1;
+    Stats->NumStalls += Stalled ? 1 : 0;
+    Stats->LastWaitMs = Result->FenceWaitMs;
+    Stats->MaxWaitMs = Max(Stats->MaxWaitMs, Result->FenceWaitMs);
+    Stats->TotalWaitMs += Result->FenceWaitMs;
+    
+    Ring->CurrContextId = NextContextId;
+
+    return Result;
+}
+
+inline vk_commands* VkCommandsRingGetCurr(vk_commands_ring* Ring)
+{
+    vk_commands* Result = Ring->Contexts + Ring->CurrContextId;
+    return Result;
+}
+
+inline void VkCommandsRingWaitIdle(vk_commands_ring* Ring, VkDevice Device)
+{
+    // NOTE: Useful before resizing or destroying resources the ring might still reference
+    for (u32 ContextId = 0; ContextId < Ring->NumContexts; ++ContextId)
+    {
+        VkCheckResult(vkWaitForFences(Device, 1, &Ring->Contexts[ContextId].Fence, VK_TRUE, 0xFFFFFFFF));
+    }
+}
+
+//
+// NOTE: Parallel Recording
+//
+
+/*
+   NOTE: Each recording thread owns a command pool and a secondary vk_commands, so barrier and transfer batches never
+         get shared between threads. Usage per frame:
+
+         - Main thread: VkCommandsParallelReset once the primary's fence signaled (keep one parallel set per frame in flight)
+         - Thread N: VkCommandsSecondaryBegin(Parallel->Threads + N, ...), record, VkCommandsSecondaryEnd
+         - Main thread: after joining the threads, VkCommandsParallelExecute into the primary
+
+         Secondaries that inherit a render pass can only record draws, so their barriers and transfers are not
+         allowed. Secondaries without a render pass can record anything and must be executed outside of one. Threads
+         that didn't record this frame get skipped, every thread that did has to match the primary's render pass state.
+*/
+
+inline vk_commands_parallel VkCommandsParallelCreate(VkDevice Device, u32 QueueFamilyIndex, linear_arena* Arena,
+                                                     platform_block_arena* BlockArenas, u32 NumThreads, u32 FlushAlignment,
+                                                     u32 StagingTypeId, u64 StagingBlockSize = MegaBytes(4),
+                                                     b32 StagingIsCoherent = false)
+{
+    // IMPORTANT: BlockArenas needs one platform arena per thread since they aren't thread safe
+    vk_commands_parallel Result = {};
+    Result.NumThreads = NumThreads;
+    Result.Pools = PushArray(Arena, VkCommandPool, NumThreads);
+    Result.Threads = PushArray(Arena, vk_commands, NumThreads);
+    Result.Buffers = PushArray(Arena, VkCommandBuffer, NumThreads);
+
+    for (u32 ThreadId = 0; ThreadId < NumThreads; ++ThreadId)
+    {
+        VkCommandPoolCreateInfo PoolCreateInfo = {};
+        PoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        PoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        PoolCreateInfo.queueFamilyIndex = QueueFamilyIndex;
+        VkCheckResult(vkCreateCommandPool(Device, &PoolCreateInfo, 0, Result.Pools + ThreadId));
+
+        Result.Threads[ThreadId] = VkCommandsCreate(Device, Result.Pools[ThreadId], BlockArenas + ThreadId, FlushAlignment,
+                                                    StagingTypeId, VK_COMMAND_BUFFER_LEVEL_SECONDARY, StagingBlockSize,
+                                                    StagingIsCoherent);
+        Result.Buffers[ThreadId] = Result.Threads[ThreadId].Buffer;
+    }
+    
+    return Result;
+}
+
+inline void VkCommandsParallelReset(vk_commands_parallel* Parallel, VkDevice Device)
+{
+    // IMPORTANT: The primary these secondaries were executed in must have finished on the gpu
+    for (u32 ThreadId = 0; ThreadId < Parallel->NumThreads; ++ThreadId)
+    {
+        VkCheckResult(vkResetCommandPool(Device, Parallel->Pools[ThreadId], 0));
+        ArenaClear(&Parallel->Threads[ThreadId].StagingArena);
+        Parallel->Threads[ThreadId].SecondaryRecorded = false;
+    }
+}
+
+inline void VkCommandsSecondaryBegin(vk_commands* Commands, VkRenderPass RenderPass = VK_NULL_HANDLE, u32 SubPass = 0,
+                                     VkFramebuffer Fbo = VK_NULL_HANDLE)
+{
+    VkCommandBufferInheritanceInfo InheritanceInfo = {};
+    InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    InheritanceInfo.renderPass = RenderPass;
+    InheritanceInfo.subpass = SubPass;
+    InheritanceInfo.framebuffer = Fbo;
+    
+    VkCommandBufferBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    BeginInfo.flags |= RenderPass != VK_NULL_HANDLE ? VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT : 0;
+    BeginInfo.pInheritanceInfo = &InheritanceInfo;
+    VkCheckResult(vkBeginCommandBuffer(Commands->Buffer, &BeginInfo));
+
+    Commands->InsideRenderPass = RenderPass != VK_NULL_HANDLE;
+
+    // NOTE: Secondaries don't inherit any bound state
+    Commands->LastFrameBindStats = Commands->BindStats;
+    Commands->BindStats = {};
+    VkCommandsBindStateReset(Commands);
+}
+
+inline void VkCommandsSecondaryEnd(vk_commands* Commands, VkDevice Device)
+{
+    // NOTE: Secondaries don't own a fence the gpu signals, so they can't hand out readbacks
+    Assert(Commands->NumBufferReadbacks == 0 && Commands->NumImageReadbacks == 0);
+
+    if (Commands->InsideRenderPass)
+    {
+        Assert(Commands->NumMemoryBarriers == 0 && Commands->NumBufferBarriers == 0 && Commands->NumImageBarriers == 0);
+        Assert(Commands->NumBufferTransfers == 0 && Commands->NumImageTransfers == 0);
+    }
+    else
+    {
+        VkCommandsBarrierFlush(Commands);
+        VkCommandsTransferFlush(Commands, Device);
+    }
+    
+    VkCheckResult(vkEndCommandBuffer(Commands->Buffer));
+    Commands->SecondaryRecorded = true;
+    Commands->SecondaryInsideRenderPass = Commands->InsideRenderPass;
+    Commands->InsideRenderPass = false;
+}
+
+inline void VkCommandsParallelExecute(vk_commands* Primary, vk_commands_parallel* Parallel, b32 InsideRenderPass)
+{
+    // NOTE: InsideRenderPass is true if the primary is inside a render pass begun with
+    // VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS. Executed in thread index order so the result doesn't depend on
+    // which thread finished first
+    if (InsideRenderPass)
+    {
+        Assert(Primary->NumMemoryBarriers == 0 && Primary->NumBufferBarriers == 0 && Primary->NumImageBarriers == 0);
+    }
+    else
+    {
+        VkCommandsBarrierFlush(Primary);
+    }
+
+    u32 NumRecorded = 0;
+    for (u32 ThreadId = 0; ThreadId < Parallel->NumThreads; ++ThreadId)
+    {
+        vk_commands* Thread = Parallel->Threads + ThreadId;
+        if (Thread->SecondaryRecorded)
+        {
+            Assert(Thread->SecondaryInsideRenderPass == InsideRenderPass);
+            Parallel->Buffers[NumRecorded++] = Thread->Buffer;
+        }
+    }
+
+    if (NumRecorded == 0)
+    {
+        return;
+    }
+    
+    vkCmdExecuteCommands(Primary->Buffer, NumRecorded, Parallel->Buffers);
+
+    // NOTE: Bound state is undefined after executing secondaries
+    VkCommandsBindStateReset(Primary);
+}
+
+inline void VkCommandsParallelDestroy(vk_commands_parallel* Parallel, VkDevice Device)
+{
+    // IMPORTANT: The primary these secondaries were executed in must have finished on the gpu
+    for (u32 ThreadId = 0; ThreadId < Parallel->NumThreads; ++ThreadId)
+    {
+        vk_commands* Thread = Parallel->Threads + ThreadId;
+
+        // NOTE: Hand the blocks back to the platform block arena and free the staging memory
+        ArenaClear(&Thread->MemoryBarrierArena);
+        ArenaClear(&Thread->BufferBarrierArena);
+        ArenaClear(&Thread->ImageBarrierArena);
+        ArenaClear(&Thread->BufferTransferArena);
+        ArenaClear(&Thread->ImageTransferArena);
+        ArenaClear(&Thread->BufferReadbackArena);
+        ArenaClear(&Thread->ImageReadbackArena);
+        ArenaClear(&Thread->StagingArena);
+
+        vkDestroyFence(Device, Thread->Fence, 0);
+        vkDestroyCommandPool(Device, Parallel->Pools[ThreadId], 0);
+    }
+}
+
+//
+// NOTE: Bundles
+//
+
+/*
+   NOTE: Usage:
+
+         - if (!VkBundleIsValid(Bundle, RenderPass)) { record between VkBundleRecordBegin and VkBundleRecordEnd }
+         - VkBundleExecute(Primary, Bundle) every frame
+
+         While recording, register every vk_pipeline with VkBundlePipelineAdd and every resource that can get recreated
+         (images, buffers, views, descriptor sets) with VkBundleResourceAdd, passing a generation counter that its owner
+         bumps on every recreate. Raw handles can't be compared since the driver is free to hand a destroyed handle's
+         value out again. Shader hot reload bumps vk_pipeline::Generation, which invalidates the bundle the next time
+         it gets validated.
+
+         IMPORTANT: Re-recording resets the bundle's pool, so frames in flight that executed it must have finished. Wait
+         on them (VkCommandsRingWaitIdle) before re-recording, invalidation is rare enough for that to be fine.
+*/
+
+inline vk_bundle VkBundleCreate(VkDevice Device, u32 QueueFamilyIndex, platform_block_arena* BlockArena)
+{
+    vk_bundle Result = {};
+
+    VkCommandPoolCreateInfo PoolCreateInfo = {};
+    PoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    PoolCreateInfo.queueFamilyIndex = QueueFamilyIndex;
+    VkCheckResult(vkCreateCommandPool(Device, &PoolCreateInfo, 0, &Result.Pool));
+
+    // NOTE: Bundles can't record transfers so the staging arena never allocates
+    Result.Commands = VkCommandsCreate(Device, Result.Pool, BlockArena, 1, 0, VK_COMMAND_BUFFER_LEVEL_SECONDARY, 0);
+
+    return Result;
+}
+
+inline vk_commands* VkBundleRecordBegin(vk_bundle* Bundle, VkDevice Device, VkRenderPass RenderPass = VK_NULL_HANDLE, u32 SubPass = 0)
+{
+    VkCheckResult(vkResetCommandPool(Device, Bundle->Pool, 0));
+
+    Bundle->Recorded = false;
+    Bundle->RenderPass = RenderPass;
+    Bundle->SubPass = SubPass;
+    Bundle->NumPipelines = 0;
+    Bundle->NumResources = 0;
+
+    VkCommandBufferInheritanceInfo InheritanceInfo = {};
+    InheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    InheritanceInfo.renderPass = RenderPass;
+    InheritanceInfo.subpass = SubPass;
+    InheritanceInfo.framebuffer = VK_NULL_HANDLE;
+
+    // NOTE: Simultaneous use since multiple frames in flight execute the same buffer
+    VkCommandBufferBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    BeginInfo.flags |= RenderPass != VK_NULL_HANDLE ? VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT : 0;
+    BeginInfo.pInheritanceInfo = &InheritanceInfo;
+    VkCheckResult(vkBeginCommandBuffer(Bundle->Commands.Buffer, &BeginInfo));
+
+    Bundle->Commands.InsideRenderPass = RenderPass != VK_NULL_HANDLE;
+    Bundle->Commands.BindStats = {};
+    VkCommandsBindStateReset(&Bundle->Commands);
+
+    return &Bundle->Commands;
+}
+
+inline void VkBundlePipelineAdd(vk_bundle* Bundle, vk_pipeline* Pipeline)
+{
+    Assert(Bundle->NumPipelines < VK_BUNDLE_MAX_PIPELINES);
+    vk_bundle_pipeline_ref* Ref = Bundle->Pipelines + Bundle->NumPipelines++;
+    Ref->Pipeline = Pipeline;
+    Ref->RecordedGeneration = Pipeline->Generation;
+}
+
+inline void VkBundleResourceAdd(vk_bundle* Bundle, u32* Generation)
+{
+    Assert(Bundle->NumResources < VK_BUNDLE_MAX_RESOURCES);
+    vk_bundle_resource_ref* Ref = Bundle->Resources + Bundle->NumResources++;
+    Ref->Generation = Generation;
+    Ref->RecordedGeneration = *Generation;
+}
+
+inline void VkBundleRecordEnd(vk_bundle* Bundle)
+{
+    vk_commands* Commands = &Bundle->Commands;
+    Assert(Commands->NumBufferTransfers == 0 && Commands->NumImageTransfers == 0);
+    if (Commands->InsideRenderPass)
+    {
+        Assert(Commands->NumMemoryBarriers == 0 && Commands->NumBufferBarriers == 0 && Commands->NumImageBarriers == 0);
+    }
+    else
+    {
+        VkCommandsBarrierFlush(Commands);
+    }
+
+    VkCheckResult(vkEndCommandBuffer(Commands->Buffer));
+    Bundle->Recorded = true;
+    Bundle->NumRecords += 1;
+}
+
+inline void VkBundleInvalidate(vk_bundle* Bundle)
+{
+    Bundle->Recorded = false;
+}
+
+inline b32 VkBundleIsValid(vk_bundle* Bundle, VkRenderPass RenderPass = VK_NULL_HANDLE, u32 SubPass = 0)
+{
+    b32 Result = Bundle->Recorded && Bundle->RenderPass == RenderPass && Bundle->SubPass == SubPass;
+
+    for (u32 PipelineId = 0; PipelineId < Bundle->NumPipelines && Result; ++PipelineId)
+    {
+        vk_bundle_pipeline_ref* Ref = Bundle->Pipelines + PipelineId;
+        Result = Ref->Pipeline->Generation == Ref->RecordedGeneration;
+    }
+
+    for (u32 ResourceId = 0; ResourceId < Bundle->NumResources && Result; ++ResourceId)
+    {
+        vk_bundle_resource_ref* Ref = Bundle->Resources + ResourceId;
+        Result = *Ref->Generation == Ref->RecordedGeneration;
+    }
+
+    if (!Result)
+    {
+        Bundle->Recorded = false;
+    }
+
+    return Result;
+}
+
+inline void VkBundleExecute(vk_commands* Primary, vk_bundle* Bundle)
+{
+    Assert(Bundle->Recorded);
+    VkCommandsBarrierFlush(Primary);
+    vkCmdExecuteCommands(Primary->Buffer, 1, &Bundle->Commands.Buffer);
+    Bundle->NumExecutes += 1;
+
+    // NOTE: Bound state is undefined after executing secondaries
+    VkCommandsBindStateReset(Primary);
+}
+
+inline void VkBundleDestroy(vk_bundle* Bundle, VkDevice Device)
+{
+    vkDestroyFence(Device, Bundle->Commands.Fence, 0);
+    vkDestroyCommandPool(Device, Bundle->Pool, 0);
+}
+
+//
+// NOTE: Submit Queue
+//
+
+inline void VkSubmitQueueBatchSubmit(vk_submit_queue* Queue, VkSubmitInfo* SubmitInfos, VkFence* Fences, u32 NumSubmits)
+{
+    if (NumSubmits == 0)
+    {
+        return;
+    }
+
+    VkCheckResult(vkQueueSubmit(Queue->Queue, NumSubmits, SubmitInfos, Fences[NumSubmits - 1]));
+    for (u32 SubmitId = 0; SubmitId < NumSubmits - 1; ++SubmitId)
+    {
+        // NOTE: Signals once everything submitted before it finished, which covers this entry's command buffer
+        VkCheckResult(vkQueueSubmit(Queue->Queue, 0, 0, Fences[SubmitId]));
+    }
+
+    InterlockedExchangeAdd(&Queue->NumQueueSubmits, LONG(NumSubmits));
+    InterlockedExchangeAdd(&Queue->NumFenceSubmits, LONG(NumSubmits - 1));
+    InterlockedExchangeAdd(&Queue->NumCommandsSubmitted, LONG(NumSubmits));
+}
+
+internal DWORD WINAPI VkSubmitThreadEntry(LPVOID Param)
+{
+    vk_submit_queue* Queue = (vk_submit_queue*)Param;
+
+    VkSubmitInfo SubmitInfos[VK_SUBMIT_QUEUE_SIZE];
+    VkFence Fences[VK_SUBMIT_QUEUE_SIZE];
+    
+    while (true)
+    {
+        WaitForSingleObject(Queue->WakeSemaphore, INFINITE);
+
+        // NOTE: Drain everything that is ready, entries stay claimed until their submit went out. Ids are unsigned here
+        // so they wrap instead of going negative
+        ULONG FirstReadId = ULONG(Queue->NextReadId);
+        ULONG ReadId = FirstReadId;
+        u32 NumSubmits = 0;
+        while (ReadId != ULONG(Queue->NextWriteId))
+        {
+            vk_submit_entry* Entry = Queue->Entries + (ReadId % VK_SUBMIT_QUEUE_SIZE);
+            if (!Entry->Ready)
+            {
+                break;
+            }
+
+            if (Entry->Type == VkSubmitEntry_Commands)
+            {
+                VkSubmitInfo* SubmitInfo = SubmitInfos + NumSubmits;
+                *SubmitInfo = {};
+                SubmitInfo->sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                SubmitInfo->waitSemaphoreCount = Entry->NumWaitSemaphores;
+                SubmitInfo->pWaitSemaphores = Entry->WaitSemaphores;
+                SubmitInfo->pWaitDstStageMask = Entry->WaitStages;
+                SubmitInfo->commandBufferCount = 1;
+                SubmitInfo->pCommandBuffers = &Entry->Buffer;
+                SubmitInfo->signalSemaphoreCount = Entry->NumSignalSemaphores;
+                SubmitInfo->pSignalSemaphores = Entry->SignalSemaphores;
+                Fences[NumSubmits] = Entry->Fence;
+                NumSubmits += 1;
+            }
+            else if (Entry->Type == VkSubmitEntry_Present)
+            {
+                // NOTE: Presents have to come after the submits that render the image
+                VkSubmitQueueBatchSubmit(Queue, SubmitInfos, Fences, NumSubmits);
+                NumSubmits = 0;
+
+                VkPresentInfoKHR PresentInfo = {};
+                PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+                PresentInfo.waitSemaphoreCount = Entry->NumWaitSemaphores;
+                PresentInfo.pWaitSemaphores = Entry->WaitSemaphores;
+                PresentInfo.swapchainCount = 1;
+                PresentInfo.pSwapchains = &Entry->SwapChain;
+                PresentInfo.pImageIndices = &Entry->ImageIndex;
+                InterlockedExchange(&Queue->LastPresentResult, LONG(vkQueuePresentKHR(Queue->Queue, &PresentInfo)));
+            }
+            else
+            {
+                InvalidCodePath;
+            }
+
+            ReadId += 1;
+        }
+
+        VkSubmitQueueBatchSubmit(Queue, SubmitInfos, Fences, NumSubmits);
+
+        // NOTE: Hand the slots back to the producers
+        for (ULONG EntryId = FirstReadId; EntryId != ReadId; ++EntryId)
+        {
+            InterlockedExchange(&Queue->Entries[EntryId % VK_SUBMIT_QUEUE_SIZE].Ready, 0);
+        }
+        InterlockedExchange(&Queue->NextReadId, LONG(ReadId));
+
+        if (!Queue->Running && Queue->NextReadId == Queue->NextWriteId)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+inline vk_submit_queue* VkSubmitQueueCreate(linear_arena* Arena, VkQueue VulkanQueue)
+{
+    vk_submit_queue* Result = PushStruct(Arena, vk_submit_queue);
+    *Result = {};
+    Result->Queue = VulkanQueue;
+    Result->Running = 1;
+    Result->WakeSemaphore = CreateSemaphoreExA(0, 0, LONG_MAX, 0, 0, SEMAPHORE_ALL_ACCESS);
+    Assert(Result->WakeSemaphore);
+    Result->Thread = CreateThread(0, 0, VkSubmitThreadEntry, Result, 0, 0);
+    Assert(Result->Thread);
+
+    return Result;
+}
+
+inline vk_submit_entry* VkSubmitQueueEntryClaim(vk_submit_queue* Queue)
+{
+    ULONG EntryId = ULONG(InterlockedIncrement(&Queue->NextWriteId)) - 1;
+
+    // NOTE: Only spins if producers got a whole ring ahead of the submit thread, there is no lock to block on
+    while (EntryId - ULONG(Queue->NextReadId) >= VK_SUBMIT_QUEUE_SIZE)
+    {
+        SwitchToThread();
+    }
+
+    vk_submit_entry* Result = Queue->Entries + (EntryId % VK_SUBMIT_QUEUE_SIZE);
+    Assert(!Result->Ready);
+    return Result;
+}
+
+inline void VkSubmitQueueEntryPublish(vk_submit_queue* Queue, vk_submit_entry* Entry)
+{
+    InterlockedExchange(&Entry->Ready, 1);
+    ReleaseSemaphore(Queue->WakeSemaphore, 1, 0);
+}
+
+inline void VkSubmitQueuePush(vk_submit_queue* Queue, VkCommandBuffer Buffer, VkFence Fence, u32 NumWaitSemaphores = 0,
+                              VkSemaphore* WaitSemaphores = 0, VkPipelineStageFlags* WaitStages = 0, u32 NumSignalSemaphores = 0,
+                              VkSemaphore* SignalSemaphores = 0)
+{
+    // NOTE: Queues an already ended command buffer, for code that records outside of vk_commands
+    Assert(NumWaitSemaphores <= VK_SUBMIT_MAX_SEMAPHORES && NumSignalSemaphores <= VK_SUBMIT_MAX_SEMAPHORES);
+
+    vk_submit_entry* Entry = VkSubmitQueueEntryClaim(Queue);
+    Entry->Type = VkSubmitEntry_Commands;
+    Entry->Buffer = Buffer;
+    Entry->Fence = Fence;
+    Entry->NumWaitSemaphores = NumWaitSemaphores;
+    for (u32 SemaphoreId = 0; SemaphoreId < NumWaitSemaphores; ++SemaphoreId)
+    {
+        Entry->WaitSemaphores[SemaphoreId] = WaitSemaphores[SemaphoreId];
+        Entry->WaitStages[SemaphoreId] = WaitStages[SemaphoreId];
+    }
+    Entry->NumSignalSemaphores = NumSignalSemaphores;
+    for (u32 SemaphoreId = 0; SemaphoreId < NumSignalSemaphores; ++SemaphoreId)
+    {
+        Entry->SignalSemaphores[SemaphoreId] = SignalSemaphores[SemaphoreId];
+    }
+
+    VkSubmitQueueEntryPublish(Queue, Entry);
+}
+
+inline void VkSubmitQueuePush(vk_submit_queue* Queue, vk_commands* Commands, VkDevice Device, u32 NumWaitSemaphores = 0,
+                              VkSemaphore* WaitSemaphores = 0, VkPipelineStageFlags* WaitStages = 0, u32 NumSignalSemaphores = 0,
+                              VkSemaphore* SignalSemaphores = 0)
+{
+    // NOTE: Ends Commands and queues it, the fence signals the same way as with VkCommandsSubmit
+    VkCommandsEnd(Commands, Device);
+    VkSubmitQueuePush(Queue, Commands->Buffer, Commands->Fence, NumWaitSemaphores, WaitSemaphores, WaitStages, NumSignalSemaphores,
+                      SignalSemaphores);
+}
+
+inline void VkSubmitQueuePresent(vk_submit_queue* Queue, VkSwapchainKHR SwapChain, u32 ImageIndex, u32 NumWaitSemaphores = 0,
+                                 VkSemaphore* WaitSemaphores = 0)
+{
+    // NOTE: The result shows up in LastPresentResult once the submit thread presented
+    Assert(NumWaitSemaphores <= VK_SUBMIT_MAX_SEMAPHORES);
+
+    vk_submit_entry* Entry = VkSubmitQueueEntryClaim(Queue);
+    Entry->Type = VkSubmitEntry_Present;
+    Entry->SwapChain = SwapChain;
+    Entry->ImageIndex = ImageIndex;
+    Entry->NumWaitSemaphores = NumWaitSemaphores;
+    Entry->NumSignalSemaphores = 0;
+    for (u32 SemaphoreId = 0; SemaphoreId < NumWaitSemaphores; ++SemaphoreId)
+    {
+        Entry->WaitSemaphores[SemaphoreId] = WaitSemaphores[SemaphoreId];
+    }
+
+    VkSubmitQueueEntryPublish(Queue, Entry);
+}
+
+inline void VkSubmitQueueFlush(vk_submit_queue* Queue)
+{
+    // NOTE: Waits until everything pushed so far reached the driver, not until the gpu finished it
+    ULONG TargetId = ULONG(Queue->NextWriteId);
+    while (LONG(ULONG(Queue->NextReadId) - TargetId) < 0)
+    {
+        SwitchToThread();
+    }
+}
+
+inline void VkSubmitQueueDestroy(vk_submit_queue* Queue)
+{
+    InterlockedExchange(&Queue->Running, 0);
+    ReleaseSemaphore(Queue->WakeSemaphore, 1, 0);
+    WaitForSingleObject(Queue->Thread, INFINITE);
+    CloseHandle(Queue->Thread);
+    CloseHandle(Queue->WakeSemaphore);
+}
+
+//
+// NOTE: Bind Filtering
+//
+
+/*
+   NOTE: The VkCommandsBind and VkCommandsSet functions skip calls that would bind what is already bound. If you record
+         binds on Commands->Buffer directly, call VkCommandsBindStateReset afterwards so the shadow doesn't go stale.
+*/
+
+inline void VkCommandsBindStateReset(vk_commands* Commands)
+{
+    Commands->BindState = {};
+}
+
+inline u32 VkBindPointGetId(VkPipelineBindPoint BindPoint)
+{
+    Assert(BindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS || BindPoint == VK_PIPELINE_BIND_POINT_COMPUTE);
+    u32 Result = BindPoint == VK_PIPELINE_BIND_POINT_COMPUTE ? 1 : 0;
+    return Result;
+}
+
+inline void VkCommandsBindPipeline(vk_commands* Commands, VkPipelineBindPoint BindPoint, VkPipeline Pipeline)
+{
+    u32 BindPointId = VkBindPointGetId(BindPoint);
+    if (Commands->BindState.Pipelines[BindPointId] == Pipeline)
+    {
+        Commands->BindStats.NumPipelineBindsElided += 1;
+        return;
+    }
+
+    vkCmdBindPipeline(Commands->Buffer, BindPoint, Pipeline);
+    Commands->BindState.Pipelines[BindPointId] = Pipeline;
+    Commands->BindStats.NumPipelineBinds += 1;
+
+    // NOTE: Binding a pipeline that has viewport or scissor as static state overwrites them, and we don't know which
+    // pipelines do, so the next set has to go through
+    if (BindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS)
+    {
+        Commands->BindState.ViewportValid = false;
+        Commands->BindState.ScissorValid = false;
+    }
+}
+
+inline void VkCommandsBindDescriptorSets(vk_commands* Commands, VkPipelineBindPoint BindPoint, VkPipelineLayout Layout,
+                                         u32 FirstSet, u32 NumSets, VkDescriptorSet* Sets, u32 NumDynamicOffsets = 0,
+                                         u32* DynamicOffsets = 0)
+{
+    Assert(FirstSet + NumSets <= VK_BIND_MAX_DESCRIPTOR_SETS);
+    u32 BindPointId = VkBindPointGetId(BindPoint);
+    vk_bind_state* State = &Commands->BindState;
+
+    // NOTE: We don't track set layout compatibility, a different pipeline layout invalidates everything we shadowed
+    if (State->Layouts[BindPointId] != Layout)
+    {
+        State->Layouts[BindPointId] = Layout;
+        for (u32 SetId = 0; SetId < VK_BIND_MAX_DESCRIPTOR_SETS; ++SetId)
+        {
+            State->DescriptorSets[BindPointId][SetId] = VK_NULL_HANDLE;
+        }
+    }
+
+    // NOTE: Dynamic offsets aren't shadowed so those binds always go through
+    b32 Redundant = NumDynamicOffsets == 0;
+    for (u32 SetId = 0; SetId < NumSets && Redundant; ++SetId)
+    {
+        Redundant = State->DescriptorSets[BindPointId][FirstSet + SetId] == Sets[SetId];
+    }
+
+    if (Redundant)
+    {
+        Commands->BindStats.NumDescriptorSetBindsElided += 1;
+        return;
+    }
+
+    vkCmdBindDescriptorSets(Commands->Buffer, BindPoint, Layout, FirstSet, NumSets, Sets, NumDynamicOffsets, DynamicOffsets);
+    for (u32 SetId = 0; SetId < NumSets; ++SetId)
+    {
+        State->DescriptorSets[BindPointId][FirstSet + SetId] = NumDynamicOffsets == 0 ? Sets[SetId] : VK_NULL_HANDLE;
+    }
+    Commands->BindStats.NumDescriptorSetBinds += 1;
+}
+
+inline void VkCommandsBindVertexBuffers(vk_commands* Commands, u32 FirstBinding, u32 NumBindings, VkBuffer* Buffers,
+                                        VkDeviceSize* Offsets)
+{
+    Assert(FirstBinding + NumBindings <= VK_BIND_MAX_VERTEX_BUFFERS);
+    vk_bind_state* State = &Commands->BindState;
+
+    b32 Redundant = true;
+    for (u32 BindingId = 0; BindingId < NumBindings && Redundant; ++BindingId)
+    {
+        Redundant = (State->VertexBuffers[FirstBinding + BindingId] == Buffers[BindingId] &&
+                     State->VertexOffsets[FirstBinding + BindingId] == Offsets[BindingId]);
+    }
+
+    if (Redundant)
+    {
+        Commands->BindStats.NumVertexBufferBindsElided += 1;
+        return;
+    }
+
+    vkCmdBindVertexBuffers(Commands->Buffer, FirstBinding, NumBindings, Buffers, Offsets);
+    for (u32 BindingId = 0; BindingId < NumBindings; ++BindingId)
+    {
+        State->VertexBuffers[FirstBinding + BindingId] = Buffers[BindingId];
+        State->VertexOffsets[FirstBinding + BindingId] = Offsets[BindingId];
+    }
+    Commands->BindStats.NumVertexBufferBinds += 1;
+}
+
+inline void VkCommandsBindIndexBuffer(vk_commands* Commands, VkBuffer Buffer, VkDeviceSize Offset, VkIndexType IndexType)
+{
+    vk_bind_state* State = &Commands->BindState;
+    if (State->IndexBuffer == Buffer && State->IndexOffset == Offset && State->IndexType == IndexType)
+    {
+        Commands->BindStats.NumIndexBufferBindsElided += 1;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(Commands->Buffer, Buffer, Offset, IndexType);
+    State->IndexBuffer = Buffer;
+    State->IndexOffset = Offset;
+    State->IndexType = IndexType;
+    Commands->BindStats.NumIndexBufferBinds += 1;
+}
+
+inline void VkCommandsSetViewport(vk_commands* Commands, VkViewport Viewport)
+{
+    vk_bind_state* State = &Commands->BindState;
+    if (State->ViewportValid && memcmp(&State->Viewport, &Viewport, sizeof(VkViewport)) == 0)
+    {
+        Commands->BindStats.NumDynamicStateSetsElided += 1;
+        return;
+    }
+
+    vkCmdSetViewport(Commands->Buffer, 0, 1, &Viewport);
+    State->ViewportValid = true;
+    State->Viewport = Viewport;
+    Commands->BindStats.NumDynamicStateSets += 1;
+}
+
+inline void VkCommandsSetScissor(vk_commands* Commands, VkRect2D Scissor)
+{
+    vk_bind_state* State = &Commands->BindState;
+    if (State->ScissorValid && memcmp(&State->Scissor, &Scissor, sizeof(VkRect2D)) == 0)
+    {
+        Commands->BindStats.NumDynamicStateSetsElided += 1;
+        return;
+    }
+
+    vkCmdSetScissor(Commands->Buffer, 0, 1, &Scissor);
+    State->ScissorValid = true;
+    State->Scissor = Scissor;
+    Commands->BindStats.NumDynamicStateSets += 1;
+}
+
 //
 // NOTE: Barriers
 //
@@ -87,9 +886,19 @@ inline barrier_mask BarrierMask(VkAccessFlags AccessMask, VkPipelineStageFlags S
     return Result;
 }
 
+inline void VkCommandsReadbackPendingFlush(vk_commands* Commands)
+{
+    // NOTE: Queued reads have to copy their sources before anything a new barrier orders, see the readback notes
+    if (Commands->NumBufferReadbacks != 0 || Commands->NumImageReadbacks != 0)
+    {
+        VkCommandsReadbackFlush(Commands);
+    }
+}
+
 inline void VkBarrierMemoryAdd(vk_commands* Commands, VkAccessFlags InputAccessMask, VkPipelineStageFlags InputStageMask,
                                VkAccessFlags OutputAccessMask, VkPipelineStageFlags OutputStageMask)
 {
+    VkCommandsReadbackPendingFlush(Commands);
     VkMemoryBarrier* Barrier = PushStruct(&Commands->MemoryBarrierArena, VkMemoryBarrier);
     Commands->NumMemoryBarriers += 1;
     
@@ -104,6 +913,7 @@ inline void VkBarrierMemoryAdd(vk_commands* Commands, VkAccessFlags InputAccessM
 inline void VkBarrierBufferAdd(vk_commands* Commands, VkBuffer Buffer, VkAccessFlags InputAccessMask, VkPipelineStageFlags InputStageMask,
                                VkAccessFlags OutputAccessMask, VkPipelineStageFlags OutputStageMask)
 {
+    VkCommandsReadbackPendingFlush(Commands);
     VkBufferMemoryBarrier* Barrier = PushStruct(&Commands->BufferBarrierArena, VkBufferMemoryBarrier);
     Commands->NumBufferBarriers += 1;
     
@@ -125,10 +935,11 @@ inline void VkBarrierBufferAdd(vk_commands* Commands, barrier_mask InputMask, ba
     VkBarrierBufferAdd(Commands, Buffer, InputMask.AccessMask, InputMask.StageMask, OutputMask.AccessMask, OutputMask.StageMask);
 }
 
-inline void VkBarrierImageAdd(vk_commands* Commands, VkImage Image, VkImageAspectFlags AspectFlags,
+inline void VkBarrierImageAdd(vk_commands* Commands, VkImage Image, VkImageSubresourceRange Range,
                               VkAccessFlags InputAccessMask, VkPipelineStageFlags InputStageMask, VkImageLayout InputLayout,
                               VkAccessFlags OutputAccessMask, VkPipelineStageFlags OutputStageMask, VkImageLayout OutputLayout)
 {
+    VkCommandsReadbackPendingFlush(Commands);
     VkImageMemoryBarrier* Barrier = PushStruct(&Commands->ImageBarrierArena, VkImageMemoryBarrier);
     Commands->NumImageBarriers += 1;
 
@@ -140,14 +951,31 @@ inline void VkBarrierImageAdd(vk_commands* Commands, VkImage Image, VkImageAspec
     Barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     Barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
     Barrier->image = Image;
-    Barrier->subresourceRange.aspectMask = AspectFlags;
-    Barrier->subresourceRange.baseMipLevel = 0;
-    Barrier->subresourceRange.levelCount = 1;
-    Barrier->subresourceRange.baseArrayLayer = 0;
-    Barrier->subresourceRange.layerCount = 1;
+    Barrier->subresourceRange = Range;
+
+    Commands->SrcStageFlags |= InputStageMask;
+    Commands->DstStageFlags |= OutputStageMask;
+}
+
+inline void VkBarrierImageAdd(vk_commands* Commands, VkImage Image, VkImageAspectFlags AspectFlags,
+                              VkAccessFlags InputAccessMask, VkPipelineStageFlags InputStageMask, VkImageLayout InputLayout,
+                              VkAccessFlags OutputAccessMask, VkPipelineStageFlags OutputStageMask, VkImageLayout OutputLayout)
+{
+    VkImageSubresourceRange Range = {};
+    Range.aspectMask = AspectFlags;
+    Range.baseMipLevel = 0;
+    Range.levelCount = 1;
+    Range.baseArrayLayer = 0;
+    Range.layerCount = 1;
+    VkBarrierImageAdd(Commands, Image, Range, InputAccessMask, InputStageMask, InputLayout, OutputAccessMask, OutputStageMask,
+                      OutputLayout);
+}
 
-    Commands->SrcStageFlags |= InputStageMask;
-    Commands->DstStageFlags |= OutputStageMask;
+inline void VkBarrierImageAdd(vk_commands* Commands, VkImage Image, VkImageSubresourceRange Range, barrier_mask InputMask,
+                              VkImageLayout InputLayout, barrier_mask OutputMask, VkImageLayout OutputLayout)
+{
+    VkBarrierImageAdd(Commands, Image, Range, InputMask.AccessMask, InputMask.StageMask, InputLayout, OutputMask.AccessMask,
+                      OutputMask.StageMask, OutputLayout);
 }
 
 inline void VkBarrierImageAdd(vk_commands* Commands, VkImage Image, VkImageAspectFlags AspectFlags, barrier_mask InputMask,
@@ -159,6 +987,8 @@ inline void VkBarrierImageAdd(vk_commands* Commands, VkImage Image, VkImageAspec
 
 inline void VkCommandsBarrierFlush(vk_commands* Commands)
 {
+    VkCommandsReadbackPendingFlush(Commands);
+
     // NOTE: Since we don't store completely contiguous arrays, we have to potentially do multiple barrier calls
     mm BlockSize = BlockArenaGetBlockSize(&Commands->MemoryBarrierArena);
     block* MemoryBlock = Commands->MemoryBarrierArena.Next;
@@ -201,6 +1031,150 @@ inline void VkCommandsBarrierFlush(vk_commands* Commands)
     ArenaClear(&Commands->ImageBarrierArena);
 }
 
+//
+// NOTE: Split Barriers
+//
+
+/*
+   NOTE: A split barrier signals an event right after the producer and only waits for it right before the consumer,
+         so independent work recorded in between can overlap with the producer instead of the gpu draining at a full
+         pipeline barrier.
+
+         vk_split_barrier Split = VkCommandsSplitBarrierSignal(Commands, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+         VkSplitBarrierBufferAdd(&Split, Buffer, SHADER_WRITE, SHADER_READ, FRAGMENT);
+         ... unrelated passes ...
+         VkCommandsSplitBarrierWait(Commands, &Split);
+
+         The barriers of the wait live on the vk_split_barrier, not in the batch, so flushes recorded between the
+         signal and the wait can't send them out early as a full pipeline barrier. Their input stage is always the
+         stage the event was signaled with. Events come from a per vk_commands pool that gets recycled when it begins
+         recording again, after the fence proved the gpu is done with them.
+*/
+
+inline void VkCommandsEventPoolCreate(vk_commands* Commands, VkDevice Device, u32 NumEvents = VK_COMMANDS_MAX_EVENTS)
+{
+    // NOTE: Secondaries never go through VkCommandsBeginSignaled, so nothing would recycle their events
+    Assert(!Commands->IsSecondary);
+    Assert(NumEvents <= VK_COMMANDS_MAX_EVENTS);
+
+    vk_event_pool* Pool = &Commands->EventPool;
+    *Pool = {};
+    Pool->NumEvents = NumEvents;
+    for (u32 EventId = 0; EventId < NumEvents; ++EventId)
+    {
+        VkEventCreateInfo CreateInfo = {};
+        CreateInfo.sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+        VkCheckResult(vkCreateEvent(Device, &CreateInfo, 0, Pool->Events + EventId));
+    }
+}
+
+inline void VkCommandsEventPoolDestroy(vk_commands* Commands, VkDevice Device)
+{
+    vk_event_pool* Pool = &Commands->EventPool;
+    for (u32 EventId = 0; EventId < Pool->NumEvents; ++EventId)
+    {
+        vkDestroyEvent(Device, Pool->Events[EventId], 0);
+    }
+    *Pool = {};
+}
+
+inline void VkCommandsEventPoolReset(vk_commands* Commands, VkDevice Device)
+{
+    // IMPORTANT: Only call once the gpu finished the last submit of these commands
+    vk_event_pool* Pool = &Commands->EventPool;
+    for (u32 EventId = 0; EventId < Pool->NumUsed; ++EventId)
+    {
+        VkCheckResult(vkResetEvent(Device, Pool->Events[EventId]));
+    }
+    Pool->NumUsed = 0;
+}
+
+inline vk_split_barrier VkCommandsSplitBarrierSignal(vk_commands* Commands, VkPipelineStageFlags SrcStageMask)
+{
+    // NOTE: Events can't be set inside a render pass. Pending barriers go out first so they stay ordered before the signal
+    Assert(!Commands->IsSecondary);
+    Assert(!Commands->InsideRenderPass);
+    vk_event_pool* Pool = &Commands->EventPool;
+    Assert(Pool->NumUsed < Pool->NumEvents);
+
+    VkCommandsBarrierFlush(Commands);
+
+    vk_split_barrier Result = {};
+    Result.Event = Pool->Events[Pool->NumUsed++];
+    Result.SrcStageMask = SrcStageMask;
+    vkCmdSetEvent(Commands->Buffer, Result.Event, SrcStageMask);
+
+    return Result;
+}
+
+inline void VkSplitBarrierMemoryAdd(vk_split_barrier* Split, VkAccessFlags InputAccessMask, VkAccessFlags OutputAccessMask,
+                                    VkPipelineStageFlags OutputStageMask)
+{
+    Assert(Split->NumMemoryBarriers < VK_SPLIT_BARRIER_MAX_BARRIERS);
+    VkMemoryBarrier* Barrier = Split->MemoryBarriers + Split->NumMemoryBarriers++;
+    *Barrier = {};
+
+    Barrier->sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    Barrier->srcAccessMask = InputAccessMask;
+    Barrier->dstAccessMask = OutputAccessMask;
+
+    Split->DstStageMask |= OutputStageMask;
+}
+
+inline void VkSplitBarrierBufferAdd(vk_split_barrier* Split, VkBuffer Buffer, VkAccessFlags InputAccessMask,
+                                    VkAccessFlags OutputAccessMask, VkPipelineStageFlags OutputStageMask)
+{
+    Assert(Split->NumBufferBarriers < VK_SPLIT_BARRIER_MAX_BARRIERS);
+    VkBufferMemoryBarrier* Barrier = Split->BufferBarriers + Split->NumBufferBarriers++;
+    *Barrier = {};
+
+    Barrier->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    Barrier->srcAccessMask = InputAccessMask;
+    Barrier->dstAccessMask = OutputAccessMask;
+    Barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier->buffer = Buffer;
+    Barrier->offset = 0;
+    Barrier->size = VK_WHOLE_SIZE;
+
+    Split->DstStageMask |= OutputStageMask;
+}
+
+inline void VkSplitBarrierImageAdd(vk_split_barrier* Split, VkImage Image, VkImageSubresourceRange Range, VkAccessFlags InputAccessMask,
+                                   VkImageLayout InputLayout, VkAccessFlags OutputAccessMask, VkPipelineStageFlags OutputStageMask,
+                                   VkImageLayout OutputLayout)
+{
+    Assert(Split->NumImageBarriers < VK_SPLIT_BARRIER_MAX_BARRIERS);
+    VkImageMemoryBarrier* Barrier = Split->ImageBarriers + Split->NumImageBarriers++;
+    *Barrier = {};
+
+    Barrier->sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    Barrier->srcAccessMask = InputAccessMask;
+    Barrier->dstAccessMask = OutputAccessMask;
+    Barrier->oldLayout = InputLayout;
+    Barrier->newLayout = OutputLayout;
+    Barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier->image = Image;
+    Barrier->subresourceRange = Range;
+
+    Split->DstStageMask |= OutputStageMask;
+}
+
+inline void VkCommandsSplitBarrierWait(vk_commands* Commands, vk_split_barrier* Split, VkPipelineStageFlags DstStageMask = 0)
+{
+    // NOTE: Batched barriers go out first so they stay ordered before the wait, same for queued reads of images the wait
+    // might transition
+    Assert(!Commands->InsideRenderPass);
+    VkCommandsBarrierFlush(Commands);
+
+    Split->DstStageMask |= DstStageMask;
+    Assert(Split->DstStageMask != 0);
+    vkCmdWaitEvents(Commands->Buffer, 1, &Split->Event, Split->SrcStageMask, Split->DstStageMask, Split->NumMemoryBarriers,
+                    Split->MemoryBarriers, Split->NumBufferBarriers, Split->BufferBarriers, Split->NumImageBarriers,
+                    Split->ImageBarriers);
+}
+
 //
 // NOTE: GPU Trasnfer
 //
@@ -245,92 +1219,556 @@ inline u8* VkCommandsPushWrite(vk_commands* Commands, VkBuffer Buffer, u64 DstOf
     Transfer->InputMask = InputMask;
     Transfer->OutputMask = OutputMask;
 
-    return Result;
+    return Result;
+}
+
+inline u8* VkCommandsPushWrite(vk_commands* Commands, VkBuffer Buffer, u64 WriteSize, barrier_mask InputMask, barrier_mask OutputMask)
+{
+    u8* Result = VkCommandsPushWrite(Commands, Buffer, 0, WriteSize, InputMask, OutputMask);
+    return Result;
+}
+
+inline u8* VkCommandsPushWrite(vk_commands* Commands, vk_mapped_buffer* Buffer, u64 DstOffset, u64 WriteSize, barrier_mask InputMask,
+                              barrier_mask OutputMask)
+{
+    // IMPORTANT: Direct writes land the moment the cpu writes them, so the range must not be in use by frames in flight
+    // (InputMask can't be waited on). Host writes are visible at submit, the barrier just orders them for OutputMask
+    u8* Result = 0;
+    if (Buffer->MappedPtr)
+    {
+        Assert(DstOffset + WriteSize <= Buffer->Size);
+        Result = Buffer->MappedPtr + DstOffset;
+        VkBarrierBufferAdd(Commands, Buffer->Buffer, VK_ACCESS_HOST_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, OutputMask.AccessMask,
+                           OutputMask.StageMask);
+
+        Commands->TransferStats.NumDirectWrites += 1;
+        Commands->TransferStats.DirectWriteBytes += WriteSize;
+    }
+    else
+    {
+        Result = VkCommandsPushWrite(Commands, Buffer->Buffer, DstOffset, WriteSize, InputMask, OutputMask);
+    }
+
+    return Result;
+}
+
+inline u8* VkCommandsPushWrite(vk_commands* Commands, vk_mapped_buffer* Buffer, u64 WriteSize, barrier_mask InputMask,
+                              barrier_mask OutputMask)
+{
+    u8* Result = VkCommandsPushWrite(Commands, Buffer, 0, WriteSize, InputMask, OutputMask);
+    return Result;
+}
+
+inline u8* VkCommandsPushWriteImage(vk_commands* Commands, VkImage Image, u32 OffsetX, u32 OffsetY, u32 OffsetZ, u32 Width, u32 Height,
+                                    u32 Depth, mm TexelSize, VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout,
+                                    VkImageLayout OutputLayout, barrier_mask InputMask, barrier_mask OutputMask)
+{
+    u8* Result = 0;
+    // TODO: If we can get the size of a format, we wouldn't need texelsize anymore
+    u64 ImageSize = Width * Height * Depth * TexelSize;
+    vk_staging_ptr StagingPtr = VkStagingPushSize(&Commands->StagingArena, ImageSize, TexelSize);
+    vk_image_transfer* Transfer = PushStruct(&Commands->ImageTransferArena, vk_image_transfer);
+
+    Result = StagingPtr.Ptr;
+    Commands->NumImageTransfers += 1;
+    Transfer->StagingBuffer = StagingPtr.Buffer;
+    Transfer->StagingOffset = StagingPtr.Offset;
+    Transfer->Image = Image;
+    Transfer->OffsetX = OffsetX;
+    Transfer->OffsetY = OffsetY;
+    Transfer->OffsetZ = OffsetZ;
+    Transfer->Width = Width;
+    Transfer->Height = Height;
+    Transfer->Depth = Depth;
+    Transfer->MipLevel = 0;
+    Transfer->BaseLayer = 0;
+    Transfer->NumLayers = 1;
+    Transfer->RowLength = 0;
+    Transfer->ImageHeight = 0;
+    Transfer->BarrierNumMips = 1;
+    Transfer->BarrierNumLayers = 1;
+    Transfer->AspectMask = AspectMask;
+    Transfer->InputMask = InputMask;
+    Transfer->InputLayout = InputLayout;
+    Transfer->OutputMask = OutputMask;
+    Transfer->OutputLayout = OutputLayout;
+    
+    return Result;
+}
+
+inline u8* VkCommandsPushWriteImage(vk_commands* Commands, VkImage Image, u32 Width, u32 Height, u32 Depth, mm TexelSize, 
+                                   VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout, VkImageLayout OutputLayout,
+                                   barrier_mask InputMask, barrier_mask OutputMask)
+{
+    u8* Result = VkCommandsPushWriteImage(Commands, Image, 0, 0, 0, Width, Height, Depth, TexelSize, AspectMask, InputLayout, OutputLayout,
+                                          InputMask, OutputMask);
+    return Result;
+}
+
+inline u8* VkCommandsPushWriteImage(vk_commands* Commands, VkImage Image, u32 OffsetX, u32 OffsetY, u32 Width, u32 Height,
+                                    mm TexelSize, VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout, VkImageLayout OutputLayout,
+                                    barrier_mask InputMask, barrier_mask OutputMask)
+{
+    u8* Result = VkCommandsPushWriteImage(Commands, Image, OffsetX, OffsetY, 0, Width, Height, 1, TexelSize, AspectMask, InputLayout,
+                                          OutputLayout, InputMask, OutputMask);
+    return Result;
+}
+
+inline u8* VkCommandsPushWriteImage(vk_commands* Commands, VkImage Image, u32 Width, u32 Height, mm TexelSize, 
+                                    VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout, VkImageLayout OutputLayout,
+                                    barrier_mask InputMask, barrier_mask OutputMask)
+{
+    u8* Result = VkCommandsPushWriteImage(Commands, Image, 0, 0, Width, Height, TexelSize, AspectMask, InputLayout, OutputLayout,
+                                          InputMask, OutputMask);
+    return Result;
+}
+
+inline u64 VkImageMipsGetAlignment(mm TexelSize, u64 CopyOffsetAlignment)
+{
+    // NOTE: Region offsets have to be a multiple of 4, of the texel size and ideally of optimalBufferCopyOffsetAlignment
+    u64 Step = Max(CopyOffsetAlignment, u64(4));
+    u64 Result = Step;
+    while (Result % TexelSize != 0)
+    {
+        Result += Step;
+    }
+
+    return Result;
+}
+
+inline u64 VkImageMipsGetOffset(u32 Width, u32 Height, u32 NumLayers, mm TexelSize, u64 CopyOffsetAlignment, u32 MipLevel)
+{
+    // NOTE: Offset of the first layer of MipLevel from the start of the staging data. Layers of a mip are tightly packed
+    // one after another, passing NumMips as MipLevel gives the total size
+    u64 Alignment = VkImageMipsGetAlignment(TexelSize, CopyOffsetAlignment);
+    u64 Result = 0;
+    for (u32 MipId = 0; MipId < MipLevel; ++MipId)
+    {
+        u64 MipWidth = Max(Width >> MipId, 1u);
+        u64 MipHeight = Max(Height >> MipId, 1u);
+        Result += MipWidth * MipHeight * TexelSize * NumLayers;
+        Result = ((Result + Alignment - 1) / Alignment) * Alignment;
+    }
+
+    return Result;
+}
+
+inline u8* VkCommandsPushWriteImageMips(vk_commands* Commands, VkImage Image, u32 Width, u32 Height, u32 NumMips, u32 NumLayers,
+                                        mm TexelSize, u64 CopyOffsetAlignment, VkImageAspectFlagBits AspectMask,
+                                        VkImageLayout InputLayout, VkImageLayout OutputLayout, barrier_mask InputMask,
+                                        barrier_mask OutputMask)
+{
+    // NOTE: Stages a whole mip chain and/or array (6 layers for cube maps) in one staging allocation. Use
+    // VkImageMipsGetOffset to find where each mip goes. Every mip is one region, the regions share a staging buffer so
+    // the flush emits them as one vkCmdCopyBufferToImage, and the first transfer carries a single barrier pair for the
+    // whole subresource range
+    u64 Alignment = VkImageMipsGetAlignment(TexelSize, CopyOffsetAlignment);
+    u64 TotalSize = VkImageMipsGetOffset(Width, Height, NumLayers, TexelSize, CopyOffsetAlignment, NumMips);
+    vk_staging_ptr StagingPtr = VkStagingPushSize(&Commands->StagingArena, TotalSize, Alignment);
+
+    for (u32 MipId = 0; MipId < NumMips; ++MipId)
+    {
+        vk_image_transfer* Transfer = PushStruct(&Commands->ImageTransferArena, vk_image_transfer);
+        Commands->NumImageTransfers += 1;
+
+        Transfer->StagingBuffer = StagingPtr.Buffer;
+        Transfer->StagingOffset = StagingPtr.Offset + VkImageMipsGetOffset(Width, Height, NumLayers, TexelSize, CopyOffsetAlignment,
+                                                                           MipId);
+        Transfer->Image = Image;
+        Transfer->OffsetX = 0;
+        Transfer->OffsetY = 0;
+        Transfer->OffsetZ = 0;
+        Transfer->Width = Max(Width >> MipId, 1u);
+        Transfer->Height = Max(Height >> MipId, 1u);
+        Transfer->Depth = 1;
+        Transfer->MipLevel = MipId;
+        Transfer->BaseLayer = 0;
+        Transfer->NumLayers = NumLayers;
+        Transfer->RowLength = 0;
+        Transfer->ImageHeight = 0;
+        Transfer->BarrierNumMips = MipId == 0 ? NumMips : 0;
+        Transfer->BarrierNumLayers = MipId == 0 ? NumLayers : 0;
+        Transfer->AspectMask = AspectMask;
+        Transfer->InputMask = InputMask;
+        Transfer->InputLayout = InputLayout;
+        Transfer->OutputMask = OutputMask;
+        Transfer->OutputLayout = OutputLayout;
+    }
+
+    u8* Result = StagingPtr.Ptr;
+    return Result;
+}
+
+//
+// NOTE: Transfer Coalescing
+//
+
+/*
+   NOTE: Transfers get flushed in chunks of VK_TRANSFER_COALESCE_MAX. Inside a chunk, copies that a later copy fully
+         overwrites get dropped, copies from the same staging buffer to the same destination become regions of one
+         copy command and regions that are adjacent in both buffers get merged. If two surviving copies partially
+         overlap we can't put them in one command, so that chunk falls back to one copy per transfer in push order with
+         barriers in between. Chunks are separated by barriers too so later chunks always win.
+*/
+
+enum vk_copy_sort_mode
+{
+    VkCopySort_DstOffset,
+    VkCopySort_Group,
+    VkCopySort_Seq,
+};
+
+inline b32 VkBufferCopyEntryLess(vk_buffer_copy_entry* A, vk_buffer_copy_entry* B, vk_copy_sort_mode Mode)
+{
+    if (Mode == VkCopySort_Seq)
+    {
+        return A->Seq < B->Seq;
+    }
+    if (A->Buffer != B->Buffer)
+    {
+        return (u64)A->Buffer < (u64)B->Buffer;
+    }
+    if (Mode == VkCopySort_Group && A->StagingBuffer != B->StagingBuffer)
+    {
+        return (u64)A->StagingBuffer < (u64)B->StagingBuffer;
+    }
+    if (A->DstOffset != B->DstOffset)
+    {
+        return A->DstOffset < B->DstOffset;
+    }
+    return A->Seq < B->Seq;
+}
+
+inline void VkBufferCopyEntriesSort(vk_buffer_copy_entry* Entries, vk_buffer_copy_entry* Temp, u32 NumEntries,
+                                    vk_copy_sort_mode Mode)
+{
+    // NOTE: Bottom up merge sort, stable and we already have the scratch space
+    vk_buffer_copy_entry* Src = Entries;
+    vk_buffer_copy_entry* Dst = Temp;
+    for (u32 Width = 1; Width < NumEntries; Width *= 2)
+    {
+        for (u32 Start = 0; Start < NumEntries; Start += 2 * Width)
+        {
+            u32 Mid = Min(Start + Width, NumEntries);
+            u32 End = Min(Start + 2 * Width, NumEntries);
+            u32 LeftId = Start;
+            u32 RightId = Mid;
+            for (u32 OutId = Start; OutId < End; ++OutId)
+            {
+                if (LeftId < Mid && (RightId >= End || !VkBufferCopyEntryLess(Src + RightId, Src + LeftId, Mode)))
+                {
+                    Dst[OutId] = Src[LeftId++];
+                }
+                else
+                {
+                    Dst[OutId] = Src[RightId++];
+                }
+            }
+        }
+
+        vk_buffer_copy_entry* Swap = Src;
+        Src = Dst;
+        Dst = Swap;
+    }
+
+    if (Src != Entries)
+    {
+        Copy(Src, Entries, sizeof(vk_buffer_copy_entry) * NumEntries);
+    }
+}
+
+inline void VkCommandsTransferBarrier(vk_commands* Commands)
+{
+    VkBarrierMemoryAdd(Commands, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+}
+
+inline void VkCommandsBufferCopyChunk(vk_commands* Commands, vk_buffer_copy_entry* Entries, vk_buffer_copy_entry* Temp,
+                                      u32 NumEntries)
+{
+    vk_transfer_stats* Stats = &Commands->TransferStats;
+    Stats->NumTransfers += NumEntries;
+
+    // NOTE: Drop copies that a later copy fully overwrites and look for partial overlaps
+    b32 Conflict = false;
+    VkBufferCopyEntriesSort(Entries, Temp, NumEntries, VkCopySort_DstOffset);
+    for (u32 EntryId = 0; EntryId < NumEntries; ++EntryId)
+    {
+        vk_buffer_copy_entry* Entry = Entries + EntryId;
+        u64 EntryEnd = Entry->DstOffset + Entry->Size;
+        for (u32 OtherId = EntryId + 1;
+             !Entry->Elided && OtherId < NumEntries && Entries[OtherId].Buffer == Entry->Buffer && Entries[OtherId].DstOffset < EntryEnd;
+             ++OtherId)
+        {
+            vk_buffer_copy_entry* Other = Entries + OtherId;
+            u64 OtherEnd = Other->DstOffset + Other->Size;
+            if (Other->Elided)
+            {
+                continue;
+            }
+
+            if (Other->Seq > Entry->Seq && Other->DstOffset == Entry->DstOffset && OtherEnd >= EntryEnd)
+            {
+                Entry->Elided = true;
+            }
+            else if (Entry->Seq > Other->Seq && OtherEnd <= EntryEnd)
+            {
+                Other->Elided = true;
+            }
+            else
+            {
+                Conflict = true;
+            }
+        }
+
+        Stats->NumElided += Entry->Elided ? 1 : 0;
+    }
+
+    if (Conflict)
+    {
+        VkBufferCopyEntriesSort(Entries, Temp, NumEntries, VkCopySort_Seq);
+        for (u32 EntryId = 0; EntryId < NumEntries; ++EntryId)
+        {
+            vk_buffer_copy_entry* Entry = Entries + EntryId;
+            if (Entry->Elided)
+            {
+                continue;
+            }
+
+            VkBufferCopy BufferCopy = {};
+            BufferCopy.srcOffset = Entry->SrcOffset;
+            BufferCopy.dstOffset = Entry->DstOffset;
+            BufferCopy.size = Entry->Size;
+            vkCmdCopyBuffer(Commands->Buffer, Entry->StagingBuffer, Entry->Buffer, 1, &BufferCopy);
+            VkCommandsTransferBarrier(Commands);
+
+            Stats->NumCopyCommands += 1;
+            Stats->NumCopyRegions += 1;
+        }
+
+        return;
+    }
+
+    // NOTE: One copy command per (staging buffer, destination) pair, merging regions adjacent on both sides
+    VkBufferCopy Regions[VK_TRANSFER_COALESCE_MAX];
+    VkBufferCopyEntriesSort(Entries, Temp, NumEntries, VkCopySort_Group);
+    for (u32 EntryId = 0; EntryId < NumEntries; )
+    {
+        vk_buffer_copy_entry* First = Entries + EntryId;
+        u32 NumRegions = 0;
+        for (; EntryId < NumEntries && Entries[EntryId].Buffer == First->Buffer && Entries[EntryId].StagingBuffer == First->StagingBuffer;
+             ++EntryId)
+        {
+            vk_buffer_copy_entry* Entry = Entries + EntryId;
+            if (Entry->Elided)
+            {
+                continue;
+            }
+
+            VkBufferCopy* Prev = NumRegions > 0 ? Regions + NumRegions - 1 : 0;
+            if (Prev && Prev->dstOffset + Prev->size == Entry->DstOffset && Prev->srcOffset + Prev->size == Entry->SrcOffset)
+            {
+                Prev->size += Entry->Size;
+                Stats->NumMerged += 1;
+            }
+            else
+            {
+                VkBufferCopy* Region = Regions + NumRegions++;
+                Region->srcOffset = Entry->SrcOffset;
+                Region->dstOffset = Entry->DstOffset;
+                Region->size = Entry->Size;
+            }
+        }
+
+        if (NumRegions > 0)
+        {
+            vkCmdCopyBuffer(Commands->Buffer, First->StagingBuffer, First->Buffer, NumRegions, Regions);
+            Stats->NumCopyCommands += 1;
+            Stats->NumCopyRegions += NumRegions;
+        }
+    }
 }
 
-inline u8* VkCommandsPushWrite(vk_commands* Commands, VkBuffer Buffer, u64 WriteSize, barrier_mask InputMask, barrier_mask OutputMask)
+inline VkBufferImageCopy VkImageTransferGetCopy(vk_image_transfer* Transfer)
 {
-    u8* Result = VkCommandsPushWrite(Commands, Buffer, 0, WriteSize, InputMask, OutputMask);
+    VkBufferImageCopy Result = {};
+    Result.bufferOffset = Transfer->StagingOffset;
+    Result.bufferRowLength = Transfer->RowLength;
+    Result.bufferImageHeight = Transfer->ImageHeight;
+    Result.imageSubresource.aspectMask = Transfer->AspectMask;
+    Result.imageSubresource.mipLevel = Transfer->MipLevel;
+    Result.imageSubresource.baseArrayLayer = Transfer->BaseLayer;
+    Result.imageSubresource.layerCount = Transfer->NumLayers;
+    Result.imageOffset.x = Transfer->OffsetX;
+    Result.imageOffset.y = Transfer->OffsetY;
+    Result.imageOffset.z = Transfer->OffsetZ;
+    Result.imageExtent.width = Transfer->Width;
+    Result.imageExtent.height = Transfer->Height;
+    Result.imageExtent.depth = Transfer->Depth;
+
     return Result;
 }
 
-inline u8* VkCommandsPushWriteImage(vk_commands* Commands, VkImage Image, u32 OffsetX, u32 OffsetY, u32 OffsetZ, u32 Width, u32 Height,
-                                    u32 Depth, mm TexelSize, VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout,
-                                    VkImageLayout OutputLayout, barrier_mask InputMask, barrier_mask OutputMask)
+inline VkImageSubresourceRange VkImageTransferGetBarrierRange(vk_image_transfer* Transfer)
 {
-    u8* Result = 0;
-    // TODO: If we can get the size of a format, we wouldn't need texelsize anymore
-    u64 ImageSize = Width * Height * Depth * TexelSize;
-    vk_staging_ptr StagingPtr = VkStagingPushSize(&Commands->StagingArena, ImageSize, TexelSize);
-    vk_image_transfer* Transfer = PushStruct(&Commands->ImageTransferArena, vk_image_transfer);
+    VkImageSubresourceRange Result = {};
+    Result.aspectMask = Transfer->AspectMask;
+    Result.baseMipLevel = Transfer->MipLevel;
+    Result.levelCount = Transfer->BarrierNumMips;
+    Result.baseArrayLayer = Transfer->BaseLayer;
+    Result.layerCount = Transfer->BarrierNumLayers;
 
-    Result = StagingPtr.Ptr;
-    Commands->NumImageTransfers += 1;
-    Transfer->StagingBuffer = StagingPtr.Buffer;
-    Transfer->StagingOffset = StagingPtr.Offset;
-    Transfer->Image = Image;
-    Transfer->OffsetX = OffsetX;
-    Transfer->OffsetY = OffsetY;
-    Transfer->OffsetZ = OffsetZ;
-    Transfer->Width = Width;
-    Transfer->Height = Height;
-    Transfer->Depth = Depth;
-    Transfer->AspectMask = AspectMask;
-    Transfer->InputMask = InputMask;
-    Transfer->InputLayout = InputLayout;
-    Transfer->OutputMask = OutputMask;
-    Transfer->OutputLayout = OutputLayout;
-    
     return Result;
 }
 
-inline u8* VkCommandsPushWriteImage(vk_commands* Commands, VkImage Image, u32 Width, u32 Height, u32 Depth, mm TexelSize, 
-                                   VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout, VkImageLayout OutputLayout,
-                                   barrier_mask InputMask, barrier_mask OutputMask)
+inline b32 VkImageCopyOverlaps(VkBufferImageCopy* A, VkBufferImageCopy* B)
 {
-    u8* Result = VkCommandsPushWriteImage(Commands, Image, 0, 0, 0, Width, Height, Depth, TexelSize, AspectMask, InputLayout, OutputLayout,
-                                          InputMask, OutputMask);
+    b32 Result = ((A->imageSubresource.aspectMask & B->imageSubresource.aspectMask) &&
+                  A->imageSubresource.mipLevel == B->imageSubresource.mipLevel &&
+                  A->imageSubresource.baseArrayLayer < B->imageSubresource.baseArrayLayer + B->imageSubresource.layerCount &&
+                  B->imageSubresource.baseArrayLayer < A->imageSubresource.baseArrayLayer + A->imageSubresource.layerCount &&
+                  A->imageOffset.x < B->imageOffset.x + i32(B->imageExtent.width) &&
+                  B->imageOffset.x < A->imageOffset.x + i32(A->imageExtent.width) &&
+                  A->imageOffset.y < B->imageOffset.y + i32(B->imageExtent.height) &&
+                  B->imageOffset.y < A->imageOffset.y + i32(A->imageExtent.height) &&
+                  A->imageOffset.z < B->imageOffset.z + i32(B->imageExtent.depth) &&
+                  B->imageOffset.z < A->imageOffset.z + i32(A->imageExtent.depth));
     return Result;
 }
 
-inline u8* VkCommandsPushWriteImage(vk_commands* Commands, VkImage Image, u32 OffsetX, u32 OffsetY, u32 Width, u32 Height,
-                                    mm TexelSize, VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout, VkImageLayout OutputLayout,
-                                    barrier_mask InputMask, barrier_mask OutputMask)
+inline b32 VkImageCopyCovers(VkBufferImageCopy* A, VkBufferImageCopy* B)
 {
-    u8* Result = VkCommandsPushWriteImage(Commands, Image, OffsetX, OffsetY, 0, Width, Height, 1, TexelSize, AspectMask, InputLayout,
-                                          OutputLayout, InputMask, OutputMask);
+    // NOTE: True if A writes everything B writes
+    b32 Result = ((A->imageSubresource.aspectMask & B->imageSubresource.aspectMask) == B->imageSubresource.aspectMask &&
+                  A->imageSubresource.mipLevel == B->imageSubresource.mipLevel &&
+                  A->imageSubresource.baseArrayLayer <= B->imageSubresource.baseArrayLayer &&
+                  A->imageSubresource.baseArrayLayer + A->imageSubresource.layerCount >= B->imageSubresource.baseArrayLayer + B->imageSubresource.layerCount &&
+                  A->imageOffset.x <= B->imageOffset.x && A->imageOffset.x + A->imageExtent.width >= B->imageOffset.x + B->imageExtent.width &&
+                  A->imageOffset.y <= B->imageOffset.y && A->imageOffset.y + A->imageExtent.height >= B->imageOffset.y + B->imageExtent.height &&
+                  A->imageOffset.z <= B->imageOffset.z && A->imageOffset.z + A->imageExtent.depth >= B->imageOffset.z + B->imageExtent.depth);
     return Result;
 }
 
-inline u8* VkCommandsPushWriteImage(vk_commands* Commands, VkImage Image, u32 Width, u32 Height, mm TexelSize, 
-                                    VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout, VkImageLayout OutputLayout,
-                                    barrier_mask InputMask, barrier_mask OutputMask)
+inline void VkCommandsImageCopyChunk(vk_commands* Commands, vk_image_copy_entry* Entries, u32 NumEntries)
 {
-    u8* Result = VkCommandsPushWriteImage(Commands, Image, 0, 0, Width, Height, TexelSize, AspectMask, InputLayout, OutputLayout,
-                                          InputMask, OutputMask);
-    return Result;
+    vk_transfer_stats* Stats = &Commands->TransferStats;
+    Stats->NumTransfers += NumEntries;
+
+    VkBufferImageCopy Copies[VK_TRANSFER_COALESCE_MAX];
+    for (u32 EntryId = 0; EntryId < NumEntries; ++EntryId)
+    {
+        Copies[EntryId] = VkImageTransferGetCopy(Entries[EntryId].Transfer);
+    }
+
+    // NOTE: Entries are in push order, images rarely get more than a handful of writes per flush so pairwise is fine
+    b32 Conflict = false;
+    for (u32 EntryId = 0; EntryId < NumEntries; ++EntryId)
+    {
+        for (u32 OtherId = EntryId + 1; OtherId < NumEntries && !Entries[EntryId].Elided; ++OtherId)
+        {
+            if (Entries[OtherId].Transfer->Image != Entries[EntryId].Transfer->Image ||
+                !VkImageCopyOverlaps(Copies + EntryId, Copies + OtherId))
+            {
+                continue;
+            }
+
+            if (VkImageCopyCovers(Copies + OtherId, Copies + EntryId))
+            {
+                Entries[EntryId].Elided = true;
+                Stats->NumElided += 1;
+            }
+            else
+            {
+                Conflict = true;
+            }
+        }
+    }
+
+    VkBufferImageCopy Regions[VK_TRANSFER_COALESCE_MAX];
+    b32 Emitted[VK_TRANSFER_COALESCE_MAX] = {};
+    for (u32 EntryId = 0; EntryId < NumEntries; ++EntryId)
+    {
+        if (Entries[EntryId].Elided || Emitted[EntryId])
+        {
+            continue;
+        }
+
+        // NOTE: Gather every later region with the same (staging buffer, image) pair unless we have to keep push order
+        vk_image_transfer* First = Entries[EntryId].Transfer;
+        u32 NumRegions = 0;
+        for (u32 OtherId = EntryId; OtherId < NumEntries; ++OtherId)
+        {
+            vk_image_transfer* Other = Entries[OtherId].Transfer;
+            if (!Entries[OtherId].Elided && !Emitted[OtherId] && Other->Image == First->Image &&
+                Other->StagingBuffer == First->StagingBuffer && (!Conflict || OtherId == EntryId))
+            {
+                Regions[NumRegions++] = Copies[OtherId];
+                Emitted[OtherId] = true;
+            }
+        }
+
+        vkCmdCopyBufferToImage(Commands->Buffer, First->StagingBuffer, First->Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               NumRegions, Regions);
+        Stats->NumCopyCommands += 1;
+        Stats->NumCopyRegions += NumRegions;
+        if (Conflict)
+        {
+            VkCommandsTransferBarrier(Commands);
+        }
+    }
 }
 
 inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device)
 {
-    // NOTE: Flush all staging memory we have written to so far
-    if (Commands->StagingArena.Next)
+    // NOTE: Staged writes can land in the source of a queued read
+    if (Commands->NumBufferTransfers != 0 || Commands->NumImageTransfers != 0)
+    {
+        VkCommandsReadbackPendingFlush(Commands);
+    }
+    
+    // NOTE: Flush the staging memory written since the last flush, coherent memory doesn't need any
+    if (Commands->StagingArena.Next && !Commands->StagingArena.IsCoherent)
     {
+        VkMappedMemoryRange FlushRanges[VK_MAX_FLUSH_RANGES];
+        u32 NumFlushRanges = 0;
         for (vk_staging_arena_header* CurrHeader = Commands->StagingArena.Next; CurrHeader; CurrHeader = CurrHeader->Next)
         {
             // NOTE: Align the current headers used size to flush alignment so we don't overwrite it with partial writes later
             CurrHeader->Used = Min(CurrHeader->Size, AlignAddress(CurrHeader->Used, u64(Commands->FlushAlignment)));
-            
-            VkMappedMemoryRange FlushRange = {};
-            FlushRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-            FlushRange.memory = CurrHeader->GpuMemory;
-            FlushRange.offset = 0;
-            FlushRange.size = CurrHeader->Used;
-            vkFlushMappedMemoryRanges(Device, 1, &FlushRange);
+            if (CurrHeader->Used == CurrHeader->FlushedUsed)
+            {
+                continue;
+            }
+
+            VkMappedMemoryRange* FlushRange = FlushRanges + NumFlushRanges++;
+            *FlushRange = {};
+            FlushRange->sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            FlushRange->memory = CurrHeader->GpuMemory;
+            FlushRange->offset = CurrHeader->FlushedUsed;
+            FlushRange->size = CurrHeader->Used - CurrHeader->FlushedUsed;
+            CurrHeader->FlushedUsed = CurrHeader->Used;
+
+            if (NumFlushRanges == VK_MAX_FLUSH_RANGES)
+            {
+                VkCheckResult(vkFlushMappedMemoryRanges(Device, NumFlushRanges, FlushRanges));
+                NumFlushRanges = 0;
+            }
+        }
+
+        if (NumFlushRanges > 0)
+        {
+            VkCheckResult(vkFlushMappedMemoryRanges(Device, NumFlushRanges, FlushRanges));
         }
     }
 
     barrier_mask IntermediateMask = BarrierMask(VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    b32 HasTransfers = Commands->NumBufferTransfers > 0 || Commands->NumImageTransfers > 0;
+    if (HasTransfers)
+    {
+        VkGpuScopeBegin(Commands, "TransferFlush");
+    }
     
     // NOTE: Transfer all buffers
     if (Commands->NumBufferTransfers > 0)
@@ -357,6 +1795,10 @@ inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device)
 
         // NOTE: Apply transfers
         {
+            vk_buffer_copy_entry Entries[VK_TRANSFER_COALESCE_MAX];
+            vk_buffer_copy_entry Temp[VK_TRANSFER_COALESCE_MAX];
+            u32 NumEntries = 0;
+            
             block* CurrBlock = Commands->BufferTransferArena.Next;
             for (u32 BufferId = 0; BufferId < Commands->NumBufferTransfers; )
             {
@@ -366,16 +1808,35 @@ inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device)
                 {
                     vk_buffer_transfer* BufferTransfer = BlockGetData(CurrBlock, vk_buffer_transfer) + SubBufferId;
 
-                    VkBufferCopy BufferCopy = {};
-                    BufferCopy.srcOffset = BufferTransfer->StagingOffset;
-                    BufferCopy.dstOffset = BufferTransfer->DstOffset;
-                    BufferCopy.size = BufferTransfer->Size;
-                    vkCmdCopyBuffer(Commands->Buffer, BufferTransfer->StagingBuffer, BufferTransfer->Buffer, 1, &BufferCopy);
+                    vk_buffer_copy_entry* Entry = Entries + NumEntries;
+                    Entry->Buffer = BufferTransfer->Buffer;
+                    Entry->StagingBuffer = BufferTransfer->StagingBuffer;
+                    Entry->DstOffset = BufferTransfer->DstOffset;
+                    Entry->SrcOffset = BufferTransfer->StagingOffset;
+                    Entry->Size = BufferTransfer->Size;
+                    Entry->Seq = NumEntries;
+                    Entry->Elided = false;
+                    NumEntries += 1;
+
+                    if (NumEntries == VK_TRANSFER_COALESCE_MAX)
+                    {
+                        VkCommandsBufferCopyChunk(Commands, Entries, Temp, NumEntries);
+                        NumEntries = 0;
+                        if (BufferId + SubBufferId + 1 < Commands->NumBufferTransfers)
+                        {
+                            VkCommandsTransferBarrier(Commands);
+                        }
+                    }
                 }
 
                 BufferId += NumTransfersInBlock;
                 CurrBlock = CurrBlock->Next;
             }
+
+            if (NumEntries > 0)
+            {
+                VkCommandsBufferCopyChunk(Commands, Entries, Temp, NumEntries);
+            }
         }
 
         // NOTE: Apply post transfer barriers
@@ -415,8 +1876,12 @@ inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device)
                 for (u32 SubImageId = 0; SubImageId < NumTransfersInBlock; ++SubImageId)
                 {
                     vk_image_transfer* ImageTransfer = BlockGetData(CurrBlock, vk_image_transfer) + SubImageId;
-                    VkBarrierImageAdd(Commands, ImageTransfer->Image, ImageTransfer->AspectMask, ImageTransfer->InputMask,
-                                      ImageTransfer->InputLayout, IntermediateMask, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+                    if (ImageTransfer->BarrierNumMips > 0)
+                    {
+                        VkBarrierImageAdd(Commands, ImageTransfer->Image, VkImageTransferGetBarrierRange(ImageTransfer),
+                                          ImageTransfer->InputMask, ImageTransfer->InputLayout, IntermediateMask,
+                                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+                    }
                 }
                 
                 ImageId += NumTransfersInBlock;
@@ -428,6 +1893,9 @@ inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device)
 
         // NOTE: Apply transfers
         {
+            vk_image_copy_entry Entries[VK_TRANSFER_COALESCE_MAX];
+            u32 NumEntries = 0;
+            
             block* CurrBlock = Commands->ImageTransferArena.Next;
             for (u32 ImageId = 0; ImageId < Commands->NumImageTransfers; )
             {
@@ -435,29 +1903,31 @@ inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device)
                                               (Commands->NumImageTransfers - ImageId));
                 for (u32 SubImageId = 0; SubImageId < NumTransfersInBlock; ++SubImageId)
                 {
-                    vk_image_transfer* ImageTransfer = BlockGetData(CurrBlock, vk_image_transfer) + SubImageId;
-                    
-                    VkBufferImageCopy ImageCopy = {};
-                    ImageCopy.bufferOffset = ImageTransfer->StagingOffset;
-                    ImageCopy.bufferRowLength = 0;
-                    ImageCopy.bufferImageHeight = 0;
-                    ImageCopy.imageSubresource.aspectMask = ImageTransfer->AspectMask;
-                    ImageCopy.imageSubresource.mipLevel = 0;
-                    ImageCopy.imageSubresource.baseArrayLayer = 0;
-                    ImageCopy.imageSubresource.layerCount = 1;
-                    ImageCopy.imageOffset.x = ImageTransfer->OffsetX;
-                    ImageCopy.imageOffset.y = ImageTransfer->OffsetY;
-                    ImageCopy.imageOffset.z = ImageTransfer->OffsetZ;
-                    ImageCopy.imageExtent.width = ImageTransfer->Width;
-                    ImageCopy.imageExtent.height = ImageTransfer->Height;
-                    ImageCopy.imageExtent.depth = ImageTransfer->Depth;
-                    vkCmdCopyBufferToImage(Commands->Buffer, ImageTransfer->StagingBuffer, ImageTransfer->Image,
-                                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &ImageCopy);
+                    vk_image_copy_entry* Entry = Entries + NumEntries;
+                    Entry->Transfer = BlockGetData(CurrBlock, vk_image_transfer) + SubImageId;
+                    Entry->Seq = NumEntries;
+                    Entry->Elided = false;
+                    NumEntries += 1;
+
+                    if (NumEntries == VK_TRANSFER_COALESCE_MAX)
+                    {
+                        VkCommandsImageCopyChunk(Commands, Entries, NumEntries);
+                        NumEntries = 0;
+                        if (ImageId + SubImageId + 1 < Commands->NumImageTransfers)
+                        {
+                            VkCommandsTransferBarrier(Commands);
+                        }
+                    }
                 }
                 
                 ImageId += NumTransfersInBlock;
                 CurrBlock = CurrBlock->Next;
             }
+
+            if (NumEntries > 0)
+            {
+                VkCommandsImageCopyChunk(Commands, Entries, NumEntries);
+            }
         }
         
         // NOTE: Apply post transfer barriers
@@ -470,8 +1940,12 @@ inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device)
                 for (u32 SubImageId = 0; SubImageId < NumTransfersInBlock; ++SubImageId)
                 {
                     vk_image_transfer* ImageTransfer = BlockGetData(CurrBlock, vk_image_transfer) + SubImageId;
-                    VkBarrierImageAdd(Commands, ImageTransfer->Image, ImageTransfer->AspectMask, IntermediateMask,
-                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, ImageTransfer->OutputMask, ImageTransfer->OutputLayout);
+                    if (ImageTransfer->BarrierNumMips > 0)
+                    {
+                        VkBarrierImageAdd(Commands, ImageTransfer->Image, VkImageTransferGetBarrierRange(ImageTransfer),
+                                          IntermediateMask, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, ImageTransfer->OutputMask,
+                                          ImageTransfer->OutputLayout);
+                    }
                 }
                 
                 ImageId += NumTransfersInBlock;
@@ -484,4 +1958,380 @@ inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device)
         ArenaClear(&Commands->ImageTransferArena);
         Commands->NumImageTransfers = 0;
     }
+
+    if (HasTransfers)
+    {
+        VkGpuScopeEnd(Commands);
+    }
+}
+
+//
+// NOTE: Readback
+//
+
+/*
+   NOTE: Reads are the mirror of the push writes above. VkCommandsPushRead and VkCommandsPushReadImage reserve space in
+         the readback arena and queue the read. VkCommandsReadbackFlush records all queued reads with one transition
+         batch, the copies and one batch that restores the sources and makes the copies visible to the host. Once the
+         submit's fence signals the data can be read through VkReadbackGetData, which invalidates the range for non
+         coherent memory.
+
+         A read sees its source as it is at the push. Staged writes and batched barriers pending at the push go out
+         before it, and the queued reads get flushed before the next barrier gets added or flushed, before transfers
+         get flushed and at end/submit. Commands recorded on Commands->Buffer directly don't go through any of that,
+         so flush with VkCommandsBarrierFlush before recording anything that touches a queued source or beginning a
+         render pass. Pushes have to happen outside of a render pass.
+
+         A readback stays valid until its vk_commands begins recording again, so read it before the ring comes back
+         around. Only primaries that get submitted with their fence can read back.
+*/
+
+inline void VkCommandsReadbackCreate(vk_commands* Commands, VkDevice Device, u32 ReadbackTypeId, u64 Size, b32 IsCoherent,
+                                     u64 InvalidateAlignment)
+{
+    // NOTE: Use VkGetReadbackMemoryType for ReadbackTypeId, the arena holds the reads of one submit
+    Commands->ReadbackArena = VkReadbackArenaCreate(Device, ReadbackTypeId, Size, IsCoherent, InvalidateAlignment);
+}
+
+inline void VkCommandsReadbackDestroy(vk_commands* Commands, VkDevice Device)
+{
+    VkReadbackArenaDestroy(&Commands->ReadbackArena, Device);
+    Commands->ReadbackArena = {};
+}
+
+inline vk_readback VkReadbackCreate(vk_commands* Commands, u64 Offset, u64 Size)
+{
+    vk_readback Result = {};
+    Result.Commands = Commands;
+    Result.Generation = Commands->Generation;
+    Result.Offset = Offset;
+    Result.Size = Size;
+
+    return Result;
+}
+
+inline void VkCommandsReadbackPrepare(vk_commands* Commands)
+{
+    Assert(Commands->ReadbackArena.MappedPtr);
+    Assert(!Commands->InsideRenderPass);
+
+    if (Commands->NumBufferTransfers != 0 || Commands->NumImageTransfers != 0)
+    {
+        VkCommandsTransferFlush(Commands, Commands->StagingArena.Device);
+    }
+
+    // NOTE: The first read of a batch flushes barriers the caller left pending, after that the batch stays empty until
+    // the reads go out since adding a barrier flushes them
+    if (Commands->NumBufferReadbacks == 0 && Commands->NumImageReadbacks == 0)
+    {
+        VkCommandsBarrierFlush(Commands);
+    }
+}
+
+inline vk_readback VkCommandsPushRead(vk_commands* Commands, VkBuffer Buffer, u64 SrcOffset, u64 Size, barrier_mask InputMask)
+{
+    VkCommandsReadbackPrepare(Commands);
+
+    u64 ReadbackOffset = VkReadbackPushSize(&Commands->ReadbackArena, Size);
+    vk_buffer_readback* Readback = PushStruct(&Commands->BufferReadbackArena, vk_buffer_readback);
+    Commands->NumBufferReadbacks += 1;
+
+    Readback->Buffer = Buffer;
+    Readback->SrcOffset = SrcOffset;
+    Readback->Size = Size;
+    Readback->ReadbackOffset = ReadbackOffset;
+    Readback->InputMask = InputMask;
+
+    vk_readback Result = VkReadbackCreate(Commands, ReadbackOffset, Size);
+    return Result;
+}
+
+inline b32 VkImageReadbackSameSubresource(vk_image_readback* A, vk_image_readback* B)
+{
+    b32 Result = (A->Image == B->Image && A->AspectMask == B->AspectMask && A->MipLevel == B->MipLevel &&
+                  A->Layer == B->Layer);
+    return Result;
+}
+
+inline vk_readback VkCommandsPushReadImage(vk_commands* Commands, VkImage Image, u32 OffsetX, u32 OffsetY, u32 Width, u32 Height,
+                                           mm TexelSize, VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout,
+                                           VkImageLayout OutputLayout, barrier_mask InputMask, barrier_mask OutputMask,
+                                           u32 MipLevel = 0, u32 Layer = 0)
+{
+    // NOTE: Rows come back tightly packed, Width * TexelSize bytes each. Passing TRANSFER_SRC_OPTIMAL with a transfer
+    // read mask as the output skips the restore barrier, whoever uses the image next has to wait on the transfer
+    VkCommandsReadbackPrepare(Commands);
+
+    u64 Size = u64(Width) * u64(Height) * TexelSize;
+    u64 ReadbackOffset = VkReadbackPushSize(&Commands->ReadbackArena, Size, VkImageMipsGetAlignment(TexelSize, 4));
+    vk_image_readback* Readback = PushStruct(&Commands->ImageReadbackArena, vk_image_readback);
+
+    Readback->Image = Image;
+    Readback->AspectMask = AspectMask;
+    Readback->OffsetX = OffsetX;
+    Readback->OffsetY = OffsetY;
+    Readback->Width = Width;
+    Readback->Height = Height;
+    Readback->MipLevel = MipLevel;
+    Readback->Layer = Layer;
+    Readback->ReadbackOffset = ReadbackOffset;
+    Readback->InputMask = InputMask;
+    Readback->InputLayout = InputLayout;
+    Readback->OutputMask = OutputMask;
+    Readback->OutputLayout = OutputLayout;
+    Readback->OwnsBarrier = true;
+
+    u32 ImagesPerBlock = u32(BlockArenaGetBlockSize(&Commands->ImageReadbackArena) / sizeof(vk_image_readback));
+    block* CurrBlock = Commands->ImageReadbackArena.Next;
+    for (u32 ReadbackId = 0; ReadbackId < Commands->NumImageReadbacks; )
+    {
+        u32 NumInBlock = Min(ImagesPerBlock, Commands->NumImageReadbacks - ReadbackId);
+        for (u32 SubId = 0; SubId < NumInBlock && Readback->OwnsBarrier; ++SubId)
+        {
+            vk_image_readback* Other = BlockGetData(CurrBlock, vk_image_readback) + SubId;
+            if (VkImageReadbackSameSubresource(Other, Readback))
+            {
+                // NOTE: Nothing can change the layout between reads of the same batch
+                Assert(Other->InputLayout == InputLayout && Other->OutputLayout == OutputLayout);
+                Readback->OwnsBarrier = false;
+            }
+        }
+
+        ReadbackId += NumInBlock;
+        CurrBlock = CurrBlock->Next;
+    }
+    Commands->NumImageReadbacks += 1;
+
+    vk_readback Result = VkReadbackCreate(Commands, ReadbackOffset, Size);
+    return Result;
+}
+
+inline vk_readback VkCommandsPushReadImage(vk_commands* Commands, VkImage Image, u32 Width, u32 Height, mm TexelSize,
+                                           VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout, VkImageLayout OutputLayout,
+                                           barrier_mask InputMask, barrier_mask OutputMask)
+{
+    vk_readback Result = VkCommandsPushReadImage(Commands, Image, 0, 0, Width, Height, TexelSize, AspectMask, InputLayout,
+                                                 OutputLayout, InputMask, OutputMask);
+    return Result;
+}
+
+inline vk_readback VkCommandsPushReadImage(vk_commands* Commands, VkImage Image, u32 Width, u32 Height, mm TexelSize,
+                                           VkImageAspectFlagBits AspectMask, VkImageLayout InputLayout, barrier_mask InputMask)
+{
+    // NOTE: Puts the image back how we found it
+    vk_readback Result = VkCommandsPushReadImage(Commands, Image, 0, 0, Width, Height, TexelSize, AspectMask, InputLayout,
+                                                 InputLayout, InputMask, InputMask);
+    return Result;
+}
+
+inline VkImageSubresourceRange VkImageReadbackGetRange(vk_image_readback* Readback)
+{
+    VkImageSubresourceRange Result = {};
+    Result.aspectMask = Readback->AspectMask;
+    Result.baseMipLevel = Readback->MipLevel;
+    Result.levelCount = 1;
+    Result.baseArrayLayer = Readback->Layer;
+    Result.layerCount = 1;
+
+    return Result;
+}
+
+inline void VkCommandsReadbackFlush(vk_commands* Commands)
+{
+    if (Commands->NumBufferReadbacks == 0 && Commands->NumImageReadbacks == 0)
+    {
+        return;
+    }
+
+    // NOTE: Clear the counts first so the barriers we add below don't flush us again
+    u32 NumBufferReadbacks = Commands->NumBufferReadbacks;
+    u32 NumImageReadbacks = Commands->NumImageReadbacks;
+    Commands->NumBufferReadbacks = 0;
+    Commands->NumImageReadbacks = 0;
+
+    VkGpuScopeBegin(Commands, "ReadbackFlush");
+
+    barrier_mask ReadMask = BarrierMask(VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    u32 BuffersPerBlock = u32(BlockArenaGetBlockSize(&Commands->BufferReadbackArena) / sizeof(vk_buffer_readback));
+    u32 ImagesPerBlock = u32(BlockArenaGetBlockSize(&Commands->ImageReadbackArena) / sizeof(vk_image_readback));
+
+    // NOTE: Apply pre copy barriers
+    {
+        block* CurrBlock = Commands->BufferReadbackArena.Next;
+        for (u32 ReadbackId = 0; ReadbackId < NumBufferReadbacks; )
+        {
+            u32 NumInBlock = Min(BuffersPerBlock, NumBufferReadbacks - ReadbackId);
+            for (u32 SubId = 0; SubId < NumInBlock; ++SubId)
+            {
+                vk_buffer_readback* Readback = BlockGetData(CurrBlock, vk_buffer_readback) + SubId;
+                VkBarrierBufferAdd(Commands, Readback->InputMask, ReadMask, Readback->Buffer);
+            }
+
+            ReadbackId += NumInBlock;
+            CurrBlock = CurrBlock->Next;
+        }
+
+        CurrBlock = Commands->ImageReadbackArena.Next;
+        for (u32 ReadbackId = 0; ReadbackId < NumImageReadbacks; )
+        {
+            u32 NumInBlock = Min(ImagesPerBlock, NumImageReadbacks - ReadbackId);
+            for (u32 SubId = 0; SubId < NumInBlock; ++SubId)
+            {
+                vk_image_readback* Readback = BlockGetData(CurrBlock, vk_image_readback) + SubId;
+                if (Readback->OwnsBarrier)
+                {
+                    VkBarrierImageAdd(Commands, Readback->Image, VkImageReadbackGetRange(Readback), Readback->InputMask,
+                                      Readback->InputLayout, ReadMask, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+                }
+            }
+
+            ReadbackId += NumInBlock;
+            CurrBlock = CurrBlock->Next;
+        }
+
+        VkCommandsBarrierFlush(Commands);
+    }
+
+    // NOTE: Apply copies
+    {
+        block* CurrBlock = Commands->BufferReadbackArena.Next;
+        for (u32 ReadbackId = 0; ReadbackId < NumBufferReadbacks; )
+        {
+            u32 NumInBlock = Min(BuffersPerBlock, NumBufferReadbacks - ReadbackId);
+            for (u32 SubId = 0; SubId < NumInBlock; ++SubId)
+            {
+                vk_buffer_readback* Readback = BlockGetData(CurrBlock, vk_buffer_readback) + SubId;
+
+                VkBufferCopy Region = {};
+                Region.srcOffset = Readback->SrcOffset;
+                Region.dstOffset = Readback->ReadbackOffset;
+                Region.size = Readback->Size;
+                vkCmdCopyBuffer(Commands->Buffer, Readback->Buffer, Commands->ReadbackArena.Buffer, 1, &Region);
+            }
+
+            ReadbackId += NumInBlock;
+            CurrBlock = CurrBlock->Next;
+        }
+
+        CurrBlock = Commands->ImageReadbackArena.Next;
+        for (u32 ReadbackId = 0; ReadbackId < NumImageReadbacks; )
+        {
+            u32 NumInBlock = Min(ImagesPerBlock, NumImageReadbacks - ReadbackId);
+            for (u32 SubId = 0; SubId < NumInBlock; ++SubId)
+            {
+                vk_image_readback* Readback = BlockGetData(CurrBlock, vk_image_readback) + SubId;
+
+                VkBufferImageCopy Region = {};
+                Region.bufferOffset = Readback->ReadbackOffset;
+                Region.bufferRowLength = 0;
+                Region.bufferImageHeight = 0;
+                Region.imageSubresource.aspectMask = Readback->AspectMask;
+                Region.imageSubresource.mipLevel = Readback->MipLevel;
+                Region.imageSubresource.baseArrayLayer = Readback->Layer;
+                Region.imageSubresource.layerCount = 1;
+                Region.imageOffset.x = Readback->OffsetX;
+                Region.imageOffset.y = Readback->OffsetY;
+                Region.imageOffset.z = 0;
+                Region.imageExtent.width = Readback->Width;
+                Region.imageExtent.height = Readback->Height;
+                Region.imageExtent.depth = 1;
+                vkCmdCopyImageToBuffer(Commands->Buffer, Readback->Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                       Commands->ReadbackArena.Buffer, 1, &Region);
+            }
+
+            ReadbackId += NumInBlock;
+            CurrBlock = CurrBlock->Next;
+        }
+    }
+
+    // NOTE: Apply post copy barriers, sources go back to how we found them and the copies become visible to the host
+    {
+        VkBarrierBufferAdd(Commands, Commands->ReadbackArena.Buffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                           VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+
+        block* CurrBlock = Commands->BufferReadbackArena.Next;
+        for (u32 ReadbackId = 0; ReadbackId < NumBufferReadbacks; )
+        {
+            u32 NumInBlock = Min(BuffersPerBlock, NumBufferReadbacks - ReadbackId);
+            for (u32 SubId = 0; SubId < NumInBlock; ++SubId)
+            {
+                vk_buffer_readback* Readback = BlockGetData(CurrBlock, vk_buffer_readback) + SubId;
+                VkBarrierBufferAdd(Commands, ReadMask, Readback->InputMask, Readback->Buffer);
+            }
+
+            ReadbackId += NumInBlock;
+            CurrBlock = CurrBlock->Next;
+        }
+
+        CurrBlock = Commands->ImageReadbackArena.Next;
+        for (u32 ReadbackId = 0; ReadbackId < NumImageReadbacks; )
+        {
+            u32 NumInBlock = Min(ImagesPerBlock, NumImageReadbacks - ReadbackId);
+            for (u32 SubId = 0; SubId < NumInBlock; ++SubId)
+            {
+                vk_image_readback* Readback = BlockGetData(CurrBlock, vk_image_readback) + SubId;
+                b32 StaysTransferSrc = (Readback->OutputLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL &&
+                                        Readback->OutputMask.AccessMask == ReadMask.AccessMask &&
+                                        Readback->OutputMask.StageMask == ReadMask.StageMask);
+                if (Readback->OwnsBarrier && !StaysTransferSrc)
+                {
+                    VkBarrierImageAdd(Commands, Readback->Image, VkImageReadbackGetRange(Readback), ReadMask,
+                                      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Readback->OutputMask, Readback->OutputLayout);
+                }
+            }
+
+            ReadbackId += NumInBlock;
+            CurrBlock = CurrBlock->Next;
+        }
+
+        VkCommandsBarrierFlush(Commands);
+    }
+
+    ArenaClear(&Commands->BufferReadbackArena);
+    ArenaClear(&Commands->ImageReadbackArena);
+
+    VkGpuScopeEnd(Commands);
+}
+
+inline b32 VkReadbackIsReady(vk_readback* Readback, VkDevice Device)
+{
+    // NOTE: Returns false until the submit the read was recorded in has finished, never blocks
+    vk_commands* Commands = Readback->Commands;
+    Assert(Readback->Generation == Commands->Generation);
+
+    b32 Result = vkGetFenceStatus(Device, Commands->Fence) == VK_SUCCESS;
+    return Result;
+}
+
+inline void VkReadbackWait(vk_readback* Readback, VkDevice Device)
+{
+    // IMPORTANT: Only call after the commands got submitted, otherwise the fence never signals
+    vk_commands* Commands = Readback->Commands;
+    Assert(Readback->Generation == Commands->Generation);
+
+    VkCheckResult(vkWaitForFences(Device, 1, &Commands->Fence, VK_TRUE, 0xFFFFFFFF));
+}
+
+inline u8* VkReadbackGetData(vk_readback* Readback, VkDevice Device)
+{
+    Assert(VkReadbackIsReady(Readback, Device));
+
+    vk_readback_arena* Arena = &Readback->Commands->ReadbackArena;
+    if (!Arena->IsCoherent && !Readback->Invalidated)
+    {
+        // NOTE: Invalidate ranges have to be aligned to nonCoherentAtomSize
+        u64 Begin = (Readback->Offset / Arena->InvalidateAlignment) * Arena->InvalidateAlignment;
+        u64 End = Min(AlignAddress(Readback->Offset + Readback->Size, Arena->InvalidateAlignment), Arena->Size);
+
+        VkMappedMemoryRange InvalidateRange = {};
+        InvalidateRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        InvalidateRange.memory = Arena->Memory;
+        InvalidateRange.offset = Begin;
+        InvalidateRange.size = End - Begin;
+        VkCheckResult(vkInvalidateMappedMemoryRanges(Device, 1, &InvalidateRange));
+        Readback->Invalidated = true;
+    }
+
+    u8* Result = Arena->MappedPtr + Readback->Offset;
+    return Result;
 }
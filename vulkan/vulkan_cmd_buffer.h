@@ -41,6 +41,19 @@ struct vk_image_transfer
     u32 Width;
     u32 Height;
     u32 Depth;
+
+    u32 MipLevel;
+    u32 BaseLayer;
+    u32 NumLayers;
+
+    // NOTE: Staging layout in texels, 0 means tightly packed
+    u32 RowLength;
+    u32 ImageHeight;
+
+    // NOTE: Mips and layers the barrier pair covers starting at MipLevel/BaseLayer. 0 if another transfer of the same
+    // set carries the barriers
+    u32 BarrierNumMips;
+    u32 BarrierNumLayers;
     
     barrier_mask InputMask;
     VkImageLayout InputLayout;
@@ -49,10 +62,156 @@ struct vk_image_transfer
     VkImageLayout OutputLayout;
 };
 
+//
+// NOTE: Readback Data
+//
+
+struct vk_buffer_readback
+{
+    VkBuffer Buffer;
+    u64 SrcOffset;
+    u64 Size;
+    u64 ReadbackOffset;
+
+    // NOTE: Last access of the buffer before the read, we restore it after the copy
+    barrier_mask InputMask;
+};
+
+struct vk_image_readback
+{
+    VkImage Image;
+    VkImageAspectFlags AspectMask;
+    u32 OffsetX;
+    u32 OffsetY;
+    u32 Width;
+    u32 Height;
+    u32 MipLevel;
+    u32 Layer;
+    u64 ReadbackOffset;
+
+    // NOTE: Only the first read of a subresource in a batch owns the barrier pair, so reading it twice never puts two
+    // transitions of it in one barrier call
+    barrier_mask InputMask;
+    VkImageLayout InputLayout;
+    barrier_mask OutputMask;
+    VkImageLayout OutputLayout;
+    b32 OwnsBarrier;
+};
+
+//
+// NOTE: Bind State
+//
+
+#define VK_BIND_MAX_DESCRIPTOR_SETS 8
+#define VK_BIND_MAX_VERTEX_BUFFERS 8
+
+struct vk_bind_stats
+{
+    u32 NumPipelineBinds;
+    u32 NumPipelineBindsElided;
+    u32 NumDescriptorSetBinds;
+    u32 NumDescriptorSetBindsElided;
+    u32 NumVertexBufferBinds;
+    u32 NumVertexBufferBindsElided;
+    u32 NumIndexBufferBinds;
+    u32 NumIndexBufferBindsElided;
+    u32 NumDynamicStateSets;
+    u32 NumDynamicStateSetsElided;
+};
+
+// NOTE: Shadow of what is bound on the command buffer so we can skip redundant vkCmd* calls. Index 0 is graphics, 1 is compute
+struct vk_bind_state
+{
+    VkPipeline Pipelines[2];
+    VkPipelineLayout Layouts[2];
+    VkDescriptorSet DescriptorSets[2][VK_BIND_MAX_DESCRIPTOR_SETS];
+
+    VkBuffer VertexBuffers[VK_BIND_MAX_VERTEX_BUFFERS];
+    VkDeviceSize VertexOffsets[VK_BIND_MAX_VERTEX_BUFFERS];
+
+    VkBuffer IndexBuffer;
+    VkDeviceSize IndexOffset;
+    VkIndexType IndexType;
+
+    b32 ViewportValid;
+    VkViewport Viewport;
+    b32 ScissorValid;
+    VkRect2D Scissor;
+};
+
+//
+// NOTE: Transfer Coalescing
+//
+
+#define VK_TRANSFER_COALESCE_MAX 256
+#define VK_MAX_FLUSH_RANGES 64
+
+struct vk_buffer_copy_entry
+{
+    VkBuffer Buffer;
+    VkBuffer StagingBuffer;
+    u64 DstOffset;
+    u64 SrcOffset;
+    u64 Size;
+    u32 Seq;
+    b32 Elided;
+};
+
+struct vk_image_copy_entry
+{
+    vk_image_transfer* Transfer;
+    u32 Seq;
+    b32 Elided;
+};
+
+struct vk_transfer_stats
+{
+    u32 NumTransfers;
+    u32 NumCopyCommands;
+    u32 NumCopyRegions;
+    u32 NumElided;
+    u32 NumMerged;
+
+    u32 NumDirectWrites;
+    u64 DirectWriteBytes;
+};
+
+//
+// NOTE: Split Barriers
+//
+
+#define VK_COMMANDS_MAX_EVENTS 32
+
+// NOTE: Events get handed out in order and reset together once the fence of the commands signaled
+struct vk_event_pool
+{
+    u32 NumEvents;
+    u32 NumUsed;
+    VkEvent Events[VK_COMMANDS_MAX_EVENTS];
+};
+
+#define VK_SPLIT_BARRIER_MAX_BARRIERS 8
+
+struct vk_split_barrier
+{
+    VkEvent Event;
+    VkPipelineStageFlags SrcStageMask;
+
+    // NOTE: Go out with the wait, kept out of the batch so flushes between signal and wait don't send them early
+    VkPipelineStageFlags DstStageMask;
+    u32 NumMemoryBarriers;
+    VkMemoryBarrier MemoryBarriers[VK_SPLIT_BARRIER_MAX_BARRIERS];
+    u32 NumBufferBarriers;
+    VkBufferMemoryBarrier BufferBarriers[VK_SPLIT_BARRIER_MAX_BARRIERS];
+    u32 NumImageBarriers;
+    VkImageMemoryBarrier ImageBarriers[VK_SPLIT_BARRIER_MAX_BARRIERS];
+};
+
 struct vk_commands
 {
     VkCommandBuffer Buffer;
     VkFence Fence;
+    b32 IsSecondary;
 
     // NOTE: Barrier Batching
     u32 NumMemoryBarriers;
@@ -67,6 +226,10 @@ struct vk_commands
     VkPipelineStageFlags SrcStageFlags;
     VkPipelineStageFlags DstStageFlags;
 
+    // NOTE: Split barriers, the pool is empty until VkCommandsEventPoolCreate. Only primaries can have one since the
+    // pool gets recycled in VkCommandsBeginSignaled
+    vk_event_pool EventPool;
+
     // NOTE: Transfer Data
     u32 FlushAlignment;
     vk_staging_arena StagingArena;
@@ -76,7 +239,203 @@ struct vk_commands
     
     u32 NumImageTransfers;
     block_arena ImageTransferArena;
+
+    // NOTE: Accumulates over all flushes, reset it whenever you want to measure
+    vk_transfer_stats TransferStats;
+
+    // NOTE: Readback Data, the arena only exists after VkCommandsReadbackCreate
+    vk_readback_arena ReadbackArena;
+
+    // NOTE: Reads queued since the last VkCommandsReadbackFlush
+    u32 NumBufferReadbacks;
+    block_arena BufferReadbackArena;
+
+    u32 NumImageReadbacks;
+    block_arena ImageReadbackArena;
+
+    // NOTE: Increments every time we begin recording, readbacks from older generations are overwritten
+    u64 Generation;
+
+    // NOTE: How long the cpu blocked on our fence the last time we began recording
+    f32 FenceWaitMs;
+
+    // NOTE: Secondaries that continue a render pass can't record barriers or transfers
+    b32 InsideRenderPass;
+
+    // NOTE: Set by VkCommandsSecondaryEnd and cleared by VkCommandsParallelReset, tells the execute which threads recorded
+    // and whether they continue a render pass
+    b32 SecondaryRecorded;
+    b32 SecondaryInsideRenderPass;
+
+    // NOTE: Set by VkGpuProfilerFrameBegin, gpu scopes are no-ops while this is null
+    vk_gpu_profiler* Profiler;
+
+    // NOTE: Set by VkQueryAllocatorFrameBegin, occlusion and statistics queries are no-ops while this is null
+    vk_query_allocator* Queries;
+
+    // NOTE: Redundant bind filtering, LastFrameBindStats holds the counters from before the last begin
+    vk_bind_state BindState;
+    vk_bind_stats BindStats;
+    vk_bind_stats LastFrameBindStats;
+};
+
+// NOTE: Future for a pushed read, ready once the fence of the submit it was recorded in signals
+struct vk_readback
+{
+    vk_commands* Commands;
+    u64 Generation;
+    u64 Offset;
+    u64 Size;
+    b32 Invalidated;
+};
+
+//
+// NOTE: Command Ring
+//
+
+struct vk_commands_ring_stats
+{
+    u32 NumAcquires;
+    u32 NumStalls;
+    u32 NumTryFails;
+    f32 LastWaitMs;
+    f32 MaxWaitMs;
+    f64 TotalWaitMs;
+};
+
+// NOTE: N contexts that get recorded round robin so the cpu can run up to N frames ahead of the gpu
+struct vk_commands_ring
+{
+    u32 NumContexts;
+    u32 CurrContextId;
+    vk_commands* Contexts;
+
+    vk_commands_ring_stats Stats;
+};
+
+//
+// NOTE: Parallel Recording
+//
+
+struct vk_commands_parallel
+{
+    u32 NumThreads;
+    VkCommandPool* Pools;
+    vk_commands* Threads;
+    VkCommandBuffer* Buffers;
+};
+
+//
+// NOTE: Bundles
+//
+
+#define VK_BUNDLE_MAX_PIPELINES 16
+#define VK_BUNDLE_MAX_RESOURCES 32
+
+struct vk_bundle_pipeline_ref
+{
+    vk_pipeline* Pipeline;
+    u32 RecordedGeneration;
+};
+
+// NOTE: Points at the generation counter of a resource we referenced, its owner bumps it whenever it recreates the resource
+struct vk_bundle_resource_ref
+{
+    u32* Generation;
+    u32 RecordedGeneration;
+};
+
+// NOTE: A secondary command buffer that is recorded once and executed every frame until something it references changes
+struct vk_bundle
+{
+    VkCommandPool Pool;
+    vk_commands Commands;
+
+    b32 Recorded;
+    VkRenderPass RenderPass;
+    u32 SubPass;
+
+    u32 NumPipelines;
+    vk_bundle_pipeline_ref Pipelines[VK_BUNDLE_MAX_PIPELINES];
+
+    u32 NumResources;
+    vk_bundle_resource_ref Resources[VK_BUNDLE_MAX_RESOURCES];
+
+    u32 NumRecords;
+    u32 NumExecutes;
+};
+
+//
+// NOTE: Submit Queue
+//
+
+/*
+   NOTE: Recording threads push finished vk_commands and presents into a lock free ring and a dedicated thread hands
+         everything that is ready to the driver in one vkQueueSubmit. The submit thread owns the VkQueue, so presents
+         have to go through the queue as well.
+
+         One vkQueueSubmit only takes one fence. The fence of the last coalesced vk_commands goes on the batch submit,
+         the other fences get signaled with fence only submits right after, which are far cheaper than full submits but
+         still are vkQueueSubmit calls, so a batch of N vk_commands costs N calls. Every vk_commands keeps its own fence
+         because the rings, the profiler and the headless renderer all poll Commands->Fence directly.
+*/
+
+// NOTE: Has to be a power of two, ids wrap around at 2^32 and the ring index must stay continuous when they do
+#define VK_SUBMIT_QUEUE_SIZE 64
+static_assert((VK_SUBMIT_QUEUE_SIZE & (VK_SUBMIT_QUEUE_SIZE - 1)) == 0, "Submit queue size must be a power of two");
+#define VK_SUBMIT_MAX_SEMAPHORES 4
+
+enum vk_submit_entry_type
+{
+    VkSubmitEntry_None,
+
+    VkSubmitEntry_Commands,
+    VkSubmitEntry_Present,
+};
+
+struct vk_submit_entry
+{
+    volatile LONG Ready;
+    vk_submit_entry_type Type;
+
+    VkCommandBuffer Buffer;
+    VkFence Fence;
+
+    VkSwapchainKHR SwapChain;
+    u32 ImageIndex;
+
+    u32 NumWaitSemaphores;
+    VkSemaphore WaitSemaphores[VK_SUBMIT_MAX_SEMAPHORES];
+    VkPipelineStageFlags WaitStages[VK_SUBMIT_MAX_SEMAPHORES];
+
+    u32 NumSignalSemaphores;
+    VkSemaphore SignalSemaphores[VK_SUBMIT_MAX_SEMAPHORES];
+};
+
+struct vk_submit_queue
+{
+    VkQueue Queue;
+    HANDLE Thread;
+    HANDLE WakeSemaphore;
+    volatile LONG Running;
+
+    // NOTE: Producers claim slots with NextWriteId, only the submit thread advances NextReadId
+    volatile LONG NextWriteId;
+    volatile LONG NextReadId;
+    vk_submit_entry Entries[VK_SUBMIT_QUEUE_SIZE];
+
+    volatile LONG LastPresentResult;
+
+    // NOTE: Every vkQueueSubmit call, fence only ones included. NumFenceSubmits counts just those
+    volatile LONG NumQueueSubmits;
+    volatile LONG NumFenceSubmits;
+    volatile LONG NumCommandsSubmitted;
 };
 
+inline void VkCommandsBindStateReset(vk_commands* Commands);
 inline void VkCommandsBarrierFlush(vk_commands* Commands);
+inline void VkCommandsEventPoolReset(vk_commands* Commands, VkDevice Device);
+inline void VkBarrierBufferAdd(vk_commands* Commands, VkBuffer Buffer, VkAccessFlags InputAccessMask, VkPipelineStageFlags InputStageMask,
+                               VkAccessFlags OutputAccessMask, VkPipelineStageFlags OutputStageMask);
 inline void VkCommandsTransferFlush(vk_commands* Commands, VkDevice Device);
+inline void VkCommandsReadbackFlush(vk_commands* Commands);
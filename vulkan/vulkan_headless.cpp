@@ -0,0 +1,231 @@
+
+//
+// NOTE: Headless Batch Rendering
+//
+
+inline vk_headless_renderer* VkHeadlessRendererCreate(linear_arena* Arena, VkDevice Device, VkCommandPool Pool,
+                                                      platform_block_arena* BlockArena, vk_linear_arena* GpuArena, u32 Width,
+                                                      u32 Height, VkFormat Format, u32 NumFrames, u32 BatchSize, u32 FlushAlignment,
+                                                      u32 StagingTypeId, b32 StagingIsCoherent, u32 ReadbackTypeId,
+                                                      b32 ReadbackIsCoherent, u64 NonCoherentAtomSize)
+{
+    // NOTE: GpuArena should be device local, the targets get COLOR_ATTACHMENT, SAMPLED and TRANSFER usage
+    Assert(BatchSize > 0 && BatchSize <= VK_HEADLESS_MAX_BATCH);
+
+    vk_headless_renderer* Result = PushStruct(Arena, vk_headless_renderer);
+    *Result = {};
+    Result->Width = Width;
+    Result->Height = Height;
+    Result->Format = Format;
+    Result->TexelSize = VkFormatGetSize(Format);
+    Result->TargetLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    Result->TargetMask = BarrierMask(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    Result->BatchSize = BatchSize;
+    Result->Pool = Pool;
+
+    Result->Ring = VkCommandsRingCreate(Device, Pool, Arena, BlockArena, NumFrames, FlushAlignment, StagingTypeId, StagingIsCoherent);
+    u64 ReadbackSize = u64(BatchSize) * u64(Width) * u64(Height) * Result->TexelSize + BatchSize * 64;
+    for (u32 ContextId = 0; ContextId < NumFrames; ++ContextId)
+    {
+        VkCommandsReadbackCreate(Result->Ring.Contexts + ContextId, Device, ReadbackTypeId, ReadbackSize, ReadbackIsCoherent,
+                                 NonCoherentAtomSize);
+    }
+
+    Result->Slots = PushArray(Arena, vk_headless_slot, NumFrames);
+    for (u32 SlotId = 0; SlotId < NumFrames; ++SlotId)
+    {
+        Result->Slots[SlotId] = {};
+    }
+
+    u32 NumTargets = NumFrames * BatchSize;
+    Result->Targets = PushArray(Arena, vk_image, NumTargets);
+    for (u32 TargetId = 0; TargetId < NumTargets; ++TargetId)
+    {
+        Result->Targets[TargetId] = VkImageCreate(Device, GpuArena, Width, Height, Format,
+                                                  (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+                                                   VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT),
+                                                  VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+
+    LARGE_INTEGER Frequency;
+    QueryPerformanceFrequency(&Frequency);
+    Result->Frequency = Frequency.QuadPart;
+
+    return Result;
+}
+
+inline void VkHeadlessSlotObserve(vk_headless_renderer* Renderer, VkDevice Device, u32 SlotId)
+{
+    // NOTE: Stamps the completion time the first time the slot's fence is seen signaled, never blocks
+    vk_headless_slot* Slot = Renderer->Slots + SlotId;
+    if (Slot->InFlight && Slot->CompleteTime == 0 &&
+        vkGetFenceStatus(Device, Renderer->Ring.Contexts[SlotId].Fence) == VK_SUCCESS)
+    {
+        LARGE_INTEGER CompleteTime;
+        QueryPerformanceCounter(&CompleteTime);
+        Slot->CompleteTime = CompleteTime.QuadPart;
+    }
+}
+
+inline void VkHeadlessSlotRetire(vk_headless_renderer* Renderer, VkDevice Device, u32 SlotId)
+{
+    // NOTE: Blocks until the slot's batch is done and streams its images into the callers memory
+    vk_headless_slot* Slot = Renderer->Slots + SlotId;
+    if (!Slot->InFlight)
+    {
+        return;
+    }
+
+    vk_commands* Commands = Renderer->Ring.Contexts + SlotId;
+    if (Slot->CompleteTime == 0)
+    {
+        VkCheckResult(vkWaitForFences(Device, 1, &Commands->Fence, VK_TRUE, 0xFFFFFFFF));
+        VkHeadlessSlotObserve(Renderer, Device, SlotId);
+    }
+
+    LARGE_INTEGER RetireTime;
+    QueryPerformanceCounter(&RetireTime);
+    f32 LatencyMs = f32(f64(Slot->CompleteTime - Slot->SubmitTime) * 1000.0 / f64(Renderer->Frequency));
+
+    u64 ImageSize = u64(Renderer->Width) * u64(Renderer->Height) * Renderer->TexelSize;
+    for (u32 JobId = 0; JobId < Slot->NumJobs; ++JobId)
+    {
+        vk_headless_job* Job = Slot->Jobs + JobId;
+        u8* Data = VkReadbackGetData(Slot->Readbacks + JobId, Device);
+        Copy(Data, Job->Output, ImageSize);
+        if (Job->Done)
+        {
+            *Job->Done = true;
+        }
+
+        Renderer->LatencySamples[Renderer->NextSample] = LatencyMs;
+        Renderer->NextSample = (Renderer->NextSample + 1) % VK_HEADLESS_NUM_SAMPLES;
+        Renderer->NumSamples = Min(Renderer->NumSamples + 1, u32(VK_HEADLESS_NUM_SAMPLES));
+    }
+
+    Renderer->NumImages += Slot->NumJobs;
+    Renderer->LastRetireTime = RetireTime.QuadPart;
+    Slot->InFlight = false;
+    Slot->CompleteTime = 0;
+    Slot->NumJobs = 0;
+}
+
+inline void VkHeadlessBatchSubmit(vk_headless_renderer* Renderer, VkDevice Device, VkQueue Queue, vk_headless_job* Jobs,
+                                  u32 NumJobs, vk_headless_record_job* RecordJob)
+{
+    Assert(NumJobs > 0 && NumJobs <= Renderer->BatchSize);
+
+    // NOTE: Checking every slot here keeps completion stamps close to the real finish even if the caller never polls
+    for (u32 ObserveId = 0; ObserveId < Renderer->Ring.NumContexts; ++ObserveId)
+    {
+        VkHeadlessSlotObserve(Renderer, Device, ObserveId);
+    }
+
+    // NOTE: The readbacks of the slot we are about to reuse live until its commands begin again, so retire them first
+    u32 SlotId = (Renderer->Ring.CurrContextId + 1) % Renderer->Ring.NumContexts;
+    VkHeadlessSlotRetire(Renderer, Device, SlotId);
+
+    vk_commands* Commands = VkCommandsRingAcquire(&Renderer->Ring, Device);
+    vk_headless_slot* Slot = Renderer->Slots + SlotId;
+    Slot->NumJobs = NumJobs;
+
+    vk_image* SlotTargets = Renderer->Targets + SlotId * Renderer->BatchSize;
+    barrier_mask TransferSrcMask = BarrierMask(VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    for (u32 JobId = 0; JobId < NumJobs; ++JobId)
+    {
+        Slot->Jobs[JobId] = Jobs[JobId];
+        RecordJob(Commands, SlotTargets + JobId, Jobs[JobId].Data);
+    }
+
+    // NOTE: Reads get pushed after all jobs so the whole batch shares one transition, the targets stay in transfer src
+    // since the next job on them transitions from undefined anyway
+    for (u32 JobId = 0; JobId < NumJobs; ++JobId)
+    {
+        Slot->Readbacks[JobId] = VkCommandsPushReadImage(Commands, SlotTargets[JobId].Image, Renderer->Width, Renderer->Height,
+                                                         Renderer->TexelSize, VK_IMAGE_ASPECT_COLOR_BIT, Renderer->TargetLayout,
+                                                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Renderer->TargetMask, TransferSrcMask);
+    }
+
+    VkCommandsSubmit(Commands, Device, Queue);
+
+    LARGE_INTEGER SubmitTime;
+    QueryPerformanceCounter(&SubmitTime);
+    Slot->SubmitTime = SubmitTime.QuadPart;
+    Slot->InFlight = true;
+    if (Renderer->FirstSubmitTime == 0)
+    {
+        Renderer->FirstSubmitTime = SubmitTime.QuadPart;
+    }
+}
+
+inline void VkHeadlessPoll(vk_headless_renderer* Renderer, VkDevice Device)
+{
+    // NOTE: Streams out every batch that already finished without blocking
+    for (u32 SlotId = 0; SlotId < Renderer->Ring.NumContexts; ++SlotId)
+    {
+        VkHeadlessSlotObserve(Renderer, Device, SlotId);
+        if (Renderer->Slots[SlotId].CompleteTime != 0)
+        {
+            VkHeadlessSlotRetire(Renderer, Device, SlotId);
+        }
+    }
+}
+
+inline void VkHeadlessFlush(vk_headless_renderer* Renderer, VkDevice Device)
+{
+    // NOTE: Retires oldest first so Done flags get set in submit order
+    for (u32 Offset = 1; Offset <= Renderer->Ring.NumContexts; ++Offset)
+    {
+        u32 SlotId = (Renderer->Ring.CurrContextId + Offset) % Renderer->Ring.NumContexts;
+        VkHeadlessSlotRetire(Renderer, Device, SlotId);
+    }
+}
+
+inline vk_headless_stats VkHeadlessStatsGet(vk_headless_renderer* Renderer)
+{
+    vk_headless_stats Result = {};
+    Result.NumImages = Renderer->NumImages;
+
+    if (Renderer->NumImages > 0 && Renderer->LastRetireTime > Renderer->FirstSubmitTime)
+    {
+        f64 Seconds = f64(Renderer->LastRetireTime - Renderer->FirstSubmitTime) / f64(Renderer->Frequency);
+        Result.ImagesPerSecond = f32(f64(Renderer->NumImages) / Seconds);
+    }
+
+    f32 Sorted[VK_HEADLESS_NUM_SAMPLES];
+    Copy(Renderer->LatencySamples, Sorted, sizeof(f32) * Renderer->NumSamples);
+    Result.LatencyMs = VkPercentilesCompute(Sorted, Renderer->NumSamples);
+
+    return Result;
+}
+
+inline void VkHeadlessStatsReset(vk_headless_renderer* Renderer)
+{
+    Renderer->FirstSubmitTime = 0;
+    Renderer->LastRetireTime = 0;
+    Renderer->NumImages = 0;
+    Renderer->NumSamples = 0;
+    Renderer->NextSample = 0;
+}
+
+inline void VkHeadlessRendererDestroy(vk_headless_renderer* Renderer, VkDevice Device)
+{
+    // NOTE: Target memory belongs to the arena passed to create, the pool itself to the caller
+    VkHeadlessFlush(Renderer, Device);
+
+    for (u32 ContextId = 0; ContextId < Renderer->Ring.NumContexts; ++ContextId)
+    {
+        vk_commands* Commands = Renderer->Ring.Contexts + ContextId;
+        VkCommandsReadbackDestroy(Commands, Device);
+        VkCommandsEventPoolDestroy(Commands, Device);
+        ArenaClear(&Commands->StagingArena);
+        vkFreeCommandBuffers(Device, Renderer->Pool, 1, &Commands->Buffer);
+        vkDestroyFence(Device, Commands->Fence, 0);
+    }
+
+    u32 NumTargets = Renderer->Ring.NumContexts * Renderer->BatchSize;
+    for (u32 TargetId = 0; TargetId < NumTargets; ++TargetId)
+    {
+        VkImageDestroy(Device, Renderer->Targets[TargetId]);
+    }
+}
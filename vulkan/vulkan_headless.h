@@ -0,0 +1,81 @@
+#pragma once
+
+//
+// NOTE: Headless Batch Rendering
+//
+
+/*
+   NOTE: Offscreen throughput mode for servers rendering thumbnails and frames. Jobs get submitted in batches, every
+         batch records into its own vk_commands from a ring and its own set of render targets, so while the gpu renders
+         batch N the cpu records uploads for batch N + 1 and copies the readbacks of batch N - NumFrames + 1 into the
+         caller's memory. Nothing waits on the gpu until a batch's slot comes around again.
+
+         The record callback gets the job's render target and has to leave it in TargetLayout after TargetMask (color
+         attachment by default). Once every job of the batch is recorded the renderer pushes all readbacks, so they share
+         one transition batch, and leaves the targets in TRANSFER_SRC_OPTIMAL after the copy. The callback should
+         transition its target from VK_IMAGE_LAYOUT_UNDEFINED with a TRANSFER_READ source mask since the previous
+         contents are never needed.
+*/
+
+#define VK_HEADLESS_MAX_BATCH 64
+#define VK_HEADLESS_NUM_SAMPLES 1024
+
+struct vk_headless_job
+{
+    void* Data;
+
+    // NOTE: Caller memory the image gets copied to, Width * Height * TexelSize bytes. Done is set once it landed
+    u8* Output;
+    b32* Done;
+};
+
+#define VK_HEADLESS_RECORD_JOB(Name) void Name(vk_commands* Commands, vk_image* Target, void* JobData)
+typedef VK_HEADLESS_RECORD_JOB(vk_headless_record_job);
+
+struct vk_headless_slot
+{
+    b32 InFlight;
+    i64 SubmitTime;
+
+    // NOTE: When we first saw the fence signaled, 0 until then. Latency is measured up to here so the time a finished
+    // batch waits for its slot to come around doesn't count
+    i64 CompleteTime;
+
+    u32 NumJobs;
+    vk_headless_job Jobs[VK_HEADLESS_MAX_BATCH];
+    vk_readback Readbacks[VK_HEADLESS_MAX_BATCH];
+};
+
+struct vk_headless_stats
+{
+    f32 ImagesPerSecond;
+    vk_gpu_percentiles LatencyMs;
+    u64 NumImages;
+};
+
+struct vk_headless_renderer
+{
+    u32 Width;
+    u32 Height;
+    VkFormat Format;
+    u32 TexelSize;
+    VkImageLayout TargetLayout;
+    barrier_mask TargetMask;
+
+    u32 BatchSize;
+    VkCommandPool Pool;
+    vk_commands_ring Ring;
+    vk_headless_slot* Slots;
+
+    // NOTE: BatchSize targets per slot, reused every time the slot comes around
+    vk_image* Targets;
+
+    // NOTE: Submit to completion time of every image in ms, ring buffer of the latest samples
+    i64 Frequency;
+    i64 FirstSubmitTime;
+    i64 LastRetireTime;
+    u64 NumImages;
+    u32 NumSamples;
+    u32 NextSample;
+    f32 LatencySamples[VK_HEADLESS_NUM_SAMPLES];
+};
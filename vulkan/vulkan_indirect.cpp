@@ -0,0 +1,193 @@
+
+//
+// NOTE: Indirect Commands
+//
+
+inline void VkCommandsDrawIndexedIndirect(vk_commands* Commands, vk_indirect_batch Batch)
+{
+    if (Batch.NumDraws > 0)
+    {
+        vkCmdDrawIndexedIndirect(Commands->Buffer, Batch.Buffer, Batch.Offset, Batch.NumDraws, sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+inline void VkCommandsDrawIndexedIndirectCount(vk_commands* Commands, VkBuffer DrawBuffer, u64 DrawOffset, VkBuffer CountBuffer,
+                                               u64 CountOffset, u32 MaxDraws)
+{
+    vkCmdDrawIndexedIndirectCount(Commands->Buffer, DrawBuffer, DrawOffset, CountBuffer, CountOffset, MaxDraws,
+                                  sizeof(VkDrawIndexedIndirectCommand));
+}
+
+inline void VkCommandsDispatchIndirect(vk_commands* Commands, vk_pipeline* Pipeline, VkDescriptorSet* DescriptorSets,
+                                       u32 NumDescriptorSets, VkBuffer Buffer, u64 Offset)
+{
+    VkGpuScopeBegin(Commands, "DispatchIndirect");
+    VkCommandsBindPipeline(Commands, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
+    VkCommandsBindDescriptorSets(Commands, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0, NumDescriptorSets, DescriptorSets);
+    vkCmdDispatchIndirect(Commands->Buffer, Buffer, Offset);
+    VkGpuScopeEnd(Commands);
+}
+
+//
+// NOTE: Indirect Ring
+//
+
+inline vk_indirect_ring VkIndirectRingCreate(VkDevice Device, u32 MemoryTypeId, u32 MaxDrawsPerFrame, u32 NumFrames)
+{
+    // IMPORTANT: MemoryTypeId has to be host visible and host coherent, we never flush
+    vk_indirect_ring Result = {};
+    Result.NumFrames = NumFrames;
+    Result.CurrFrameId = NumFrames - 1;
+    Result.FrameSize = u64(MaxDrawsPerFrame) * sizeof(VkDrawIndexedIndirectCommand);
+
+    Result.Buffer = VkBufferHandleCreate(Device, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, Result.FrameSize * NumFrames);
+    VkMemoryRequirements MemoryRequirements = VkBufferGetMemoryRequirements(Device, Result.Buffer);
+    Assert(MemoryRequirements.memoryTypeBits & (1 << MemoryTypeId));
+    Result.Memory = VkMemoryAllocate(Device, MemoryTypeId, MemoryRequirements.size);
+    VkCheckResult(vkBindBufferMemory(Device, Result.Buffer, Result.Memory, 0));
+    VkCheckResult(vkMapMemory(Device, Result.Memory, 0, VK_WHOLE_SIZE, 0, (void**)&Result.MappedPtr));
+
+    return Result;
+}
+
+inline void VkIndirectRingDestroy(vk_indirect_ring* Ring, VkDevice Device)
+{
+    vkDestroyBuffer(Device, Ring->Buffer, 0);
+    vkUnmapMemory(Device, Ring->Memory);
+    vkFreeMemory(Device, Ring->Memory, 0);
+}
+
+inline void VkIndirectRingFrameBegin(vk_indirect_ring* Ring)
+{
+    // IMPORTANT: Call after waiting on the fence of the frame that last used this region, same cadence as the command ring
+    Ring->CurrFrameId = (Ring->CurrFrameId + 1) % Ring->NumFrames;
+    Ring->FrameOffset = Ring->CurrFrameId * Ring->FrameSize;
+    Ring->Used = 0;
+}
+
+inline vk_indirect_batch VkIndirectBatchBegin(vk_indirect_ring* Ring)
+{
+    vk_indirect_batch Result = {};
+    Result.Buffer = Ring->Buffer;
+    Result.Offset = Ring->FrameOffset + Ring->Used;
+
+    return Result;
+}
+
+inline void VkIndirectBatchDrawAdd(vk_indirect_ring* Ring, vk_indirect_batch* Batch, u32 NumIndices, u32 NumInstances = 1,
+                                   u32 FirstIndex = 0, i32 VertexOffset = 0, u32 FirstInstance = 0)
+{
+    // NOTE: Draws of a batch have to be contiguous, don't interleave adds to different batches
+    Assert(Batch->Offset + Batch->NumDraws * sizeof(VkDrawIndexedIndirectCommand) == Ring->FrameOffset + Ring->Used);
+    Assert(Ring->Used + sizeof(VkDrawIndexedIndirectCommand) <= Ring->FrameSize);
+
+    VkDrawIndexedIndirectCommand* Command = (VkDrawIndexedIndirectCommand*)(Ring->MappedPtr + Ring->FrameOffset + Ring->Used);
+    Command->indexCount = NumIndices;
+    Command->instanceCount = NumInstances;
+    Command->firstIndex = FirstIndex;
+    Command->vertexOffset = VertexOffset;
+    Command->firstInstance = FirstInstance;
+
+    Ring->Used += sizeof(VkDrawIndexedIndirectCommand);
+    Batch->NumDraws += 1;
+}
+
+//
+// NOTE: Indirect Culling
+//
+
+inline vk_indirect_cull VkIndirectCullCreate(VkDevice Device, vk_linear_arena* GpuArena, VkDescriptorPool DescriptorPool,
+                                             vk_descriptor_manager* DescriptorManager, vk_pipeline_manager* PipelineManager,
+                                             linear_arena* TempArena, char* ShaderFileName, u32 MaxInstances)
+{
+    // NOTE: GpuArena should be device local
+    vk_indirect_cull Result = {};
+    Result.MaxInstances = MaxInstances;
+
+    Result.InstanceBuffer = VkBufferCreate(Device, GpuArena, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                           sizeof(vk_indirect_instance) * MaxInstances);
+    Result.DrawBuffer = VkBufferCreate(Device, GpuArena, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                       sizeof(VkDrawIndexedIndirectCommand) * MaxInstances);
+    Result.CountBuffer = VkBufferCreate(Device, GpuArena, (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                           VK_BUFFER_USAGE_TRANSFER_DST_BIT), sizeof(u32));
+
+    {
+        vk_descriptor_layout_builder Builder = VkDescriptorLayoutBegin(&Result.DescriptorLayout);
+        VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        VkDescriptorLayoutEnd(Device, &Builder, PipelineManager);
+    }
+
+    Result.DescriptorSet = VkDescriptorSetAllocate(Device, DescriptorPool, Result.DescriptorLayout);
+    VkDescriptorBufferWrite(DescriptorManager, Result.DescriptorSet, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Result.InstanceBuffer);
+    VkDescriptorBufferWrite(DescriptorManager, Result.DescriptorSet, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Result.DrawBuffer);
+    VkDescriptorBufferWrite(DescriptorManager, Result.DescriptorSet, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Result.CountBuffer);
+
+    Result.Pipeline = VkPipelineComputeCreate(Device, PipelineManager, TempArena, ShaderFileName, "main", &Result.DescriptorLayout, 1,
+                                              sizeof(vk_indirect_cull_params));
+
+    return Result;
+}
+
+inline void VkIndirectCullInstancesUpload(vk_commands* Commands, vk_indirect_cull* Cull, vk_indirect_instance* Instances,
+                                          u32 NumInstances)
+{
+    Assert(NumInstances <= Cull->MaxInstances);
+    Cull->NumInstances = NumInstances;
+
+    u8* GpuData = VkCommandsPushWrite(Commands, Cull->InstanceBuffer, 0, sizeof(vk_indirect_instance) * NumInstances,
+                                      BarrierMask(VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT),
+                                      BarrierMask(VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT));
+    Copy(Instances, GpuData, sizeof(vk_indirect_instance) * NumInstances);
+}
+
+inline void VkIndirectCullRecord(vk_commands* Commands, vk_indirect_cull* Cull, v4* FrustumPlanes)
+{
+    // IMPORTANT: Call outside of a render pass, the draws become visible to VkIndirectCullDraw
+    VkGpuScopeBegin(Commands, "IndirectCull");
+
+    // NOTE: Last use of the draw and count buffers was the indirect draw
+    VkBarrierBufferAdd(Commands, Cull->CountBuffer, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                       VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+    vkCmdFillBuffer(Commands->Buffer, Cull->CountBuffer, 0, sizeof(u32), 0);
+
+    VkBarrierBufferAdd(Commands, Cull->CountBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkBarrierBufferAdd(Commands, Cull->DrawBuffer, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    vk_indirect_cull_params Params = {};
+    Copy(FrustumPlanes, Params.FrustumPlanes, sizeof(Params.FrustumPlanes));
+    Params.NumInstances = Cull->NumInstances;
+
+    VkCommandsBindPipeline(Commands, VK_PIPELINE_BIND_POINT_COMPUTE, Cull->Pipeline->Handle);
+    VkCommandsBindDescriptorSets(Commands, VK_PIPELINE_BIND_POINT_COMPUTE, Cull->Pipeline->Layout, 0, 1, &Cull->DescriptorSet);
+    vkCmdPushConstants(Commands->Buffer, Cull->Pipeline->Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Params), &Params);
+    vkCmdDispatch(Commands->Buffer, (Cull->NumInstances + VK_INDIRECT_CULL_GROUP_SIZE - 1) / VK_INDIRECT_CULL_GROUP_SIZE, 1, 1);
+
+    VkBarrierBufferAdd(Commands, Cull->CountBuffer, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    VkBarrierBufferAdd(Commands, Cull->DrawBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    VkGpuScopeEnd(Commands);
+}
+
+inline void VkIndirectCullDraw(vk_commands* Commands, vk_indirect_cull* Cull)
+{
+    // NOTE: Expects the graphics pipeline, descriptor sets, vertex and index buffers to be bound already
+    VkCommandsDrawIndexedIndirectCount(Commands, Cull->DrawBuffer, 0, Cull->CountBuffer, 0, Cull->NumInstances);
+}
+
+inline void VkIndirectCullDestroy(vk_indirect_cull* Cull, VkDevice Device)
+{
+    // NOTE: Buffer memory belongs to the arena passed to create, the pipeline to the pipeline manager
+    vkDestroyBuffer(Device, Cull->InstanceBuffer, 0);
+    vkDestroyBuffer(Device, Cull->DrawBuffer, 0);
+    vkDestroyBuffer(Device, Cull->CountBuffer, 0);
+    vkDestroyDescriptorSetLayout(Device, Cull->DescriptorLayout, 0);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+//
+// NOTE: Indirect Draws
+//
+
+/*
+   NOTE: vk_indirect_ring packs VkDrawIndexedIndirectCommand records into a persistently mapped buffer with one region
+         per frame in flight, so the cpu can batch thousands of draws into a single vkCmdDrawIndexedIndirect.
+
+         vk_indirect_cull moves that to the gpu. Instances get uploaded once, a compute shader tests their bounding
+         spheres against the frustum, appends a draw for every visible one and writes the count, and a single
+         vkCmdDrawIndexedIndirectCount draws the survivors. The shader is supplied by the app and has to match:
+
+         - layout(local_size_x = VK_INDIRECT_CULL_GROUP_SIZE)
+         - set 0 binding 0: readonly buffer of vk_indirect_instance
+         - set 0 binding 1: writeonly buffer of VkDrawIndexedIndirectCommand
+         - set 0 binding 2: buffer with a single uint draw count, incremented with atomicAdd
+         - push constants: vk_indirect_cull_params
+
+         The count draw needs Vulkan 1.2 or VK_KHR_draw_indirect_count (drawIndirectCount feature).
+*/
+
+#define VK_INDIRECT_CULL_GROUP_SIZE 64
+
+struct vk_indirect_batch
+{
+    VkBuffer Buffer;
+    u64 Offset;
+    u32 NumDraws;
+};
+
+struct vk_indirect_ring
+{
+    VkBuffer Buffer;
+    VkDeviceMemory Memory;
+    u8* MappedPtr;
+
+    u32 NumFrames;
+    u32 CurrFrameId;
+    u64 FrameSize;
+    u64 FrameOffset;
+    u64 Used;
+};
+
+// NOTE: std430 layout read by the cull shader
+struct vk_indirect_instance
+{
+    v4 BoundingSphere;
+    u32 NumIndices;
+    u32 FirstIndex;
+    i32 VertexOffset;
+    u32 InstanceId;
+};
+
+struct vk_indirect_cull_params
+{
+    v4 FrustumPlanes[6];
+    u32 NumInstances;
+    u32 Pad[3];
+};
+
+struct vk_indirect_cull
+{
+    u32 MaxInstances;
+    u32 NumInstances;
+
+    vk_pipeline* Pipeline;
+    VkDescriptorSetLayout DescriptorLayout;
+    VkDescriptorSet DescriptorSet;
+
+    VkBuffer InstanceBuffer;
+    VkBuffer DrawBuffer;
+    VkBuffer CountBuffer;
+};
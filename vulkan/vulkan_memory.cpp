@@ -24,6 +24,36 @@ inline i32 VkGetMemoryType(VkPhysicalDeviceMemoryProperties* MemoryProperties, u
     return Result;
 }
 
+inline b32 VkMemoryTypeIsCoherent(VkPhysicalDeviceMemoryProperties* MemoryProperties, u32 MemoryTypeId)
+{
+    b32 Result = (MemoryProperties->memoryTypes[MemoryTypeId].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    return Result;
+}
+
+inline i32 VkGetTransientMemoryType(VkPhysicalDeviceMemoryProperties* MemoryProperties, u32 RequiredType)
+{
+    // NOTE: Lazily allocated memory lets tilers keep transient attachments on chip, desktop gpus don't expose it
+    i32 Result = VkGetMemoryType(MemoryProperties, RequiredType, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+    if (Result == -1)
+    {
+        Result = VkGetMemoryType(MemoryProperties, RequiredType, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+
+    return Result;
+}
+
+inline i32 VkGetReadbackMemoryType(VkPhysicalDeviceMemoryProperties* MemoryProperties, u32 RequiredType)
+{
+    // NOTE: Cached memory makes cpu reads fast, uncached memory is usually write combined and very slow to read
+    i32 Result = VkGetMemoryType(MemoryProperties, RequiredType, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    if (Result == -1)
+    {
+        Result = VkGetMemoryType(MemoryProperties, RequiredType, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    }
+
+    return Result;
+}
+
 inline VkDeviceMemory VkMemoryAllocate(VkDevice Device, u32 Type, u64 Size)
 {
     VkDeviceMemory Result = {};
@@ -206,11 +236,13 @@ inline mm VkStagingArenaGetBlockSize(mm AllocSize)
     return Result;
 }
 
-inline vk_staging_arena VkStagingArenaCreate(VkDevice Device, mm MinBlockSize, mm FlushAlignment, u32 StagingTypeId)
+inline vk_staging_arena VkStagingArenaCreate(VkDevice Device, mm MinBlockSize, mm FlushAlignment, u32 StagingTypeId,
+                                             b32 IsCoherent = false)
 {
     vk_staging_arena Result = {};
     Result.MinBlockSize = AlignAddress(MinBlockSize, FlushAlignment);
     Result.StagingTypeId = StagingTypeId;
+    Result.IsCoherent = IsCoherent;
     Result.Device = Device;
 
     return Result;
@@ -260,6 +292,7 @@ inline vk_staging_ptr VkStagingPushSize(vk_staging_arena* Arena, mm Size, mm Ali
         NewHeader->GpuBuffer = GpuBuffer;
         NewHeader->Used = sizeof(vk_staging_arena_header);
         NewHeader->Size = BufferMemRequirements.size;
+        NewHeader->FlushedUsed = 0;
         
         DoubleListAppend(Arena, NewHeader, Next, Prev);
         Header = NewHeader;
@@ -295,3 +328,108 @@ inline void ArenaClear(vk_staging_arena* Arena)
         vkFreeMemory(Arena->Device, GpuMemory, 0);
     }
 }
+
+//
+// NOTE: Readback Arena
+//
+
+inline vk_readback_arena VkReadbackArenaCreate(VkDevice Device, u32 ReadbackTypeId, u64 Size, b32 IsCoherent, u64 InvalidateAlignment)
+{
+    // NOTE: InvalidateAlignment is VkPhysicalDeviceLimits::nonCoherentAtomSize, pass it for coherent memory too
+    Assert(InvalidateAlignment > 0);
+    vk_readback_arena Result = {};
+    Result.Size = AlignAddress(Size, InvalidateAlignment);
+    Result.IsCoherent = IsCoherent;
+    Result.InvalidateAlignment = InvalidateAlignment;
+
+    Result.Buffer = VkBufferHandleCreate(Device, VK_BUFFER_USAGE_TRANSFER_DST_BIT, Result.Size);
+    VkMemoryRequirements MemoryRequirements = VkBufferGetMemoryRequirements(Device, Result.Buffer);
+    Assert(MemoryRequirements.memoryTypeBits & (1 << ReadbackTypeId));
+    Result.Memory = VkMemoryAllocate(Device, ReadbackTypeId, MemoryRequirements.size);
+    VkCheckResult(vkBindBufferMemory(Device, Result.Buffer, Result.Memory, 0));
+    VkCheckResult(vkMapMemory(Device, Result.Memory, 0, VK_WHOLE_SIZE, 0, (void**)&Result.MappedPtr));
+
+    return Result;
+}
+
+inline void VkReadbackArenaDestroy(vk_readback_arena* Arena, VkDevice Device)
+{
+    if (Arena->Buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(Device, Arena->Buffer, 0);
+        vkUnmapMemory(Device, Arena->Memory);
+        vkFreeMemory(Device, Arena->Memory, 0);
+    }
+}
+
+inline u64 VkReadbackPushSize(vk_readback_arena* Arena, u64 Size, u64 Alignment = 4)
+{
+    // NOTE: Returns the offset into the readback buffer, the arena never grows so size it for the reads of one submit
+    u64 Result = ((Arena->Used + Alignment - 1) / Alignment) * Alignment;
+    Assert(Result + Size <= Arena->Size);
+    Arena->Used = Result + Size;
+
+    return Result;
+}
+
+//
+// NOTE: Direct Write Buffer
+//
+
+#define VK_SMALL_BAR_HEAP_SIZE MegaBytes(256)
+
+inline i32 VkGetDirectWriteMemoryType(VkPhysicalDeviceMemoryProperties* MemoryProperties, u32 RequiredType)
+{
+    // NOTE: Only coherent types so direct writes never need flushes. Without resizable BAR desktop gpus still expose a 256MB
+    // device local host visible heap, we leave that one alone since the driver uses it too
+    i32 Result = VkGetMemoryType(MemoryProperties, RequiredType, (VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                                  VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+    if (Result != -1)
+    {
+        u32 HeapIndex = MemoryProperties->memoryTypes[Result].heapIndex;
+        if (MemoryProperties->memoryHeaps[HeapIndex].size <= VK_SMALL_BAR_HEAP_SIZE)
+        {
+            Result = -1;
+        }
+    }
+
+    return Result;
+}
+
+inline vk_mapped_buffer VkMappedBufferCreate(VkDevice Device, VkPhysicalDeviceMemoryProperties* MemoryProperties, VkBufferUsageFlags Usage,
+                                             u64 Size)
+{
+    vk_mapped_buffer Result = {};
+    Result.Size = Size;
+
+    // NOTE: Transfer dst so we can fall back to staging
+    Result.Buffer = VkBufferHandleCreate(Device, Usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, Size);
+    VkMemoryRequirements MemoryRequirements = VkBufferGetMemoryRequirements(Device, Result.Buffer);
+
+    i32 MemoryTypeId = VkGetDirectWriteMemoryType(MemoryProperties, MemoryRequirements.memoryTypeBits);
+    b32 IsDirect = MemoryTypeId != -1;
+    if (!IsDirect)
+    {
+        MemoryTypeId = VkGetMemoryType(MemoryProperties, MemoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+    Assert(MemoryTypeId != -1);
+
+    Result.Memory = VkMemoryAllocate(Device, MemoryTypeId, MemoryRequirements.size);
+    VkCheckResult(vkBindBufferMemory(Device, Result.Buffer, Result.Memory, 0));
+    if (IsDirect)
+    {
+        VkCheckResult(vkMapMemory(Device, Result.Memory, 0, VK_WHOLE_SIZE, 0, (void**)&Result.MappedPtr));
+    }
+
+    return Result;
+}
+
+inline void VkMappedBufferDestroy(vk_mapped_buffer* Buffer, VkDevice Device)
+{
+    vkDestroyBuffer(Device, Buffer->Buffer, 0);
+    if (Buffer->MappedPtr)
+    {
+        vkUnmapMemory(Device, Buffer->Memory);
+    }
+    vkFreeMemory(Device, Buffer->Memory, 0);
+}
@@ -62,6 +62,9 @@ struct vk_staging_arena_header
     VkBuffer GpuBuffer;
     mm Used;
     mm Size;
+
+    // NOTE: Everything below this has been flushed already
+    mm FlushedUsed;
 };
 
 struct vk_staging_ptr
@@ -78,6 +81,39 @@ struct vk_staging_arena
     vk_staging_arena_header* Next;
     mm MinBlockSize;
     u32 StagingTypeId;
+    b32 IsCoherent;
 
     VkDevice Device;
 };
+
+//
+// NOTE: Readback Arena
+//
+
+// NOTE: One persistently mapped buffer the gpu copies into, cleared every time its vk_commands begins
+struct vk_readback_arena
+{
+    VkBuffer Buffer;
+    VkDeviceMemory Memory;
+    u8* MappedPtr;
+    u64 Size;
+    u64 Used;
+
+    b32 IsCoherent;
+    u64 InvalidateAlignment;
+};
+
+//
+// NOTE: Direct Write Buffer
+//
+
+// NOTE: Buffers in device local memory the cpu can write to (resizable BAR, UMA), writes skip staging and the gpu copy
+struct vk_mapped_buffer
+{
+    VkBuffer Buffer;
+    VkDeviceMemory Memory;
+    u64 Size;
+
+    // NOTE: Null if we couldn't get direct write memory, writes then go through staging like any other buffer
+    u8* MappedPtr;
+};
@@ -0,0 +1,236 @@
+
+//
+// NOTE: Mip Generation
+//
+
+inline vk_mip_generator VkMipGeneratorCreate(VkDevice Device, vk_pipeline_manager* PipelineManager, linear_arena* TempArena,
+                                             char* ShaderFileName)
+{
+    vk_mip_generator Result = {};
+
+    {
+        vk_descriptor_layout_builder Builder = VkDescriptorLayoutBegin(&Result.DescriptorLayout);
+        VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_MIP_GEN_MAX_MIPS - 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        VkDescriptorLayoutAdd(&Builder, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+        VkDescriptorLayoutEnd(Device, &Builder, PipelineManager);
+    }
+
+    Result.Sampler = VkSamplerCreate(Device, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK,
+                                     0.0f);
+    Result.Pipeline = VkPipelineComputeCreate(Device, PipelineManager, TempArena, ShaderFileName, "main", &Result.DescriptorLayout, 1,
+                                              sizeof(vk_mip_gen_params));
+
+    return Result;
+}
+
+inline void VkMipGeneratorDestroy(vk_mip_generator* Generator, VkDevice Device)
+{
+    // NOTE: The pipeline belongs to the pipeline manager
+    vkDestroySampler(Device, Generator->Sampler, 0);
+    vkDestroyDescriptorSetLayout(Device, Generator->DescriptorLayout, 0);
+}
+
+inline b32 VkFormatSupportsLinearBlit(VkPhysicalDevice PhysicalDevice, VkFormat Format)
+{
+    VkFormatProperties Properties = {};
+    vkGetPhysicalDeviceFormatProperties(PhysicalDevice, Format, &Properties);
+
+    VkFormatFeatureFlags Required = (VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                     VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+    b32 Result = (Properties.optimalTilingFeatures & Required) == Required;
+    return Result;
+}
+
+inline vk_mip_chain VkMipChainCreate(VkDevice Device, VkPhysicalDevice PhysicalDevice, VkImage Image, VkFormat Format,
+                                     VkImageAspectFlags AspectMask, u32 Width, u32 Height, u32 NumMips, u32 NumLayers,
+                                     vk_mip_generator* Generator = 0, vk_linear_arena* GpuArena = 0,
+                                     VkDescriptorPool DescriptorPool = VK_NULL_HANDLE, vk_descriptor_manager* DescriptorManager = 0)
+{
+    // NOTE: Generator, GpuArena, DescriptorPool and DescriptorManager are only used if the format can't be blitted. The
+    // image needs TRANSFER_SRC and TRANSFER_DST usage for blits, SAMPLED and STORAGE usage otherwise
+    Assert(NumMips <= VK_MIP_GEN_MAX_MIPS);
+
+    vk_mip_chain Result = {};
+    Result.Image = Image;
+    Result.AspectMask = AspectMask;
+    Result.Width = Width;
+    Result.Height = Height;
+    Result.NumMips = NumMips;
+    Result.NumLayers = NumLayers;
+    Result.UseBlit = VkFormatSupportsLinearBlit(PhysicalDevice, Format);
+
+    if (!Result.UseBlit && NumMips > 1)
+    {
+        Assert(Generator && GpuArena && DescriptorManager);
+        Result.Generator = Generator;
+
+        Result.SrcView = VkImageViewCreate(Device, Image, VK_IMAGE_VIEW_TYPE_2D_ARRAY, Format, AspectMask, 0, NumLayers);
+        for (u32 MipId = 1; MipId < NumMips; ++MipId)
+        {
+            Result.MipViews[MipId - 1] = VkImageViewCreate(Device, Image, VK_IMAGE_VIEW_TYPE_2D_ARRAY, Format, AspectMask, MipId,
+                                                           NumLayers);
+        }
+
+        Result.CounterBuffer = VkBufferCreate(Device, GpuArena, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                              sizeof(u32) * NumLayers);
+
+        Result.DescriptorSet = VkDescriptorSetAllocate(Device, DescriptorPool, Generator->DescriptorLayout);
+        VkDescriptorImageWrite(DescriptorManager, Result.DescriptorSet, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, Result.SrcView,
+                               Generator->Sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        for (u32 SlotId = 0; SlotId < VK_MIP_GEN_MAX_MIPS - 1; ++SlotId)
+        {
+            VkImageView View = Result.MipViews[Min(SlotId, NumMips - 2)];
+            VkDescriptorImageWrite(DescriptorManager, Result.DescriptorSet, 1, SlotId, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, View,
+                                   VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL);
+        }
+        VkDescriptorBufferWrite(DescriptorManager, Result.DescriptorSet, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, Result.CounterBuffer);
+    }
+
+    return Result;
+}
+
+inline void VkMipChainDestroy(vk_mip_chain* Chain, VkDevice Device)
+{
+    // NOTE: Counter memory belongs to the arena passed to create, the descriptor set to its pool
+    if (Chain->Generator)
+    {
+        vkDestroyImageView(Device, Chain->SrcView, 0);
+        for (u32 MipId = 1; MipId < Chain->NumMips; ++MipId)
+        {
+            vkDestroyImageView(Device, Chain->MipViews[MipId - 1], 0);
+        }
+        vkDestroyBuffer(Device, Chain->CounterBuffer, 0);
+    }
+}
+
+inline VkImageSubresourceRange VkMipChainGetRange(vk_mip_chain* Chain, u32 BaseMip, u32 NumMips)
+{
+    VkImageSubresourceRange Result = {};
+    Result.aspectMask = Chain->AspectMask;
+    Result.baseMipLevel = BaseMip;
+    Result.levelCount = NumMips;
+    Result.baseArrayLayer = 0;
+    Result.layerCount = Chain->NumLayers;
+
+    return Result;
+}
+
+inline void VkCommandsMipsBlit(vk_commands* Commands, vk_mip_chain* Chain, barrier_mask InputMask, VkImageLayout InputLayout,
+                               barrier_mask OutputMask, VkImageLayout OutputLayout)
+{
+    barrier_mask ReadMask = BarrierMask(VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    barrier_mask WriteMask = BarrierMask(VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    u32 LastMip = Chain->NumMips - 1;
+
+    VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, 0, 1), InputMask, InputLayout, ReadMask,
+                      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, 1, LastMip), BarrierMask(0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+                      VK_IMAGE_LAYOUT_UNDEFINED, WriteMask, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    VkCommandsBarrierFlush(Commands);
+
+    for (u32 MipId = 1; MipId <= LastMip; ++MipId)
+    {
+        VkImageBlit Blit = {};
+        Blit.srcSubresource.aspectMask = Chain->AspectMask;
+        Blit.srcSubresource.mipLevel = MipId - 1;
+        Blit.srcSubresource.baseArrayLayer = 0;
+        Blit.srcSubresource.layerCount = Chain->NumLayers;
+        Blit.srcOffsets[1].x = i32(Max(Chain->Width >> (MipId - 1), 1u));
+        Blit.srcOffsets[1].y = i32(Max(Chain->Height >> (MipId - 1), 1u));
+        Blit.srcOffsets[1].z = 1;
+        Blit.dstSubresource.aspectMask = Chain->AspectMask;
+        Blit.dstSubresource.mipLevel = MipId;
+        Blit.dstSubresource.baseArrayLayer = 0;
+        Blit.dstSubresource.layerCount = Chain->NumLayers;
+        Blit.dstOffsets[1].x = i32(Max(Chain->Width >> MipId, 1u));
+        Blit.dstOffsets[1].y = i32(Max(Chain->Height >> MipId, 1u));
+        Blit.dstOffsets[1].z = 1;
+        vkCmdBlitImage(Commands->Buffer, Chain->Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Chain->Image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Blit, VK_FILTER_LINEAR);
+
+        // NOTE: The level we just wrote is the source of the next blit
+        if (MipId < LastMip)
+        {
+            VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, MipId, 1), WriteMask, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              ReadMask, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+            VkCommandsBarrierFlush(Commands);
+        }
+    }
+
+    // NOTE: Every level but the last one ended up as a blit source
+    VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, 0, LastMip), ReadMask, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                      OutputMask, OutputLayout);
+    VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, LastMip, 1), WriteMask, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                      OutputMask, OutputLayout);
+    VkCommandsBarrierFlush(Commands);
+}
+
+inline void VkCommandsMipsDispatch(vk_commands* Commands, vk_mip_chain* Chain, barrier_mask InputMask, VkImageLayout InputLayout,
+                                   barrier_mask OutputMask, VkImageLayout OutputLayout)
+{
+    barrier_mask ComputeMask = BarrierMask(VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    barrier_mask ReadMask = BarrierMask(VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    vk_mip_generator* Generator = Chain->Generator;
+
+    // NOTE: Last use of the counters was the previous dispatch on this chain
+    VkBarrierBufferAdd(Commands, Chain->CounterBuffer, ComputeMask.AccessMask, ComputeMask.StageMask, VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT);
+    VkCommandsBarrierFlush(Commands);
+    vkCmdFillBuffer(Commands->Buffer, Chain->CounterBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    VkBarrierBufferAdd(Commands, Chain->CounterBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       ComputeMask.AccessMask, ComputeMask.StageMask);
+    VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, 0, 1), InputMask, InputLayout, ReadMask,
+                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, 1, Chain->NumMips - 1),
+                      BarrierMask(0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT), VK_IMAGE_LAYOUT_UNDEFINED, ComputeMask,
+                      VK_IMAGE_LAYOUT_GENERAL);
+    VkCommandsBarrierFlush(Commands);
+
+    u32 NumGroupsX = (Chain->Width + VK_MIP_GEN_TILE_SIZE - 1) / VK_MIP_GEN_TILE_SIZE;
+    u32 NumGroupsY = (Chain->Height + VK_MIP_GEN_TILE_SIZE - 1) / VK_MIP_GEN_TILE_SIZE;
+
+    vk_mip_gen_params Params = {};
+    Params.NumMips = Chain->NumMips;
+    Params.NumWorkGroups = NumGroupsX * NumGroupsY;
+    Params.Width = Chain->Width;
+    Params.Height = Chain->Height;
+
+    VkCommandsBindPipeline(Commands, VK_PIPELINE_BIND_POINT_COMPUTE, Generator->Pipeline->Handle);
+    VkCommandsBindDescriptorSets(Commands, VK_PIPELINE_BIND_POINT_COMPUTE, Generator->Pipeline->Layout, 0, 1, &Chain->DescriptorSet);
+    vkCmdPushConstants(Commands->Buffer, Generator->Pipeline->Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Params), &Params);
+    vkCmdDispatch(Commands->Buffer, NumGroupsX, NumGroupsY, Chain->NumLayers);
+
+    VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, 0, 1), ReadMask, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                      OutputMask, OutputLayout);
+    VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, 1, Chain->NumMips - 1), ComputeMask, VK_IMAGE_LAYOUT_GENERAL,
+                      OutputMask, OutputLayout);
+    VkCommandsBarrierFlush(Commands);
+}
+
+inline void VkCommandsMipsGenerate(vk_commands* Commands, vk_mip_chain* Chain, barrier_mask InputMask, VkImageLayout InputLayout,
+                                   barrier_mask OutputMask, VkImageLayout OutputLayout)
+{
+    // IMPORTANT: Call outside of a render pass after the level 0 upload got flushed. InputMask and InputLayout describe
+    // level 0 (usually the output of the upload), the old contents of the other levels get discarded. Every level ends
+    // up in OutputLayout
+    Assert(!Commands->InsideRenderPass);
+    if (Chain->NumMips <= 1)
+    {
+        VkBarrierImageAdd(Commands, Chain->Image, VkMipChainGetRange(Chain, 0, 1), InputMask, InputLayout, OutputMask, OutputLayout);
+        VkCommandsBarrierFlush(Commands);
+        return;
+    }
+
+    VkGpuScopeBegin(Commands, "MipsGenerate");
+    if (Chain->UseBlit)
+    {
+        VkCommandsMipsBlit(Commands, Chain, InputMask, InputLayout, OutputMask, OutputLayout);
+    }
+    else
+    {
+        VkCommandsMipsDispatch(Commands, Chain, InputMask, InputLayout, OutputMask, OutputLayout);
+    }
+    VkGpuScopeEnd(Commands);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+//
+// NOTE: Mip Generation
+//
+
+/*
+   NOTE: Builds the mip chain of an image on the gpu after level 0 got uploaded, so assets only ship level 0.
+
+         Formats that support linear blits get a vkCmdBlitImage chain. Everything else goes through vk_mip_generator,
+         a single dispatch downsampler in the style of AMD's SPD: every workgroup reduces a 64x64 tile of level 0 down
+         to level 6 and the last workgroup to finish (found with an atomic counter) reduces the rest. The shader is
+         supplied by the app and has to match:
+
+         - layout(local_size_x = VK_MIP_GEN_GROUP_SIZE), one workgroup per VK_MIP_GEN_TILE_SIZE tile, z is the layer
+         - set 0 binding 0: sampler2DArray of level 0 with a linear clamp sampler
+         - set 0 binding 1: image2DArray[VK_MIP_GEN_MAX_MIPS - 1] for levels 1 and up, unused slots repeat the last level
+         - set 0 binding 2: buffer with one uint counter per layer, cleared to 0 before the dispatch
+         - push constants: vk_mip_gen_params
+
+         The compute path needs the format to support storage images, sRGB formats usually don't.
+*/
+
+#define VK_MIP_GEN_MAX_MIPS 14
+#define VK_MIP_GEN_TILE_SIZE 64
+#define VK_MIP_GEN_GROUP_SIZE 256
+
+struct vk_mip_gen_params
+{
+    u32 NumMips;
+    u32 NumWorkGroups;
+    u32 Width;
+    u32 Height;
+};
+
+struct vk_mip_generator
+{
+    vk_pipeline* Pipeline;
+    VkDescriptorSetLayout DescriptorLayout;
+    VkSampler Sampler;
+};
+
+// NOTE: Per image state, the views and descriptor set only exist when the format can't be blitted
+struct vk_mip_chain
+{
+    VkImage Image;
+    VkImageAspectFlags AspectMask;
+    u32 Width;
+    u32 Height;
+    u32 NumMips;
+    u32 NumLayers;
+
+    b32 UseBlit;
+
+    vk_mip_generator* Generator;
+    VkImageView SrcView;
+    VkImageView MipViews[VK_MIP_GEN_MAX_MIPS - 1];
+    VkDescriptorSet DescriptorSet;
+    VkBuffer CounterBuffer;
+};
@@ -0,0 +1,235 @@
+
+//
+// NOTE: Command Packets
+//
+
+inline vk_packet_stream VkPacketStreamCreate(linear_arena* Arena, u32 MaxPackets, u32 PushDataSize = KiloBytes(64))
+{
+    vk_packet_stream Result = {};
+    Result.MaxPackets = MaxPackets;
+    Result.Packets = PushArray(Arena, vk_packet, MaxPackets);
+    Result.SortEntries = PushArray(Arena, vk_packet_sort_entry, MaxPackets);
+    Result.PushDataSize = PushDataSize;
+    Result.PushData = PushArray(Arena, u8, PushDataSize);
+
+    return Result;
+}
+
+inline void VkPacketStreamReset(vk_packet_stream* Stream)
+{
+    Stream->NumPackets = 0;
+    Stream->PushDataUsed = 0;
+    Stream->Sorted = false;
+}
+
+inline u64 VkPacketSortKey(u32 Pass, VkPipeline Pipeline, VkDescriptorSet DescriptorSet, f32 Depth, b32 BackToFront = false)
+{
+    Assert(Pass < VK_PACKET_MAX_PASSES);
+
+    u64 PipelineBits = VkHashBytes(VK_HASH_INIT, &Pipeline, sizeof(Pipeline)) & 0x3FFF;
+    u64 DescriptorBits = VkHashBytes(VK_HASH_INIT, &DescriptorSet, sizeof(DescriptorSet)) & 0xFFFFF;
+
+    // NOTE: Positive floats sort like their bit patterns so the top 24 bits keep the order
+    f32 ClampedDepth = Max(Depth, 0.0f);
+    u32 DepthBits = 0;
+    Copy(&ClampedDepth, &DepthBits, sizeof(DepthBits));
+    DepthBits >>= 8;
+    if (BackToFront)
+    {
+        DepthBits = 0xFFFFFF - DepthBits;
+    }
+
+    u64 Result = (u64(Pass) << 58) | (PipelineBits << 44) | (DescriptorBits << 24) | u64(DepthBits);
+    return Result;
+}
+
+inline vk_packet* VkPacketPush(vk_packet_stream* Stream, u64 SortKey, vk_packet_type Type, VkPipelineBindPoint BindPoint,
+                               vk_pipeline* Pipeline, u32 NumDescriptorSets, VkDescriptorSet* DescriptorSets)
+{
+    Assert(Stream->NumPackets < Stream->MaxPackets);
+    Assert(NumDescriptorSets <= VK_PACKET_MAX_DESCRIPTOR_SETS);
+
+    u32 PacketId = Stream->NumPackets++;
+    vk_packet* Result = Stream->Packets + PacketId;
+    *Result = {};
+    Result->Type = Type;
+    Result->BindPoint = BindPoint;
+    Result->Pipeline = Pipeline->Handle;
+    Result->Layout = Pipeline->Layout;
+    Result->NumDescriptorSets = NumDescriptorSets;
+    for (u32 SetId = 0; SetId < NumDescriptorSets; ++SetId)
+    {
+        Result->DescriptorSets[SetId] = DescriptorSets[SetId];
+    }
+
+    Stream->SortEntries[PacketId].Key = SortKey;
+    Stream->SortEntries[PacketId].PacketId = PacketId;
+    Stream->Sorted = false;
+
+    return Result;
+}
+
+inline vk_packet* VkPacketPushDraw(vk_packet_stream* Stream, u64 SortKey, vk_pipeline* Pipeline, u32 NumDescriptorSets,
+                                   VkDescriptorSet* DescriptorSets, VkBuffer VertexBuffer, u32 NumVertices, u32 NumInstances = 1)
+{
+    vk_packet* Result = VkPacketPush(Stream, SortKey, VkPacketType_Draw, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline,
+                                     NumDescriptorSets, DescriptorSets);
+    Result->VertexBuffer = VertexBuffer;
+    Result->Draw.NumVertices = NumVertices;
+    Result->Draw.NumInstances = NumInstances;
+
+    return Result;
+}
+
+inline vk_packet* VkPacketPushDrawIndexed(vk_packet_stream* Stream, u64 SortKey, vk_pipeline* Pipeline, u32 NumDescriptorSets,
+                                          VkDescriptorSet* DescriptorSets, VkBuffer VertexBuffer, VkBuffer IndexBuffer,
+                                          u32 NumIndices, u32 NumInstances = 1, VkIndexType IndexType = VK_INDEX_TYPE_UINT32)
+{
+    vk_packet* Result = VkPacketPush(Stream, SortKey, VkPacketType_DrawIndexed, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline,
+                                     NumDescriptorSets, DescriptorSets);
+    Result->VertexBuffer = VertexBuffer;
+    Result->IndexBuffer = IndexBuffer;
+    Result->IndexType = IndexType;
+    Result->DrawIndexed.NumIndices = NumIndices;
+    Result->DrawIndexed.NumInstances = NumInstances;
+
+    return Result;
+}
+
+inline vk_packet* VkPacketPushDispatch(vk_packet_stream* Stream, u64 SortKey, vk_pipeline* Pipeline, u32 NumDescriptorSets,
+                                       VkDescriptorSet* DescriptorSets, u32 DispatchX, u32 DispatchY, u32 DispatchZ)
+{
+    vk_packet* Result = VkPacketPush(Stream, SortKey, VkPacketType_Dispatch, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline,
+                                     NumDescriptorSets, DescriptorSets);
+    Result->Dispatch.X = DispatchX;
+    Result->Dispatch.Y = DispatchY;
+    Result->Dispatch.Z = DispatchZ;
+
+    return Result;
+}
+
+inline void VkPacketPushConstants(vk_packet_stream* Stream, vk_packet* Packet, VkShaderStageFlags Stages, void* Data, u32 Size)
+{
+    Assert(Stream->PushDataUsed + Size <= Stream->PushDataSize);
+
+    Packet->PushConstantStages = Stages;
+    Packet->PushConstantOffset = Stream->PushDataUsed;
+    Packet->PushConstantSize = Size;
+    Copy(Data, Stream->PushData + Stream->PushDataUsed, Size);
+    Stream->PushDataUsed += (Size + 3) & ~3u;
+}
+
+inline void VkPacketStreamSort(vk_packet_stream* Stream, linear_arena* TempArena)
+{
+    // NOTE: LSD radix sort on 8 bit digits. All histograms get built in one pass over the keys and digits where every key
+    // lands in the same bucket get skipped, which is common for the pass bits
+    temp_mem TempMem = BeginTempMem(TempArena);
+
+    u32 NumEntries = Stream->NumPackets;
+    vk_packet_sort_entry* Src = Stream->SortEntries;
+    vk_packet_sort_entry* Dst = PushArray(TempArena, vk_packet_sort_entry, Max(NumEntries, 1u));
+
+    u32 Histograms[8][256] = {};
+    for (u32 EntryId = 0; EntryId < NumEntries; ++EntryId)
+    {
+        u64 Key = Src[EntryId].Key;
+        for (u32 DigitId = 0; DigitId < 8; ++DigitId)
+        {
+            Histograms[DigitId][(Key >> (DigitId * 8)) & 0xFF] += 1;
+        }
+    }
+
+    for (u32 DigitId = 0; DigitId < 8; ++DigitId)
+    {
+        u32* Histogram = Histograms[DigitId];
+        u32 Shift = DigitId * 8;
+        if (NumEntries == 0 || Histogram[(Src[0].Key >> Shift) & 0xFF] == NumEntries)
+        {
+            continue;
+        }
+
+        // NOTE: Histogram to exclusive prefix sum
+        u32 Offset = 0;
+        for (u32 BucketId = 0; BucketId < 256; ++BucketId)
+        {
+            u32 Count = Histogram[BucketId];
+            Histogram[BucketId] = Offset;
+            Offset += Count;
+        }
+
+        for (u32 EntryId = 0; EntryId < NumEntries; ++EntryId)
+        {
+            u32 BucketId = (Src[EntryId].Key >> Shift) & 0xFF;
+            Dst[Histogram[BucketId]++] = Src[EntryId];
+        }
+
+        vk_packet_sort_entry* Temp = Src;
+        Src = Dst;
+        Dst = Temp;
+    }
+
+    if (Src != Stream->SortEntries)
+    {
+        Copy(Src, Stream->SortEntries, sizeof(vk_packet_sort_entry) * NumEntries);
+    }
+
+    Stream->Sorted = true;
+    EndTempMem(TempMem);
+}
+
+inline void VkPacketStreamReplay(vk_packet_stream* Stream, vk_commands* Commands)
+{
+    // NOTE: Replays in sort order if the stream was sorted, push order otherwise. Graphics packets need the pass's
+    // render pass to be active and a viewport/scissor set
+    for (u32 EntryId = 0; EntryId < Stream->NumPackets; ++EntryId)
+    {
+        u32 PacketId = Stream->Sorted ? Stream->SortEntries[EntryId].PacketId : EntryId;
+        vk_packet* Packet = Stream->Packets + PacketId;
+
+        VkCommandsBindPipeline(Commands, Packet->BindPoint, Packet->Pipeline);
+        if (Packet->NumDescriptorSets > 0)
+        {
+            VkCommandsBindDescriptorSets(Commands, Packet->BindPoint, Packet->Layout, 0, Packet->NumDescriptorSets,
+                                         Packet->DescriptorSets);
+        }
+        if (Packet->VertexBuffer != VK_NULL_HANDLE)
+        {
+            VkCommandsBindVertexBuffers(Commands, 0, 1, &Packet->VertexBuffer, &Packet->VertexBufferOffset);
+        }
+        if (Packet->IndexBuffer != VK_NULL_HANDLE)
+        {
+            VkCommandsBindIndexBuffer(Commands, Packet->IndexBuffer, Packet->IndexBufferOffset, Packet->IndexType);
+        }
+        if (Packet->PushConstantSize > 0)
+        {
+            vkCmdPushConstants(Commands->Buffer, Packet->Layout, Packet->PushConstantStages, 0, Packet->PushConstantSize,
+                               Stream->PushData + Packet->PushConstantOffset);
+        }
+
+        switch (Packet->Type)
+        {
+            case VkPacketType_Draw:
+            {
+                vkCmdDraw(Commands->Buffer, Packet->Draw.NumVertices, Packet->Draw.NumInstances, Packet->Draw.FirstVertex,
+                          Packet->Draw.FirstInstance);
+            } break;
+
+            case VkPacketType_DrawIndexed:
+            {
+                vkCmdDrawIndexed(Commands->Buffer, Packet->DrawIndexed.NumIndices, Packet->DrawIndexed.NumInstances,
+                                 Packet->DrawIndexed.FirstIndex, Packet->DrawIndexed.VertexOffset,
+                                 Packet->DrawIndexed.FirstInstance);
+            } break;
+
+            case VkPacketType_Dispatch:
+            {
+                vkCmdDispatch(Commands->Buffer, Packet->Dispatch.X, Packet->Dispatch.Y, Packet->Dispatch.Z);
+            } break;
+
+            default:
+            {
+                InvalidCodePath;
+            } break;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+//
+// NOTE: Command Packets
+//
+
+/*
+   NOTE: Draws and dispatches get pushed into a packet stream with a 64 bit sort key instead of being recorded right
+         away. Sorting the stream groups packets by pass, pipeline and descriptor set before replaying them through the
+         filtered binds in vk_commands, so state changes don't depend on the order game code issued work in.
+
+         Key layout, most significant first:
+
+         - 6 bits pass, orders sub passes or layers inside the stream (opaque before transparent)
+         - 14 bits pipeline hash
+         - 20 bits descriptor set hash
+         - 24 bits depth, front to back by default
+
+         Hash collisions only cost grouping, replay always binds the real handles stored in the packet.
+*/
+
+#define VK_PACKET_MAX_DESCRIPTOR_SETS 4
+#define VK_PACKET_MAX_PASSES 64
+
+enum vk_packet_type
+{
+    VkPacketType_None,
+
+    VkPacketType_Draw,
+    VkPacketType_DrawIndexed,
+    VkPacketType_Dispatch,
+};
+
+struct vk_packet
+{
+    vk_packet_type Type;
+    VkPipelineBindPoint BindPoint;
+    VkPipeline Pipeline;
+    VkPipelineLayout Layout;
+
+    u32 NumDescriptorSets;
+    VkDescriptorSet DescriptorSets[VK_PACKET_MAX_DESCRIPTOR_SETS];
+
+    VkBuffer VertexBuffer;
+    VkDeviceSize VertexBufferOffset;
+    VkBuffer IndexBuffer;
+    VkDeviceSize IndexBufferOffset;
+    VkIndexType IndexType;
+
+    // NOTE: Offset into the stream's push constant data
+    VkShaderStageFlags PushConstantStages;
+    u32 PushConstantOffset;
+    u32 PushConstantSize;
+
+    union
+    {
+        struct
+        {
+            u32 NumVertices;
+            u32 NumInstances;
+            u32 FirstVertex;
+            u32 FirstInstance;
+        } Draw;
+
+        struct
+        {
+            u32 NumIndices;
+            u32 NumInstances;
+            u32 FirstIndex;
+            i32 VertexOffset;
+            u32 FirstInstance;
+        } DrawIndexed;
+
+        struct
+        {
+            u32 X;
+            u32 Y;
+            u32 Z;
+        } Dispatch;
+    };
+};
+
+struct vk_packet_sort_entry
+{
+    u64 Key;
+    u32 PacketId;
+};
+
+struct vk_packet_stream
+{
+    u32 MaxPackets;
+    u32 NumPackets;
+    vk_packet* Packets;
+    vk_packet_sort_entry* SortEntries;
+
+    u32 PushDataSize;
+    u32 PushDataUsed;
+    u8* PushData;
+
+    b32 Sorted;
+};
@@ -10,9 +10,965 @@ inline vk_pipeline_manager VkPipelineManagerCreate(linear_arena* Arena)
     Result.MaxNumPipelines = 100; // TODO: This is hardcoded for now
     Result.PipelineArray = PushArray(&Result.Arena, vk_pipeline_entry, Result.MaxNumPipelines);
 
+    Result.MaxNumRenderPassDescs = 100;
+    Result.RenderPassDescs = PushArray(&Result.Arena, vk_render_pass_desc, Result.MaxNumRenderPassDescs);
+
+    Result.MaxNumDescriptorLayoutDescs = 100;
+    Result.DescriptorLayoutDescs = PushArray(&Result.Arena, vk_descriptor_layout_desc, Result.MaxNumDescriptorLayoutDescs);
+
+    Result.WarmPipelineArray = PushArray(&Result.Arena, vk_pipeline_warm_entry, Result.MaxNumPipelines);
+    
+    return Result;
+}
+
+//
+// NOTE: Shader Compilation
+//
+
+inline b32 VkShaderIsSpirv(char* FileName)
+{
+    char* Extension = strrchr(FileName, '.');
+    b32 Result = Extension && strcmp(Extension, ".spv") == 0;
+    return Result;
+}
+
+inline u8* VkShaderFileRead(linear_arena* Arena, char* FileName, u32* OutSize, FILETIME* OutModifiedTime)
+{
+    // NOTE: Returns 0 if the file can't be read, missing includes or cache entries aren't errors
+    u8* Result = 0;
+    
+    HANDLE File = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (File != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER FileSize = {};
+        if (GetFileSizeEx(File, &FileSize) && FileSize.HighPart == 0)
+        {
+            DWORD BytesRead = 0;
+            Result = PushArray(Arena, u8, FileSize.LowPart);
+            if (ReadFile(File, Result, FileSize.LowPart, &BytesRead, 0) && BytesRead == FileSize.LowPart)
+            {
+                *OutSize = FileSize.LowPart;
+                if (OutModifiedTime)
+                {
+                    GetFileTime(File, 0, 0, OutModifiedTime);
+                }
+            }
+            else
+            {
+                Result = 0;
+            }
+        }
+        
+        CloseHandle(File);
+    }
+
+    return Result;
+}
+
+inline void VkShaderIncludePath(char* OutPath, char* ParentFileName, char* Name, u32 NameLength)
+{
+    // NOTE: Includes are relative to the directory of the file that includes them
+    u32 DirLength = 0;
+    for (u32 CharId = 0; ParentFileName[CharId]; ++CharId)
+    {
+        if (ParentFileName[CharId] == '\\' || ParentFileName[CharId] == '/')
+        {
+            DirLength = CharId + 1;
+        }
+    }
+
+    snprintf(OutPath, VK_MAX_SHADER_PATH, "%.*s%.*s", DirLength, ParentFileName, NameLength, Name);
+}
+
+inline void VkShaderIncludesParse(char* FileName, u8* Source, u32 SourceSize, vk_shader_include* Includes, u32* NumIncludes)
+{
+    // NOTE: We don't evaluate the preprocessor, so includes behind an #if still count as dependencies
+    char* At = (char*)Source;
+    char* End = At + SourceSize;
+    while (At < End)
+    {
+        while (At < End && (*At == ' ' || *At == '\t'))
+        {
+            ++At;
+        }
+
+        if ((End - At) > 8 && strncmp(At, "#include", 8) == 0)
+        {
+            At += 8;
+            while (At < End && (*At == ' ' || *At == '\t'))
+            {
+                ++At;
+            }
+
+            if (At < End && (*At == '"' || *At == '<'))
+            {
+                char Terminator = *At == '"' ? '"' : '>';
+                char* Name = ++At;
+                while (At < End && *At != Terminator && *At != '\n')
+                {
+                    ++At;
+                }
+
+                char Path[VK_MAX_SHADER_PATH];
+                VkShaderIncludePath(Path, FileName, Name, u32(At - Name));
+
+                b32 Found = false;
+                for (u32 IncludeId = 0; IncludeId < *NumIncludes; ++IncludeId)
+                {
+                    Found = Found || strcmp(Includes[IncludeId].FileName, Path) == 0;
+                }
+
+                if (!Found)
+                {
+                    Assert(*NumIncludes < VK_MAX_SHADER_INCLUDES);
+                    vk_shader_include* Include = Includes + (*NumIncludes)++;
+                    *Include = {};
+                    strcpy(Include->FileName, Path);
+                }
+            }
+        }
+
+        // NOTE: Move to the next line
+        while (At < End && *At != '\n')
+        {
+            ++At;
+        }
+        At += 1;
+    }
+}
+
+inline u64 VkShaderIncludesGather(linear_arena* TempArena, vk_shader_ref* ShaderRef, u8* Source, u32 SourceSize)
+{
+    // NOTE: Walks the include tree of a source shader, returns the hash of all included files and stores them in the ref
+    u64 Result = VK_HASH_INIT;
+    
+    u32 NumIncludes = 0;
+    vk_shader_include* Includes = PushArray(TempArena, vk_shader_include, VK_MAX_SHADER_INCLUDES);
+    VkShaderIncludesParse(ShaderRef->FileName, Source, SourceSize, Includes, &NumIncludes);
+    for (u32 IncludeId = 0; IncludeId < NumIncludes; ++IncludeId)
+    {
+        // NOTE: The list grows as we parse includes of includes
+        vk_shader_include* Include = Includes + IncludeId;
+        u32 IncludeSize = 0;
+        u8* IncludeData = VkShaderFileRead(TempArena, Include->FileName, &IncludeSize, &Include->ModifiedTime);
+        if (IncludeData)
+        {
+            Result = VkHashBytes(Result, Include->FileName, strlen(Include->FileName));
+            Result = VkHashBytes(Result, IncludeData, IncludeSize);
+            VkShaderIncludesParse(Include->FileName, IncludeData, IncludeSize, Includes, &NumIncludes);
+        }
+    }
+
+    if (ShaderRef->Includes)
+    {
+        ShaderRef->NumIncludes = NumIncludes;
+        Copy(Includes, ShaderRef->Includes, sizeof(vk_shader_include)*NumIncludes);
+    }
+
+    return Result;
+}
+
+#if VK_SHADER_COMPILER
+
+internal shaderc_include_result* VkShaderIncludeResolve(void* UserData, const char* RequestedSource, int Type,
+                                                         const char* RequestingSource, size_t IncludeDepth)
+{
+    linear_arena* Arena = (linear_arena*)UserData;
+    shaderc_include_result* Result = PushStruct(Arena, shaderc_include_result);
+    *Result = {};
+
+    char* Path = PushArray(Arena, char, VK_MAX_SHADER_PATH);
+    VkShaderIncludePath(Path, (char*)RequestingSource, (char*)RequestedSource, u32(strlen(RequestedSource)));
+
+    u32 Size = 0;
+    u8* Data = VkShaderFileRead(Arena, Path, &Size, 0);
+    if (Data)
+    {
+        Result->source_name = Path;
+        Result->source_name_length = strlen(Path);
+        Result->content = (char*)Data;
+        Result->content_length = Size;
+    }
+    else
+    {
+        // NOTE: An empty source name tells shaderc the include failed, content is the error message
+        Result->content = "failed to open include file";
+        Result->content_length = strlen(Result->content);
+    }
+
+    return Result;
+}
+
+internal void VkShaderIncludeRelease(void* UserData, shaderc_include_result* IncludeResult)
+{
+    // NOTE: Everything lives in the temp arena so there is nothing to free
+}
+
+inline shaderc_shader_kind VkShaderGetKind(VkShaderStageFlagBits Stage)
+{
+    shaderc_shader_kind Result = shaderc_glsl_infer_from_source;
+    switch (Stage)
+    {
+        case VK_SHADER_STAGE_VERTEX_BIT: Result = shaderc_vertex_shader; break;
+        case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT: Result = shaderc_tess_control_shader; break;
+        case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT: Result = shaderc_tess_evaluation_shader; break;
+        case VK_SHADER_STAGE_GEOMETRY_BIT: Result = shaderc_geometry_shader; break;
+        case VK_SHADER_STAGE_FRAGMENT_BIT: Result = shaderc_fragment_shader; break;
+        case VK_SHADER_STAGE_COMPUTE_BIT: Result = shaderc_compute_shader; break;
+        default: InvalidCodePath;
+    }
+
+    return Result;
+}
+
+inline u32* VkShaderCompile(linear_arena* TempArena, vk_shader_ref* ShaderRef, u8* Source, u32 SourceSize, u32* OutCodeSize)
+{
+    u32* Result = 0;
+    
+    shaderc_compiler_t Compiler = shaderc_compiler_initialize();
+    shaderc_compile_options_t Options = shaderc_compile_options_initialize();
+    
+    char* Extension = strrchr(ShaderRef->FileName, '.');
+    b32 IsHlsl = Extension && strcmp(Extension, ".hlsl") == 0;
+    shaderc_compile_options_set_source_language(Options, IsHlsl ? shaderc_source_language_hlsl : shaderc_source_language_glsl);
+    shaderc_compile_options_set_target_env(Options, shaderc_target_env_vulkan, 0);
+    shaderc_compile_options_set_include_callbacks(Options, VkShaderIncludeResolve, VkShaderIncludeRelease, TempArena);
+
+    // NOTE: Defines are formatted as "NAME=VALUE;NAME2;NAME3=VALUE"
+    for (char* At = ShaderRef->Defines; At && *At; )
+    {
+        char* Name = At;
+        while (*At && *At != ';' && *At != '=')
+        {
+            ++At;
+        }
+        mm NameLength = At - Name;
+
+        char* Value = 0;
+        mm ValueLength = 0;
+        if (*At == '=')
+        {
+            Value = ++At;
+            while (*At && *At != ';')
+            {
+                ++At;
+            }
+            ValueLength = At - Value;
+        }
+
+        if (NameLength > 0)
+        {
+            shaderc_compile_options_add_macro_definition(Options, Name, NameLength, Value, ValueLength);
+        }
+
+        if (*At == ';')
+        {
+            ++At;
+        }
+    }
+    
+    shaderc_compilation_result_t CompileResult = shaderc_compile_into_spv(Compiler, (char*)Source, SourceSize, VkShaderGetKind(ShaderRef->Stage),
+                                                                          ShaderRef->FileName, ShaderRef->MainName, Options);
+    if (shaderc_result_get_compilation_status(CompileResult) == shaderc_compilation_status_success)
+    {
+        *OutCodeSize = u32(shaderc_result_get_length(CompileResult));
+        Result = (u32*)PushSize(TempArena, *OutCodeSize);
+        Copy((void*)shaderc_result_get_bytes(CompileResult), Result, *OutCodeSize);
+    }
+    else
+    {
+        // NOTE: Errors in a shader being edited are expected, callers keep what they had and try again later
+        OutputDebugStringA(shaderc_result_get_error_message(CompileResult));
+        *OutCodeSize = 0;
+    }
+    
+    shaderc_result_release(CompileResult);
+    shaderc_compile_options_release(Options);
+    shaderc_compiler_release(Compiler);
+
+    return Result;
+}
+
+#endif
+
+inline u32* VkShaderCompileCached(linear_arena* TempArena, vk_shader_ref* ShaderRef, u8* Source, u32 SourceSize, u32* OutCodeSize)
+{
+    // NOTE: Cache key covers everything that changes the output
+    u64 Hash = VkShaderIncludesGather(TempArena, ShaderRef, Source, SourceSize);
+    Hash = VkHashBytes(Hash, Source, SourceSize);
+    Hash = VkHashBytes(Hash, ShaderRef->MainName, strlen(ShaderRef->MainName));
+    Hash = VkHashBytes(Hash, &ShaderRef->Stage, sizeof(ShaderRef->Stage));
+    if (ShaderRef->Defines)
+    {
+        Hash = VkHashBytes(Hash, ShaderRef->Defines, strlen(ShaderRef->Defines));
+    }
+
+    char CachePath[VK_MAX_SHADER_PATH];
+    snprintf(CachePath, sizeof(CachePath), "%s%016llx.spv", VK_SHADER_CACHE_DIR, Hash);
+    u32* Result = (u32*)VkShaderFileRead(TempArena, CachePath, OutCodeSize, 0);
+    if (!Result)
+    {
+#if VK_SHADER_COMPILER
+        Result = VkShaderCompile(TempArena, ShaderRef, Source, SourceSize, OutCodeSize);
+        if (Result)
+        {
+            // NOTE: Write to a temp file and move it over the entry, so a crash or a full disk never leaves a truncated
+            // entry behind and threads writing the same entry don't interleave. Failing to write the cache isn't fatal
+            char TempPath[VK_MAX_SHADER_PATH];
+            snprintf(TempPath, sizeof(TempPath), "%s%016llx.%lu.tmp", VK_SHADER_CACHE_DIR, Hash, GetCurrentThreadId());
+
+            CreateDirectoryA(VK_SHADER_CACHE_DIR, 0);
+            HANDLE File = CreateFileA(TempPath, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+            if (File != INVALID_HANDLE_VALUE)
+            {
+                DWORD BytesWritten = 0;
+                b32 Written = WriteFile(File, Result, *OutCodeSize, &BytesWritten, 0) && BytesWritten == *OutCodeSize;
+                CloseHandle(File);
+
+                if (!Written || !MoveFileExA(TempPath, CachePath, MOVEFILE_REPLACE_EXISTING))
+                {
+                    DeleteFileA(TempPath);
+                }
+            }
+        }
+#else
+        // NOTE: Without a compiler, source shaders have to already be in the cache
+        InvalidCodePath;
+#endif
+    }
+
+    return Result;
+}
+
+//
+// NOTE: Manifest Serialization
+//
+
+inline vk_manifest_writer VkManifestWriterCreate(u8* Buffer, mm Size)
+{
+    vk_manifest_writer Result = {};
+    Result.Start = Buffer;
+    Result.At = Buffer;
+    Result.End = Buffer + Size;
+
+    return Result;
+}
+
+inline u32 VkManifestWriterGetSize(vk_manifest_writer* Writer)
+{
+    u32 Result = u32(Writer->At - Writer->Start);
+    return Result;
+}
+
+inline void VkManifestWriteSize(vk_manifest_writer* Writer, void* Data, mm Size)
+{
+    Assert(Writer->At + Size <= Writer->End);
+    Copy(Data, Writer->At, Size);
+    Writer->At += Size;
+}
+
+#define VkManifestWrite(Writer, Value) VkManifestWriteSize(Writer, (void*)&(Value), sizeof(Value))
+#define VkManifestWriteArray(Writer, Array, Count) VkManifestWriteSize(Writer, (void*)(Array), sizeof(*(Array))*(Count))
+
+inline void VkManifestWriteString(vk_manifest_writer* Writer, char* String)
+{
+    // NOTE: We store the null terminator so that strings can be used straight out of the file
+    u32 Length = u32(strlen(String)) + 1;
+    VkManifestWrite(Writer, Length);
+    VkManifestWriteSize(Writer, String, Length);
+}
+
+inline vk_manifest_reader VkManifestReaderCreate(u8* Data, mm Size)
+{
+    vk_manifest_reader Result = {};
+    Result.At = Data;
+    Result.End = Data + Size;
+
+    return Result;
+}
+
+inline void* VkManifestReadSize(vk_manifest_reader* Reader, mm Size)
+{
+    Assert(Reader->At + Size <= Reader->End);
+    void* Result = Reader->At;
+    Reader->At += Size;
+
+    return Result;
+}
+
+#define VkManifestRead(Reader, Type) (*(Type*)VkManifestReadSize(Reader, sizeof(Type)))
+#define VkManifestReadArray(Reader, Type, Count) ((Type*)VkManifestReadSize(Reader, sizeof(Type)*(Count)))
+
+inline char* VkManifestReadString(vk_manifest_reader* Reader)
+{
+    u32 Length = VkManifestRead(Reader, u32);
+    char* Result = VkManifestReadArray(Reader, char, Length);
+    return Result;
+}
+
+inline VkRenderPassMultiviewCreateInfo* VkRenderPassGetMultiview(VkRenderPassCreateInfo* CreateInfo)
+{
+    VkRenderPassMultiviewCreateInfo* Result = 0;
+    for (VkBaseInStructure* Curr = (VkBaseInStructure*)CreateInfo->pNext; Curr; Curr = (VkBaseInStructure*)Curr->pNext)
+    {
+        if (Curr->sType == VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO)
+        {
+            Result = (VkRenderPassMultiviewCreateInfo*)Curr;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline void VkManifestWriteRenderPass(vk_manifest_writer* Writer, VkRenderPassCreateInfo* CreateInfo)
+{
+    // NOTE: We only store what matters for render pass compatibility, load/store ops and layouts are ignored
+    VkManifestWrite(Writer, CreateInfo->flags);
+    VkManifestWrite(Writer, CreateInfo->attachmentCount);
+    for (u32 AttachmentId = 0; AttachmentId < CreateInfo->attachmentCount; ++AttachmentId)
+    {
+        const VkAttachmentDescription* Attachment = CreateInfo->pAttachments + AttachmentId;
+        VkManifestWrite(Writer, Attachment->format);
+        VkManifestWrite(Writer, Attachment->samples);
+    }
+
+    VkManifestWrite(Writer, CreateInfo->subpassCount);
+    for (u32 SubPassId = 0; SubPassId < CreateInfo->subpassCount; ++SubPassId)
+    {
+        const VkSubpassDescription* SubPass = CreateInfo->pSubpasses + SubPassId;
+        VkManifestWrite(Writer, SubPass->flags);
+        VkManifestWrite(Writer, SubPass->pipelineBindPoint);
+
+        VkManifestWrite(Writer, SubPass->inputAttachmentCount);
+        for (u32 RefId = 0; RefId < SubPass->inputAttachmentCount; ++RefId)
+        {
+            VkManifestWrite(Writer, SubPass->pInputAttachments[RefId].attachment);
+        }
+        
+        VkManifestWrite(Writer, SubPass->colorAttachmentCount);
+        for (u32 RefId = 0; RefId < SubPass->colorAttachmentCount; ++RefId)
+        {
+            VkManifestWrite(Writer, SubPass->pColorAttachments[RefId].attachment);
+        }
+
+        b32 HasResolve = SubPass->pResolveAttachments != 0;
+        VkManifestWrite(Writer, HasResolve);
+        for (u32 RefId = 0; HasResolve && RefId < SubPass->colorAttachmentCount; ++RefId)
+        {
+            VkManifestWrite(Writer, SubPass->pResolveAttachments[RefId].attachment);
+        }
+
+        b32 HasDepth = SubPass->pDepthStencilAttachment != 0;
+        VkManifestWrite(Writer, HasDepth);
+        if (HasDepth)
+        {
+            VkManifestWrite(Writer, SubPass->pDepthStencilAttachment->attachment);
+        }
+
+        VkManifestWrite(Writer, SubPass->preserveAttachmentCount);
+        VkManifestWriteArray(Writer, SubPass->pPreserveAttachments, SubPass->preserveAttachmentCount);
+    }
+
+    VkManifestWrite(Writer, CreateInfo->dependencyCount);
+    VkManifestWriteArray(Writer, CreateInfo->pDependencies, CreateInfo->dependencyCount);
+
+    // NOTE: View masks are part of render pass compatibility
+    VkRenderPassMultiviewCreateInfo* Multiview = VkRenderPassGetMultiview(CreateInfo);
+    b32 HasMultiview = Multiview != 0;
+    VkManifestWrite(Writer, HasMultiview);
+    if (HasMultiview)
+    {
+        VkManifestWrite(Writer, Multiview->subpassCount);
+        VkManifestWriteArray(Writer, Multiview->pViewMasks, Multiview->subpassCount);
+        
+        b32 HasViewOffsets = Multiview->pViewOffsets != 0;
+        VkManifestWrite(Writer, HasViewOffsets);
+        VkManifestWrite(Writer, Multiview->dependencyCount);
+        if (HasViewOffsets)
+        {
+            VkManifestWriteArray(Writer, Multiview->pViewOffsets, Multiview->dependencyCount);
+        }
+        
+        VkManifestWrite(Writer, Multiview->correlationMaskCount);
+        VkManifestWriteArray(Writer, Multiview->pCorrelationMasks, Multiview->correlationMaskCount);
+    }
+}
+
+inline VkAttachmentReference* VkManifestReadAttachmentRefs(linear_arena* Arena, vk_manifest_reader* Reader, u32 NumRefs)
+{
+    VkAttachmentReference* Result = PushArray(Arena, VkAttachmentReference, NumRefs);
+    for (u32 RefId = 0; RefId < NumRefs; ++RefId)
+    {
+        Result[RefId].attachment = VkManifestRead(Reader, u32);
+        Result[RefId].layout = VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    return Result;
+}
+
+inline VkRenderPass VkManifestReadRenderPass(VkDevice Device, linear_arena* Arena, vk_manifest_reader* Reader)
+{
+    VkRenderPass Result = {};
+    temp_mem TempMem = BeginTempMem(Arena);
+    
+    VkRenderPassCreateInfo CreateInfo = {};
+    CreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    CreateInfo.flags = VkManifestRead(Reader, VkRenderPassCreateFlags);
+
+    // NOTE: Rebuild a compatible render pass, we don't care about the contents so all ops are don't care
+    CreateInfo.attachmentCount = VkManifestRead(Reader, u32);
+    VkAttachmentDescription* Attachments = PushArray(Arena, VkAttachmentDescription, CreateInfo.attachmentCount);
+    for (u32 AttachmentId = 0; AttachmentId < CreateInfo.attachmentCount; ++AttachmentId)
+    {
+        VkAttachmentDescription* Attachment = Attachments + AttachmentId;
+        *Attachment = {};
+        Attachment->format = VkManifestRead(Reader, VkFormat);
+        Attachment->samples = VkManifestRead(Reader, VkSampleCountFlagBits);
+        Attachment->loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        Attachment->storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        Attachment->stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        Attachment->stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        Attachment->initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        Attachment->finalLayout = VK_IMAGE_LAYOUT_GENERAL;
+    }
+    CreateInfo.pAttachments = Attachments;
+
+    CreateInfo.subpassCount = VkManifestRead(Reader, u32);
+    VkSubpassDescription* SubPasses = PushArray(Arena, VkSubpassDescription, CreateInfo.subpassCount);
+    for (u32 SubPassId = 0; SubPassId < CreateInfo.subpassCount; ++SubPassId)
+    {
+        VkSubpassDescription* SubPass = SubPasses + SubPassId;
+        *SubPass = {};
+        SubPass->flags = VkManifestRead(Reader, VkSubpassDescriptionFlags);
+        SubPass->pipelineBindPoint = VkManifestRead(Reader, VkPipelineBindPoint);
+
+        SubPass->inputAttachmentCount = VkManifestRead(Reader, u32);
+        SubPass->pInputAttachments = VkManifestReadAttachmentRefs(Arena, Reader, SubPass->inputAttachmentCount);
+
+        SubPass->colorAttachmentCount = VkManifestRead(Reader, u32);
+        SubPass->pColorAttachments = VkManifestReadAttachmentRefs(Arena, Reader, SubPass->colorAttachmentCount);
+
+        if (VkManifestRead(Reader, b32))
+        {
+            SubPass->pResolveAttachments = VkManifestReadAttachmentRefs(Arena, Reader, SubPass->colorAttachmentCount);
+        }
+
+        if (VkManifestRead(Reader, b32))
+        {
+            SubPass->pDepthStencilAttachment = VkManifestReadAttachmentRefs(Arena, Reader, 1);
+        }
+
+        SubPass->preserveAttachmentCount = VkManifestRead(Reader, u32);
+        SubPass->pPreserveAttachments = VkManifestReadArray(Reader, u32, SubPass->preserveAttachmentCount);
+    }
+    CreateInfo.pSubpasses = SubPasses;
+
+    CreateInfo.dependencyCount = VkManifestRead(Reader, u32);
+    CreateInfo.pDependencies = VkManifestReadArray(Reader, VkSubpassDependency, CreateInfo.dependencyCount);
+
+    VkRenderPassMultiviewCreateInfo Multiview = {};
+    if (VkManifestRead(Reader, b32))
+    {
+        Multiview.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO;
+        Multiview.subpassCount = VkManifestRead(Reader, u32);
+        Multiview.pViewMasks = VkManifestReadArray(Reader, u32, Multiview.subpassCount);
+
+        b32 HasViewOffsets = VkManifestRead(Reader, b32);
+        Multiview.dependencyCount = VkManifestRead(Reader, u32);
+        if (HasViewOffsets)
+        {
+            Multiview.pViewOffsets = VkManifestReadArray(Reader, i32, Multiview.dependencyCount);
+        }
+        
+        Multiview.correlationMaskCount = VkManifestRead(Reader, u32);
+        Multiview.pCorrelationMasks = VkManifestReadArray(Reader, u32, Multiview.correlationMaskCount);
+        CreateInfo.pNext = &Multiview;
+    }
+    
+    VkCheckResult(vkCreateRenderPass(Device, &CreateInfo, 0, &Result));
+
+    EndTempMem(TempMem);
+
+    return Result;
+}
+
+inline void VkManifestWriteDescriptorLayout(vk_manifest_writer* Writer, VkDescriptorSetLayoutCreateInfo* CreateInfo)
+{
+    VkManifestWrite(Writer, CreateInfo->flags);
+    VkManifestWrite(Writer, CreateInfo->bindingCount);
+    for (u32 BindingId = 0; BindingId < CreateInfo->bindingCount; ++BindingId)
+    {
+        const VkDescriptorSetLayoutBinding* Binding = CreateInfo->pBindings + BindingId;
+        
+        // TODO: Immutable samplers are handles, we would need to store sampler descriptions to support them
+        Assert(!Binding->pImmutableSamplers);
+        VkManifestWrite(Writer, Binding->binding);
+        VkManifestWrite(Writer, Binding->descriptorType);
+        VkManifestWrite(Writer, Binding->descriptorCount);
+        VkManifestWrite(Writer, Binding->stageFlags);
+    }
+}
+
+inline VkDescriptorSetLayout VkManifestReadDescriptorLayout(VkDevice Device, linear_arena* Arena, vk_manifest_reader* Reader)
+{
+    VkDescriptorSetLayout Result = {};
+    temp_mem TempMem = BeginTempMem(Arena);
+
+    VkDescriptorSetLayoutCreateInfo CreateInfo = {};
+    CreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    CreateInfo.flags = VkManifestRead(Reader, VkDescriptorSetLayoutCreateFlags);
+    CreateInfo.bindingCount = VkManifestRead(Reader, u32);
+
+    VkDescriptorSetLayoutBinding* Bindings = PushArray(Arena, VkDescriptorSetLayoutBinding, CreateInfo.bindingCount);
+    for (u32 BindingId = 0; BindingId < CreateInfo.bindingCount; ++BindingId)
+    {
+        VkDescriptorSetLayoutBinding* Binding = Bindings + BindingId;
+        *Binding = {};
+        Binding->binding = VkManifestRead(Reader, u32);
+        Binding->descriptorType = VkManifestRead(Reader, VkDescriptorType);
+        Binding->descriptorCount = VkManifestRead(Reader, u32);
+        Binding->stageFlags = VkManifestRead(Reader, VkShaderStageFlags);
+    }
+    CreateInfo.pBindings = Bindings;
+    VkCheckResult(vkCreateDescriptorSetLayout(Device, &CreateInfo, 0, &Result));
+
+    EndTempMem(TempMem);
+
+    return Result;
+}
+
+inline vk_render_pass_desc* VkPipelineRenderPassDescGet(vk_pipeline_manager* Manager, VkRenderPass Handle)
+{
+    vk_render_pass_desc* Result = 0;
+    for (u32 DescId = 0; DescId < Manager->NumRenderPassDescs; ++DescId)
+    {
+        if (Manager->RenderPassDescs[DescId].Handle == Handle)
+        {
+            Result = Manager->RenderPassDescs + DescId;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline vk_render_pass_desc* VkPipelineRenderPassDescFind(vk_pipeline_manager* Manager, u64 Hash)
+{
+    vk_render_pass_desc* Result = 0;
+    for (u32 DescId = 0; DescId < Manager->NumRenderPassDescs; ++DescId)
+    {
+        if (Manager->RenderPassDescs[DescId].Hash == Hash)
+        {
+            Result = Manager->RenderPassDescs + DescId;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline vk_descriptor_layout_desc* VkPipelineDescriptorLayoutDescGet(vk_pipeline_manager* Manager, VkDescriptorSetLayout Handle)
+{
+    vk_descriptor_layout_desc* Result = 0;
+    for (u32 DescId = 0; DescId < Manager->NumDescriptorLayoutDescs; ++DescId)
+    {
+        if (Manager->DescriptorLayoutDescs[DescId].Handle == Handle)
+        {
+            Result = Manager->DescriptorLayoutDescs + DescId;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline vk_descriptor_layout_desc* VkPipelineDescriptorLayoutDescFind(vk_pipeline_manager* Manager, u64 Hash)
+{
+    vk_descriptor_layout_desc* Result = 0;
+    for (u32 DescId = 0; DescId < Manager->NumDescriptorLayoutDescs; ++DescId)
+    {
+        if (Manager->DescriptorLayoutDescs[DescId].Hash == Hash)
+        {
+            Result = Manager->DescriptorLayoutDescs + DescId;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline void VkPipelineRenderPassDescAdd(vk_pipeline_manager* Manager, VkRenderPass Handle, u8* Data, u32 Size)
+{
+    // NOTE: Handles can get reused after a render pass is destroyed, so overwrite the old description
+    vk_render_pass_desc* Desc = VkPipelineRenderPassDescGet(Manager, Handle);
+    if (!Desc)
+    {
+        Assert(Manager->NumRenderPassDescs < Manager->MaxNumRenderPassDescs);
+        Desc = Manager->RenderPassDescs + Manager->NumRenderPassDescs++;
+        *Desc = {};
+    }
+
+    if (Size > Desc->Capacity)
+    {
+        Desc->Data = PushArray(&Manager->Arena, u8, Size);
+        Desc->Capacity = Size;
+    }
+
+    Desc->Handle = Handle;
+    Desc->Size = Size;
+    Desc->Hash = VkHashBytes(VK_HASH_INIT, Data, Size);
+    Copy(Data, Desc->Data, Size);
+}
+
+inline void VkPipelineRenderPassAdd(vk_pipeline_manager* Manager, VkRenderPass Handle, VkRenderPassCreateInfo* CreateInfo)
+{
+    u8 Buffer[KiloBytes(8)];
+    vk_manifest_writer Writer = VkManifestWriterCreate(Buffer, sizeof(Buffer));
+    VkManifestWriteRenderPass(&Writer, CreateInfo);
+    VkPipelineRenderPassDescAdd(Manager, Handle, Writer.Start, VkManifestWriterGetSize(&Writer));
+}
+
+inline void VkPipelineDescriptorLayoutDescAdd(vk_pipeline_manager* Manager, VkDescriptorSetLayout Handle, u8* Data, u32 Size)
+{
+    vk_descriptor_layout_desc* Desc = VkPipelineDescriptorLayoutDescGet(Manager, Handle);
+    if (!Desc)
+    {
+        Assert(Manager->NumDescriptorLayoutDescs < Manager->MaxNumDescriptorLayoutDescs);
+        Desc = Manager->DescriptorLayoutDescs + Manager->NumDescriptorLayoutDescs++;
+        *Desc = {};
+    }
+
+    if (Size > Desc->Capacity)
+    {
+        Desc->Data = PushArray(&Manager->Arena, u8, Size);
+        Desc->Capacity = Size;
+    }
+
+    Desc->Handle = Handle;
+    Desc->Size = Size;
+    Desc->Hash = VkHashBytes(VK_HASH_INIT, Data, Size);
+    Copy(Data, Desc->Data, Size);
+}
+
+inline void VkPipelineDescriptorLayoutAdd(vk_pipeline_manager* Manager, VkDescriptorSetLayout Handle, VkDescriptorSetLayoutCreateInfo* CreateInfo)
+{
+    u8 Buffer[KiloBytes(8)];
+    vk_manifest_writer Writer = VkManifestWriterCreate(Buffer, sizeof(Buffer));
+    VkManifestWriteDescriptorLayout(&Writer, CreateInfo);
+    VkPipelineDescriptorLayoutDescAdd(Manager, Handle, Writer.Start, VkManifestWriterGetSize(&Writer));
+}
+
+inline b32 VkPipelineEntrySerialize(vk_pipeline_manager* Manager, vk_manifest_writer* Writer, vk_pipeline_entry* Entry)
+{
+    // NOTE: Returns false if the entry references a render pass or layout that wasn't registered with the manager
+    b32 Result = true;
+
+    VkManifestWrite(Writer, Entry->Type);
+    VkManifestWrite(Writer, Entry->NumShaders);
+    for (u32 ShaderId = 0; ShaderId < Entry->NumShaders; ++ShaderId)
+    {
+        vk_shader_ref* ShaderRef = Entry->ShaderRefs + ShaderId;
+        VkManifestWrite(Writer, ShaderRef->Stage);
+        VkManifestWriteString(Writer, ShaderRef->FileName);
+        VkManifestWriteString(Writer, ShaderRef->MainName);
+        VkManifestWriteString(Writer, ShaderRef->Defines ? ShaderRef->Defines : (char*)"");
+    }
+
+    VkManifestWrite(Writer, Entry->NumSetLayouts);
+    for (u32 LayoutId = 0; LayoutId < Entry->NumSetLayouts; ++LayoutId)
+    {
+        vk_descriptor_layout_desc* Desc = VkPipelineDescriptorLayoutDescGet(Manager, Entry->SetLayouts[LayoutId]);
+        u64 Hash = Desc ? Desc->Hash : 0;
+        VkManifestWrite(Writer, Hash);
+        Result = Result && Desc;
+    }
+    
+    VkManifestWrite(Writer, Entry->NumPushConstantRanges);
+    VkManifestWriteArray(Writer, Entry->PushConstantRanges, Entry->NumPushConstantRanges);
+
+    if (Entry->Type == VkPipelineEntry_Graphics)
+    {
+        vk_pipeline_graphics_entry* GraphicsEntry = &Entry->GraphicsEntry;
+        VkGraphicsPipelineCreateInfo* CreateInfo = &GraphicsEntry->PipelineCreateInfo;
+
+        vk_render_pass_desc* RenderPassDesc = VkPipelineRenderPassDescGet(Manager, CreateInfo->renderPass);
+        u64 RenderPassHash = RenderPassDesc ? RenderPassDesc->Hash : 0;
+        VkManifestWrite(Writer, RenderPassHash);
+        VkManifestWrite(Writer, CreateInfo->subpass);
+        VkManifestWrite(Writer, CreateInfo->flags);
+        Result = Result && RenderPassDesc;
+
+        // NOTE: Vertex input state
+        {
+            VkPipelineVertexInputStateCreateInfo* State = &GraphicsEntry->VertexInputState;
+            VkManifestWrite(Writer, State->vertexBindingDescriptionCount);
+            VkManifestWriteArray(Writer, State->pVertexBindingDescriptions, State->vertexBindingDescriptionCount);
+            VkManifestWrite(Writer, State->vertexAttributeDescriptionCount);
+            VkManifestWriteArray(Writer, State->pVertexAttributeDescriptions, State->vertexAttributeDescriptionCount);
+        }
+
+        // NOTE: Input assembly + tessellation state
+        {
+            VkManifestWrite(Writer, GraphicsEntry->InputAssemblyState.topology);
+            VkManifestWrite(Writer, GraphicsEntry->InputAssemblyState.primitiveRestartEnable);
+
+            b32 HasTessellation = CreateInfo->pTessellationState != 0;
+            VkManifestWrite(Writer, HasTessellation);
+            VkManifestWrite(Writer, GraphicsEntry->TessellationState.patchControlPoints);
+        }
+
+        // NOTE: Viewport state (arrays are null when viewports are dynamic)
+        {
+            VkPipelineViewportStateCreateInfo* State = &GraphicsEntry->ViewportState;
+            b32 HasViewports = State->pViewports != 0;
+            b32 HasScissors = State->pScissors != 0;
+            VkManifestWrite(Writer, State->viewportCount);
+            VkManifestWrite(Writer, HasViewports);
+            VkManifestWriteArray(Writer, State->pViewports, HasViewports ? State->viewportCount : 0);
+            VkManifestWrite(Writer, State->scissorCount);
+            VkManifestWrite(Writer, HasScissors);
+            VkManifestWriteArray(Writer, State->pScissors, HasScissors ? State->scissorCount : 0);
+        }
+
+        // NOTE: Rasterization state
+        {
+            VkPipelineRasterizationStateCreateInfo* State = &GraphicsEntry->RasterizationState;
+            VkManifestWrite(Writer, State->depthClampEnable);
+            VkManifestWrite(Writer, State->rasterizerDiscardEnable);
+            VkManifestWrite(Writer, State->polygonMode);
+            VkManifestWrite(Writer, State->cullMode);
+            VkManifestWrite(Writer, State->frontFace);
+            VkManifestWrite(Writer, State->depthBiasEnable);
+            VkManifestWrite(Writer, State->depthBiasConstantFactor);
+            VkManifestWrite(Writer, State->depthBiasClamp);
+            VkManifestWrite(Writer, State->depthBiasSlopeFactor);
+            VkManifestWrite(Writer, State->lineWidth);
+
+            VkPipelineRasterizationConservativeStateCreateInfoEXT* Conservative = &GraphicsEntry->ConservativeState;
+            b32 HasConservative = Conservative->sType != 0;
+            VkManifestWrite(Writer, HasConservative);
+            VkManifestWrite(Writer, Conservative->conservativeRasterizationMode);
+            VkManifestWrite(Writer, Conservative->extraPrimitiveOverestimationSize);
+        }
+
+        // NOTE: Multisample state
+        {
+            VkPipelineMultisampleStateCreateInfo* State = &GraphicsEntry->MultisampleState;
+            Assert(!State->pSampleMask);
+            VkManifestWrite(Writer, State->rasterizationSamples);
+            VkManifestWrite(Writer, State->sampleShadingEnable);
+            VkManifestWrite(Writer, State->minSampleShading);
+            VkManifestWrite(Writer, State->alphaToCoverageEnable);
+            VkManifestWrite(Writer, State->alphaToOneEnable);
+        }
+        
+        // NOTE: Depth stencil state
+        {
+            VkPipelineDepthStencilStateCreateInfo* State = &GraphicsEntry->DepthStencilState;
+            b32 HasDepthStencil = CreateInfo->pDepthStencilState != 0;
+            VkManifestWrite(Writer, HasDepthStencil);
+            VkManifestWrite(Writer, State->depthTestEnable);
+            VkManifestWrite(Writer, State->depthWriteEnable);
+            VkManifestWrite(Writer, State->depthCompareOp);
+            VkManifestWrite(Writer, State->depthBoundsTestEnable);
+            VkManifestWrite(Writer, State->stencilTestEnable);
+            VkManifestWrite(Writer, State->front);
+            VkManifestWrite(Writer, State->back);
+            VkManifestWrite(Writer, State->minDepthBounds);
+            VkManifestWrite(Writer, State->maxDepthBounds);
+        }
+
+        // NOTE: Color blend state
+        {
+            VkPipelineColorBlendStateCreateInfo* State = &GraphicsEntry->ColorBlendState;
+            VkManifestWrite(Writer, State->logicOpEnable);
+            VkManifestWrite(Writer, State->logicOp);
+            VkManifestWrite(Writer, State->attachmentCount);
+            VkManifestWriteArray(Writer, State->pAttachments, State->attachmentCount);
+            VkManifestWrite(Writer, State->blendConstants);
+        }
+
+        // NOTE: Dynamic state
+        {
+            VkPipelineDynamicStateCreateInfo* State = &GraphicsEntry->DynamicStateCreateInfo;
+            VkManifestWrite(Writer, State->dynamicStateCount);
+            VkManifestWriteArray(Writer, State->pDynamicStates, State->dynamicStateCount);
+        }
+    }
+
+    return Result;
+}
+
+inline u64 VkPipelineEntryHash(vk_pipeline_manager* Manager, linear_arena* TempArena, vk_pipeline_entry* Entry)
+{
+    temp_mem TempMem = BeginTempMem(TempArena);
+
+    mm BufferSize = KiloBytes(64);
+    vk_manifest_writer Writer = VkManifestWriterCreate(PushArray(TempArena, u8, BufferSize), BufferSize);
+    VkPipelineEntrySerialize(Manager, &Writer, Entry);
+    u64 Result = VkHashBytes(VK_HASH_INIT, Writer.Start, VkManifestWriterGetSize(&Writer));
+    
+    EndTempMem(TempMem);
+
+    return Result;
+}
+
+inline b32 VkPipelineWarmEntryClaim(vk_pipeline_manager* Manager, linear_arena* TempArena, u64 StateHash, vk_pipeline_entry* Entry)
+{
+    // NOTE: If this pipeline was prebuilt from the manifest, hand it over instead of compiling it again
+    b32 Result = false;
+    for (u32 WarmId = 0; WarmId < Manager->NumWarmPipelines; ++WarmId)
+    {
+        vk_pipeline_warm_entry* WarmEntry = Manager->WarmPipelineArray + WarmId;
+        if (!WarmEntry->Claimed && WarmEntry->StateHash == StateHash)
+        {
+            WarmEntry->Claimed = true;
+            Entry->Pipeline = WarmEntry->Pipeline;
+            for (u32 ShaderId = 0; ShaderId < Entry->NumShaders; ++ShaderId)
+            {
+                vk_shader_ref* ShaderRef = Entry->ShaderRefs + ShaderId;
+                ShaderRef->ModifiedTime = WarmEntry->ModifiedTimes[ShaderId];
+
+                // NOTE: We skipped compiling, so we still need the include list for hot reloading
+                if (ShaderRef->Includes)
+                {
+                    temp_mem TempMem = BeginTempMem(TempArena);
+                    u32 SourceSize = 0;
+                    u8* Source = VkShaderFileRead(TempArena, ShaderRef->FileName, &SourceSize, 0);
+                    if (Source)
+                    {
+                        VkShaderIncludesGather(TempArena, ShaderRef, Source, SourceSize);
+                    }
+                    EndTempMem(TempMem);
+                }
+            }
+
+            Result = true;
+            break;
+        }
+    }
+
     return Result;
 }
 
+inline void VkPipelineEntryLayoutSet(vk_pipeline_manager* Manager, vk_pipeline_entry* Entry, VkPipelineLayoutCreateInfo* LayoutCreateInfo)
+{
+    Entry->NumSetLayouts = LayoutCreateInfo->setLayoutCount;
+    if (Entry->NumSetLayouts > 0)
+    {
+        Entry->SetLayouts = PushArray(&Manager->Arena, VkDescriptorSetLayout, Entry->NumSetLayouts);
+        Copy(LayoutCreateInfo->pSetLayouts, Entry->SetLayouts, sizeof(VkDescriptorSetLayout)*Entry->NumSetLayouts);
+    }
+
+    Entry->NumPushConstantRanges = LayoutCreateInfo->pushConstantRangeCount;
+    if (Entry->NumPushConstantRanges > 0)
+    {
+        Entry->PushConstantRanges = PushArray(&Manager->Arena, VkPushConstantRange, Entry->NumPushConstantRanges);
+        Copy(LayoutCreateInfo->pPushConstantRanges, Entry->PushConstantRanges, sizeof(VkPushConstantRange)*Entry->NumPushConstantRanges);
+    }
+}
+
 inline VkPipelineShaderStageCreateInfo VkPipelineShaderStage(VkShaderStageFlagBits Stage, VkShaderModule Module, char* MainName)
 {
     VkPipelineShaderStageCreateInfo Result = {};
@@ -25,7 +981,7 @@ inline VkPipelineShaderStageCreateInfo VkPipelineShaderStage(VkShaderStageFlagBi
 }
 
 inline void VkPipelineAddShaderRef(vk_pipeline_manager* Manager, vk_pipeline_entry* Entry, char* FileName, char* MainName,
-                                   VkShaderStageFlagBits Stage)
+                                   VkShaderStageFlagBits Stage, char* Defines = 0)
 {
     Assert(Entry->NumShaders < VK_MAX_PIPELINE_STAGES);
     vk_shader_ref* ShaderRef = Entry->ShaderRefs + Entry->NumShaders++;
@@ -33,16 +989,24 @@ inline void VkPipelineAddShaderRef(vk_pipeline_manager* Manager, vk_pipeline_ent
     // NOTE: Copy strings since our DLL might get swapped and create all shaders
     ShaderRef->FileName = PushString(&Manager->Arena, FileName);
     ShaderRef->MainName = PushString(&Manager->Arena, MainName);
+    ShaderRef->Defines = Defines ? PushString(&Manager->Arena, Defines) : 0;
     ShaderRef->Stage = Stage;
+
+    if (!VkShaderIsSpirv(FileName))
+    {
+        ShaderRef->Includes = PushArray(&Manager->Arena, vk_shader_include, VK_MAX_SHADER_INCLUDES);
+    }
 }
 
 inline void VkPipelineAddShaderRef(vk_pipeline_manager* Manager, vk_pipeline_entry* Entry, vk_pipeline_builder_shader BuilderShader)
 {
-    VkPipelineAddShaderRef(Manager, Entry, BuilderShader.FileName, BuilderShader.MainName, BuilderShader.Stage);
+    VkPipelineAddShaderRef(Manager, Entry, BuilderShader.FileName, BuilderShader.MainName, BuilderShader.Stage, BuilderShader.Defines);
 }
 
 inline VkShaderModule VkPipelineGetShaderModule(VkDevice Device, HANDLE File, linear_arena* TempArena, vk_shader_ref* ShaderRef)
 {
+    // NOTE: Returns VK_NULL_HANDLE if the source doesn't compile. ModifiedTime only moves forward on success so the
+    // next VkPipelineUpdateShaders tries again, which also covers editors that save in several writes
     VkShaderModule Result = {};
     
     temp_mem TempMem = BeginTempMem(TempArena);
@@ -63,17 +1027,29 @@ inline VkShaderModule VkPipelineGetShaderModule(VkDevice Device, HANDLE File, li
         InvalidCodePath;
     }
 
-    if (!GetFileTime(File, 0, 0, &ShaderRef->ModifiedTime))
+    FILETIME ModifiedTime = {};
+    if (!GetFileTime(File, 0, 0, &ModifiedTime))
     {
         DWORD Error = GetLastError();
         InvalidCodePath;
     }
-    
-    VkShaderModuleCreateInfo ShaderModuleCreateInfo = {};
-    ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    ShaderModuleCreateInfo.codeSize = CodeSize.LowPart;
-    ShaderModuleCreateInfo.pCode = Code;
-    VkCheckResult(vkCreateShaderModule(Device, &ShaderModuleCreateInfo, 0, &Result));
+
+    // NOTE: Anything that isn't spirv is treated as glsl/hlsl source
+    u32 SpirvSize = CodeSize.LowPart;
+    if (!VkShaderIsSpirv(ShaderRef->FileName))
+    {
+        Code = VkShaderCompileCached(TempArena, ShaderRef, (u8*)Code, CodeSize.LowPart, &SpirvSize);
+    }
+
+    if (Code)
+    {
+        VkShaderModuleCreateInfo ShaderModuleCreateInfo = {};
+        ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        ShaderModuleCreateInfo.codeSize = SpirvSize;
+        ShaderModuleCreateInfo.pCode = Code;
+        VkCheckResult(vkCreateShaderModule(Device, &ShaderModuleCreateInfo, 0, &Result));
+        ShaderRef->ModifiedTime = ModifiedTime;
+    }
 
     EndTempMem(TempMem);
 
@@ -82,7 +1058,8 @@ inline VkShaderModule VkPipelineGetShaderModule(VkDevice Device, HANDLE File, li
 
 inline VkShaderModule VkPipelineGetShaderModule(VkDevice Device, linear_arena* TempArena, vk_shader_ref* ShaderRef)
 {
-    HANDLE File = CreateFileA(ShaderRef->FileName, GENERIC_READ, 0, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    // NOTE: Shared read since pipelines can get built on multiple threads
+    HANDLE File = CreateFileA(ShaderRef->FileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
     if (File == INVALID_HANDLE_VALUE)
     {
         DWORD Error = GetLastError();
@@ -92,23 +1069,25 @@ inline VkShaderModule VkPipelineGetShaderModule(VkDevice Device, linear_arena* T
     VkShaderModule Result = VkPipelineGetShaderModule(Device, File, TempArena, ShaderRef);
     CloseHandle(File);
 
+    // NOTE: First builds have no previous pipeline to fall back to, the compile errors are in the debug output
+    Assert(Result != VK_NULL_HANDLE);
+
     return Result;
 }
 
 inline vk_pipeline* VkPipelineComputeCreate(VkDevice Device, vk_pipeline_manager* Manager, linear_arena* TempArena, char* FileName,
-                                            char* MainName, VkDescriptorSetLayout* Layouts, u32 NumLayouts, u32 PushConstantSize = 0)
+                                            char* MainName, VkDescriptorSetLayout* Layouts, u32 NumLayouts, u32 PushConstantSize = 0,
+                                            char* Defines = 0)
 {
     Assert(Manager->NumPipelines < Manager->MaxNumPipelines);
     vk_pipeline_entry* Entry = Manager->PipelineArray + Manager->NumPipelines++;
     *Entry = {};
     Entry->Type = VkPipelineEntry_Compute;
-    VkPipelineAddShaderRef(Manager, Entry, FileName, MainName, VK_SHADER_STAGE_COMPUTE_BIT);
+    VkPipelineAddShaderRef(Manager, Entry, FileName, MainName, VK_SHADER_STAGE_COMPUTE_BIT, Defines);
     
     // NOTE: Setup pipeline create infos and create pipeline
     {
         vk_pipeline_compute_entry* ComputeEntry = &Entry->ComputeEntry;
-        VkShaderModule CsShader = VkPipelineGetShaderModule(Device, TempArena, Entry->ShaderRefs + 0);
-        VkPipelineShaderStageCreateInfo ShaderStageCreateInfo = VkPipelineShaderStage(VK_SHADER_STAGE_COMPUTE_BIT, CsShader, MainName);
 
         VkPushConstantRange PushConstantRange = {};
         PushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
@@ -124,17 +1103,30 @@ inline vk_pipeline* VkPipelineComputeCreate(VkDevice Device, vk_pipeline_manager
             LayoutCreateInfo.pushConstantRangeCount = 1;
             LayoutCreateInfo.pPushConstantRanges = &PushConstantRange;
         }
-        VkCheckResult(vkCreatePipelineLayout(Device, &LayoutCreateInfo, 0, &Entry->Pipeline.Layout));
+        VkPipelineEntryLayoutSet(Manager, Entry, &LayoutCreateInfo);
 
         ComputeEntry->PipelineCreateInfo = {};
         ComputeEntry->PipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-        ComputeEntry->PipelineCreateInfo.stage = ShaderStageCreateInfo;
-        ComputeEntry->PipelineCreateInfo.layout = Entry->Pipeline.Layout;
         ComputeEntry->PipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
         ComputeEntry->PipelineCreateInfo.basePipelineIndex = -1;
-        VkCheckResult(vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &ComputeEntry->PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
 
-        vkDestroyShaderModule(Device, CsShader, 0);
+        u64 StateHash = VkPipelineEntryHash(Manager, TempArena, Entry);
+        if (VkPipelineWarmEntryClaim(Manager, TempArena, StateHash, Entry))
+        {
+            ComputeEntry->PipelineCreateInfo.layout = Entry->Pipeline.Layout;
+        }
+        else
+        {
+            VkShaderModule CsShader = VkPipelineGetShaderModule(Device, TempArena, Entry->ShaderRefs + 0);
+            VkPipelineShaderStageCreateInfo ShaderStageCreateInfo = VkPipelineShaderStage(VK_SHADER_STAGE_COMPUTE_BIT, CsShader, MainName);
+            VkCheckResult(vkCreatePipelineLayout(Device, &LayoutCreateInfo, 0, &Entry->Pipeline.Layout));
+
+            ComputeEntry->PipelineCreateInfo.stage = ShaderStageCreateInfo;
+            ComputeEntry->PipelineCreateInfo.layout = Entry->Pipeline.Layout;
+            VkCheckResult(vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &ComputeEntry->PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
+
+            vkDestroyShaderModule(Device, CsShader, 0);
+        }
     }
     
     return &Entry->Pipeline;
@@ -195,6 +1187,7 @@ inline vk_pipeline* VkPipelineGraphicsCreate(VkDevice Device, vk_pipeline_manage
             if (PipelineCreateInfo->pRasterizationState->pNext)
             {
                 GraphicsEntry->ConservativeState = *(VkPipelineRasterizationConservativeStateCreateInfoEXT*)PipelineCreateInfo->pRasterizationState->pNext;
+                GraphicsEntry->RasterizationState.pNext = &GraphicsEntry->ConservativeState;
             }
             GraphicsEntry->MultisampleState = *PipelineCreateInfo->pMultisampleState;
             
@@ -236,25 +1229,39 @@ inline vk_pipeline* VkPipelineGraphicsCreate(VkDevice Device, vk_pipeline_manage
         }
 
         // NOTE: Store references to our shaders in managers arena
-        VkShaderModule ShaderModules[VK_MAX_PIPELINE_STAGES] = {};
-        VkPipelineShaderStageCreateInfo ShaderStages[VK_MAX_PIPELINE_STAGES] = {};
         for (u32 ShaderId = 0; ShaderId < NumShaders; ++ShaderId)
         {
             VkPipelineAddShaderRef(Manager, Entry, Shaders[ShaderId]);
-            ShaderModules[ShaderId] = VkPipelineGetShaderModule(Device, TempArena, Entry->ShaderRefs + ShaderId);
-            ShaderStages[ShaderId] = VkPipelineShaderStage(Shaders[ShaderId].Stage, ShaderModules[ShaderId], Shaders[ShaderId].MainName);
         }
-        VkCheckResult(vkCreatePipelineLayout(Device, LayoutCreateInfo, 0, &Entry->Pipeline.Layout));
-
-        // NOTE: Create pipeline (patch up some values in the create info)
-        GraphicsEntry->PipelineCreateInfo.pStages = ShaderStages;
+        VkPipelineEntryLayoutSet(Manager, Entry, LayoutCreateInfo);
         GraphicsEntry->PipelineCreateInfo.stageCount = NumShaders;
-        GraphicsEntry->PipelineCreateInfo.layout = Entry->Pipeline.Layout;
-        VkCheckResult(vkCreateGraphicsPipelines(Device, VK_NULL_HANDLE, 1, &GraphicsEntry->PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
 
-        for (u32 ShaderId = 0; ShaderId < NumShaders; ++ShaderId)
+        u64 StateHash = VkPipelineEntryHash(Manager, TempArena, Entry);
+        if (VkPipelineWarmEntryClaim(Manager, TempArena, StateHash, Entry))
+        {
+            GraphicsEntry->PipelineCreateInfo.layout = Entry->Pipeline.Layout;
+        }
+        else
         {
-            vkDestroyShaderModule(Device, ShaderModules[ShaderId], 0);
+            VkShaderModule ShaderModules[VK_MAX_PIPELINE_STAGES] = {};
+            VkPipelineShaderStageCreateInfo ShaderStages[VK_MAX_PIPELINE_STAGES] = {};
+            for (u32 ShaderId = 0; ShaderId < NumShaders; ++ShaderId)
+            {
+                ShaderModules[ShaderId] = VkPipelineGetShaderModule(Device, TempArena, Entry->ShaderRefs + ShaderId);
+                ShaderStages[ShaderId] = VkPipelineShaderStage(Shaders[ShaderId].Stage, ShaderModules[ShaderId], Shaders[ShaderId].MainName);
+            }
+            VkCheckResult(vkCreatePipelineLayout(Device, LayoutCreateInfo, 0, &Entry->Pipeline.Layout));
+
+            // NOTE: Create pipeline (patch up some values in the create info)
+            GraphicsEntry->PipelineCreateInfo.pStages = ShaderStages;
+            GraphicsEntry->PipelineCreateInfo.layout = Entry->Pipeline.Layout;
+            VkCheckResult(vkCreateGraphicsPipelines(Device, VK_NULL_HANDLE, 1, &GraphicsEntry->PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
+            GraphicsEntry->PipelineCreateInfo.pStages = 0;
+            
+            for (u32 ShaderId = 0; ShaderId < NumShaders; ++ShaderId)
+            {
+                vkDestroyShaderModule(Device, ShaderModules[ShaderId], 0);
+            }
         }
     }
     
@@ -292,6 +1299,17 @@ inline void VkPipelineUpdateShaders(VkDevice Device, linear_arena* TempArena, vk
                 DWORD Error = GetLastError();
                 Assert(Error == 32);
             }
+
+            // NOTE: Source shaders also get rebuilt when any of their includes change
+            for (u32 IncludeId = 0; IncludeId < CurrShaderRef->NumIncludes; ++IncludeId)
+            {
+                vk_shader_include* Include = CurrShaderRef->Includes + IncludeId;
+                WIN32_FILE_ATTRIBUTE_DATA Attributes = {};
+                if (GetFileAttributesExA(Include->FileName, GetFileExInfoStandard, &Attributes))
+                {
+                    ReCreatePSO = ReCreatePSO || CompareFileTime(&Include->ModifiedTime, &Attributes.ftLastWriteTime) == -1;
+                }
+            }
         }
 
         if (ReCreatePSO)
@@ -306,21 +1324,31 @@ inline void VkPipelineUpdateShaders(VkDevice Device, linear_arena* TempArena, vk
                     // NOTE: Generate shader create infos
                     VkShaderModule ShaderModules[VK_MAX_PIPELINE_STAGES] = {};
                     VkPipelineShaderStageCreateInfo ShaderStages[VK_MAX_PIPELINE_STAGES] = {};
+                    b32 AllCompiled = true;
                     for (u32 ShaderId = 0; ShaderId < Entry->NumShaders; ++ShaderId)
                     {
                         vk_shader_ref* ShaderRef = Entry->ShaderRefs + ShaderId;
                         ShaderModules[ShaderId] = VkPipelineGetShaderModule(Device, FileHandles[ShaderId], TempArena, ShaderRef);
                         ShaderStages[ShaderId] = VkPipelineShaderStage(ShaderRef->Stage, ShaderModules[ShaderId], ShaderRef->MainName);
+                        AllCompiled = AllCompiled && ShaderModules[ShaderId] != VK_NULL_HANDLE;
                     }
 
-                    VkGraphicsPipelineCreateInfo PipelineCreateInfo = GraphicsEntry->PipelineCreateInfo;
-                    PipelineCreateInfo.stageCount = Entry->NumShaders;
-                    PipelineCreateInfo.pStages = ShaderStages;
-                    VkCheckResult(vkCreateGraphicsPipelines(Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
+                    // NOTE: Keep the previous pipeline if any stage failed to compile
+                    if (AllCompiled)
+                    {
+                        VkGraphicsPipelineCreateInfo PipelineCreateInfo = GraphicsEntry->PipelineCreateInfo;
+                        PipelineCreateInfo.stageCount = Entry->NumShaders;
+                        PipelineCreateInfo.pStages = ShaderStages;
+                        VkCheckResult(vkCreateGraphicsPipelines(Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
+                        Entry->Pipeline.Generation += 1;
+                    }
 
                     for (u32 ShaderId = 0; ShaderId < Entry->NumShaders; ++ShaderId)
                     {
-                        vkDestroyShaderModule(Device, ShaderModules[ShaderId], 0);
+                        if (ShaderModules[ShaderId] != VK_NULL_HANDLE)
+                        {
+                            vkDestroyShaderModule(Device, ShaderModules[ShaderId], 0);
+                        }
                     }
                 } break;
 
@@ -330,13 +1358,17 @@ inline void VkPipelineUpdateShaders(VkDevice Device, linear_arena* TempArena, vk
 
                     vk_shader_ref* ShaderRef = Entry->ShaderRefs + 0;
                     VkShaderModule ShaderModule = VkPipelineGetShaderModule(Device, FileHandles[0], TempArena, ShaderRef);
-                    VkPipelineShaderStageCreateInfo ShaderStageCreateInfo = VkPipelineShaderStage(ShaderRef->Stage, ShaderModule, ShaderRef->MainName);
+                    if (ShaderModule != VK_NULL_HANDLE)
+                    {
+                        VkPipelineShaderStageCreateInfo ShaderStageCreateInfo = VkPipelineShaderStage(ShaderRef->Stage, ShaderModule, ShaderRef->MainName);
 
-                    VkComputePipelineCreateInfo PipelineCreateInfo = ComputeEntry->PipelineCreateInfo;
-                    PipelineCreateInfo.stage = ShaderStageCreateInfo;
-                    VkCheckResult(vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
+                        VkComputePipelineCreateInfo PipelineCreateInfo = ComputeEntry->PipelineCreateInfo;
+                        PipelineCreateInfo.stage = ShaderStageCreateInfo;
+                        VkCheckResult(vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
+                        Entry->Pipeline.Generation += 1;
 
-                    vkDestroyShaderModule(Device, ShaderModule, 0);
+                        vkDestroyShaderModule(Device, ShaderModule, 0);
+                    }
                 } break;
 
                 default:
@@ -353,6 +1385,474 @@ inline void VkPipelineUpdateShaders(VkDevice Device, linear_arena* TempArena, vk
     }
 }
 
+//
+// NOTE: Pipeline Manifest
+//
+
+inline b32 VkManifestReadPipelineEntry(VkDevice Device, vk_pipeline_manager* Manager, linear_arena* Arena, vk_manifest_reader* Reader,
+                                       vk_pipeline_entry* Entry)
+{
+    // NOTE: Returns false if the entry can't be built anymore (missing shaders, render passes or layouts)
+    b32 Result = true;
+
+    *Entry = {};
+    Entry->Type = VkManifestRead(Reader, vk_pipeline_entry_type);
+    Entry->NumShaders = VkManifestRead(Reader, u32);
+    Assert(Entry->NumShaders <= VK_MAX_PIPELINE_STAGES);
+    for (u32 ShaderId = 0; ShaderId < Entry->NumShaders; ++ShaderId)
+    {
+        vk_shader_ref* ShaderRef = Entry->ShaderRefs + ShaderId;
+        ShaderRef->Stage = VkManifestRead(Reader, VkShaderStageFlagBits);
+        ShaderRef->FileName = VkManifestReadString(Reader);
+        ShaderRef->MainName = VkManifestReadString(Reader);
+        ShaderRef->Defines = VkManifestReadString(Reader);
+        Result = Result && GetFileAttributesA(ShaderRef->FileName) != INVALID_FILE_ATTRIBUTES;
+    }
+
+    Entry->NumSetLayouts = VkManifestRead(Reader, u32);
+    Entry->SetLayouts = PushArray(Arena, VkDescriptorSetLayout, Entry->NumSetLayouts);
+    for (u32 LayoutId = 0; LayoutId < Entry->NumSetLayouts; ++LayoutId)
+    {
+        vk_descriptor_layout_desc* Desc = VkPipelineDescriptorLayoutDescFind(Manager, VkManifestRead(Reader, u64));
+        Entry->SetLayouts[LayoutId] = Desc ? Desc->Handle : VK_NULL_HANDLE;
+        Result = Result && Desc;
+    }
+
+    Entry->NumPushConstantRanges = VkManifestRead(Reader, u32);
+    Entry->PushConstantRanges = VkManifestReadArray(Reader, VkPushConstantRange, Entry->NumPushConstantRanges);
+
+    switch (Entry->Type)
+    {
+        case VkPipelineEntry_Graphics:
+        {
+            vk_pipeline_graphics_entry* GraphicsEntry = &Entry->GraphicsEntry;
+            VkGraphicsPipelineCreateInfo* CreateInfo = &GraphicsEntry->PipelineCreateInfo;
+            CreateInfo->sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+            CreateInfo->basePipelineHandle = VK_NULL_HANDLE;
+            CreateInfo->basePipelineIndex = -1;
+            CreateInfo->stageCount = Entry->NumShaders;
+            
+            vk_render_pass_desc* RenderPassDesc = VkPipelineRenderPassDescFind(Manager, VkManifestRead(Reader, u64));
+            CreateInfo->renderPass = RenderPassDesc ? RenderPassDesc->Handle : VK_NULL_HANDLE;
+            CreateInfo->subpass = VkManifestRead(Reader, u32);
+            CreateInfo->flags = VkManifestRead(Reader, VkPipelineCreateFlags);
+            Result = Result && RenderPassDesc;
+
+            // NOTE: Vertex input state
+            {
+                VkPipelineVertexInputStateCreateInfo* State = &GraphicsEntry->VertexInputState;
+                State->sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+                State->vertexBindingDescriptionCount = VkManifestRead(Reader, u32);
+                GraphicsEntry->VertBindings = VkManifestReadArray(Reader, VkVertexInputBindingDescription, State->vertexBindingDescriptionCount);
+                State->pVertexBindingDescriptions = GraphicsEntry->VertBindings;
+                State->vertexAttributeDescriptionCount = VkManifestRead(Reader, u32);
+                GraphicsEntry->VertAttributes = VkManifestReadArray(Reader, VkVertexInputAttributeDescription, State->vertexAttributeDescriptionCount);
+                State->pVertexAttributeDescriptions = GraphicsEntry->VertAttributes;
+                CreateInfo->pVertexInputState = State;
+            }
+
+            // NOTE: Input assembly + tessellation state
+            {
+                GraphicsEntry->InputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+                GraphicsEntry->InputAssemblyState.topology = VkManifestRead(Reader, VkPrimitiveTopology);
+                GraphicsEntry->InputAssemblyState.primitiveRestartEnable = VkManifestRead(Reader, VkBool32);
+                CreateInfo->pInputAssemblyState = &GraphicsEntry->InputAssemblyState;
+
+                b32 HasTessellation = VkManifestRead(Reader, b32);
+                GraphicsEntry->TessellationState.sType = VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO;
+                GraphicsEntry->TessellationState.patchControlPoints = VkManifestRead(Reader, u32);
+                CreateInfo->pTessellationState = HasTessellation ? &GraphicsEntry->TessellationState : 0;
+            }
+
+            // NOTE: Viewport state
+            {
+                VkPipelineViewportStateCreateInfo* State = &GraphicsEntry->ViewportState;
+                State->sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+                State->viewportCount = VkManifestRead(Reader, u32);
+                b32 HasViewports = VkManifestRead(Reader, b32);
+                GraphicsEntry->ViewPorts = VkManifestReadArray(Reader, VkViewport, HasViewports ? State->viewportCount : 0);
+                State->pViewports = HasViewports ? GraphicsEntry->ViewPorts : 0;
+                State->scissorCount = VkManifestRead(Reader, u32);
+                b32 HasScissors = VkManifestRead(Reader, b32);
+                GraphicsEntry->Scissors = VkManifestReadArray(Reader, VkRect2D, HasScissors ? State->scissorCount : 0);
+                State->pScissors = HasScissors ? GraphicsEntry->Scissors : 0;
+                CreateInfo->pViewportState = State;
+            }
+
+            // NOTE: Rasterization state
+            {
+                VkPipelineRasterizationStateCreateInfo* State = &GraphicsEntry->RasterizationState;
+                State->sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+                State->depthClampEnable = VkManifestRead(Reader, VkBool32);
+                State->rasterizerDiscardEnable = VkManifestRead(Reader, VkBool32);
+                State->polygonMode = VkManifestRead(Reader, VkPolygonMode);
+                State->cullMode = VkManifestRead(Reader, VkCullModeFlags);
+                State->frontFace = VkManifestRead(Reader, VkFrontFace);
+                State->depthBiasEnable = VkManifestRead(Reader, VkBool32);
+                State->depthBiasConstantFactor = VkManifestRead(Reader, f32);
+                State->depthBiasClamp = VkManifestRead(Reader, f32);
+                State->depthBiasSlopeFactor = VkManifestRead(Reader, f32);
+                State->lineWidth = VkManifestRead(Reader, f32);
+
+                VkPipelineRasterizationConservativeStateCreateInfoEXT* Conservative = &GraphicsEntry->ConservativeState;
+                b32 HasConservative = VkManifestRead(Reader, b32);
+                Conservative->conservativeRasterizationMode = VkManifestRead(Reader, VkConservativeRasterizationModeEXT);
+                Conservative->extraPrimitiveOverestimationSize = VkManifestRead(Reader, f32);
+                if (HasConservative)
+                {
+                    Conservative->sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_CONSERVATIVE_STATE_CREATE_INFO_EXT;
+                    State->pNext = Conservative;
+                }
+                CreateInfo->pRasterizationState = State;
+            }
+
+            // NOTE: Multisample state
+            {
+                VkPipelineMultisampleStateCreateInfo* State = &GraphicsEntry->MultisampleState;
+                State->sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+                State->rasterizationSamples = VkManifestRead(Reader, VkSampleCountFlagBits);
+                State->sampleShadingEnable = VkManifestRead(Reader, VkBool32);
+                State->minSampleShading = VkManifestRead(Reader, f32);
+                State->alphaToCoverageEnable = VkManifestRead(Reader, VkBool32);
+                State->alphaToOneEnable = VkManifestRead(Reader, VkBool32);
+                CreateInfo->pMultisampleState = State;
+            }
+
+            // NOTE: Depth stencil state
+            {
+                VkPipelineDepthStencilStateCreateInfo* State = &GraphicsEntry->DepthStencilState;
+                b32 HasDepthStencil = VkManifestRead(Reader, b32);
+                State->sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+                State->depthTestEnable = VkManifestRead(Reader, VkBool32);
+                State->depthWriteEnable = VkManifestRead(Reader, VkBool32);
+                State->depthCompareOp = VkManifestRead(Reader, VkCompareOp);
+                State->depthBoundsTestEnable = VkManifestRead(Reader, VkBool32);
+                State->stencilTestEnable = VkManifestRead(Reader, VkBool32);
+                State->front = VkManifestRead(Reader, VkStencilOpState);
+                State->back = VkManifestRead(Reader, VkStencilOpState);
+                State->minDepthBounds = VkManifestRead(Reader, f32);
+                State->maxDepthBounds = VkManifestRead(Reader, f32);
+                CreateInfo->pDepthStencilState = HasDepthStencil ? State : 0;
+            }
+
+            // NOTE: Color blend state
+            {
+                VkPipelineColorBlendStateCreateInfo* State = &GraphicsEntry->ColorBlendState;
+                State->sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+                State->logicOpEnable = VkManifestRead(Reader, VkBool32);
+                State->logicOp = VkManifestRead(Reader, VkLogicOp);
+                State->attachmentCount = VkManifestRead(Reader, u32);
+                GraphicsEntry->Attachments = VkManifestReadArray(Reader, VkPipelineColorBlendAttachmentState, State->attachmentCount);
+                State->pAttachments = GraphicsEntry->Attachments;
+                Copy(VkManifestReadSize(Reader, sizeof(State->blendConstants)), State->blendConstants, sizeof(State->blendConstants));
+                CreateInfo->pColorBlendState = State;
+            }
+
+            // NOTE: Dynamic state
+            {
+                VkPipelineDynamicStateCreateInfo* State = &GraphicsEntry->DynamicStateCreateInfo;
+                State->sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+                State->dynamicStateCount = VkManifestRead(Reader, u32);
+                GraphicsEntry->DynamicStates = VkManifestReadArray(Reader, VkDynamicState, State->dynamicStateCount);
+                State->pDynamicStates = GraphicsEntry->DynamicStates;
+                CreateInfo->pDynamicState = State;
+            }
+        } break;
+
+        case VkPipelineEntry_Compute:
+        {
+            vk_pipeline_compute_entry* ComputeEntry = &Entry->ComputeEntry;
+            ComputeEntry->PipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            ComputeEntry->PipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+            ComputeEntry->PipelineCreateInfo.basePipelineIndex = -1;
+        } break;
+
+        default:
+        {
+            Result = false;
+        } break;
+    }
+
+    if (Result)
+    {
+        VkPipelineLayoutCreateInfo LayoutCreateInfo = {};
+        LayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        LayoutCreateInfo.setLayoutCount = Entry->NumSetLayouts;
+        LayoutCreateInfo.pSetLayouts = Entry->SetLayouts;
+        LayoutCreateInfo.pushConstantRangeCount = Entry->NumPushConstantRanges;
+        LayoutCreateInfo.pPushConstantRanges = Entry->PushConstantRanges;
+        VkCheckResult(vkCreatePipelineLayout(Device, &LayoutCreateInfo, 0, &Entry->Pipeline.Layout));
+    }
+    
+    return Result;
+}
+
+inline void VkPipelineEntryBuild(VkDevice Device, linear_arena* TempArena, vk_pipeline_entry* Entry)
+{
+    VkShaderModule ShaderModules[VK_MAX_PIPELINE_STAGES] = {};
+    VkPipelineShaderStageCreateInfo ShaderStages[VK_MAX_PIPELINE_STAGES] = {};
+    for (u32 ShaderId = 0; ShaderId < Entry->NumShaders; ++ShaderId)
+    {
+        vk_shader_ref* ShaderRef = Entry->ShaderRefs + ShaderId;
+        ShaderModules[ShaderId] = VkPipelineGetShaderModule(Device, TempArena, ShaderRef);
+        ShaderStages[ShaderId] = VkPipelineShaderStage(ShaderRef->Stage, ShaderModules[ShaderId], ShaderRef->MainName);
+    }
+
+    switch (Entry->Type)
+    {
+        case VkPipelineEntry_Graphics:
+        {
+            VkGraphicsPipelineCreateInfo PipelineCreateInfo = Entry->GraphicsEntry.PipelineCreateInfo;
+            PipelineCreateInfo.stageCount = Entry->NumShaders;
+            PipelineCreateInfo.pStages = ShaderStages;
+            PipelineCreateInfo.layout = Entry->Pipeline.Layout;
+            VkCheckResult(vkCreateGraphicsPipelines(Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
+        } break;
+
+        case VkPipelineEntry_Compute:
+        {
+            VkComputePipelineCreateInfo PipelineCreateInfo = Entry->ComputeEntry.PipelineCreateInfo;
+            PipelineCreateInfo.stage = ShaderStages[0];
+            PipelineCreateInfo.layout = Entry->Pipeline.Layout;
+            VkCheckResult(vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, 0, &Entry->Pipeline.Handle));
+        } break;
+
+        default:
+        {
+            InvalidCodePath;
+        } break;
+    }
+
+    for (u32 ShaderId = 0; ShaderId < Entry->NumShaders; ++ShaderId)
+    {
+        vkDestroyShaderModule(Device, ShaderModules[ShaderId], 0);
+    }
+}
+
+internal DWORD WINAPI VkPipelineWarmupThreadEntry(LPVOID Param)
+{
+    vk_pipeline_warmup_thread* Thread = (vk_pipeline_warmup_thread*)Param;
+    vk_pipeline_warmup_queue* Queue = Thread->Queue;
+
+    while (true)
+    {
+        u32 JobId = u32(InterlockedIncrement(&Queue->NextJobId) - 1);
+        if (JobId >= Queue->NumJobs)
+        {
+            break;
+        }
+
+        VkPipelineEntryBuild(Queue->Device, &Thread->Arena, &Queue->Jobs[JobId].Entry);
+    }
+
+    return 0;
+}
+
+inline void VkPipelineManifestSave(vk_pipeline_manager* Manager, linear_arena* TempArena, char* FileName)
+{
+    temp_mem TempMem = BeginTempMem(TempArena);
+
+    mm BufferSize = MegaBytes(4);
+    vk_manifest_writer Writer = VkManifestWriterCreate(PushArray(TempArena, u8, BufferSize), BufferSize);
+    
+    vk_pipeline_manifest_header Header = {};
+    Header.Magic = VK_PIPELINE_MANIFEST_MAGIC;
+    Header.Version = VK_PIPELINE_MANIFEST_VERSION;
+    Header.VkHeaderVersion = VK_HEADER_VERSION;
+    Header.NumRenderPasses = Manager->NumRenderPassDescs;
+    Header.NumDescriptorLayouts = Manager->NumDescriptorLayoutDescs;
+    VkManifestWrite(&Writer, Header);
+
+    for (u32 DescId = 0; DescId < Manager->NumRenderPassDescs; ++DescId)
+    {
+        vk_render_pass_desc* Desc = Manager->RenderPassDescs + DescId;
+        VkManifestWrite(&Writer, Desc->Size);
+        VkManifestWriteSize(&Writer, Desc->Data, Desc->Size);
+    }
+    
+    for (u32 DescId = 0; DescId < Manager->NumDescriptorLayoutDescs; ++DescId)
+    {
+        vk_descriptor_layout_desc* Desc = Manager->DescriptorLayoutDescs + DescId;
+        VkManifestWrite(&Writer, Desc->Size);
+        VkManifestWriteSize(&Writer, Desc->Data, Desc->Size);
+    }
+
+    for (u32 PipelineId = 0; PipelineId < Manager->NumPipelines; ++PipelineId)
+    {
+        // NOTE: Each entry is prefixed by its size, we patch it after serializing
+        u8* SizePtr = Writer.At;
+        u32 Size = 0;
+        VkManifestWrite(&Writer, Size);
+
+        if (VkPipelineEntrySerialize(Manager, &Writer, Manager->PipelineArray + PipelineId))
+        {
+            Size = u32(Writer.At - SizePtr) - sizeof(Size);
+            Copy(&Size, SizePtr, sizeof(Size));
+            Header.NumPipelines += 1;
+        }
+        else
+        {
+            Writer.At = SizePtr;
+        }
+    }
+
+    // NOTE: Patch the header now that we know how many pipelines got serialized
+    Copy(&Header, Writer.Start, sizeof(Header));
+
+    HANDLE File = CreateFileA(FileName, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        DWORD Error = GetLastError();
+        InvalidCodePath;
+    }
+
+    DWORD BytesWritten = 0;
+    if (!WriteFile(File, Writer.Start, VkManifestWriterGetSize(&Writer), &BytesWritten, 0))
+    {
+        DWORD Error = GetLastError();
+        InvalidCodePath;
+    }
+    CloseHandle(File);
+    
+    EndTempMem(TempMem);
+}
+
+inline b32 VkPipelineManifestPrebuild(VkDevice Device, vk_pipeline_manager* Manager, linear_arena* TempArena, char* FileName,
+                                      u32 NumThreads)
+{
+    // NOTE: Returns false if there was no usable manifest, pipelines then get created lazily as before
+    b32 Result = false;
+    temp_mem TempMem = BeginTempMem(TempArena);
+
+    u8* FileData = 0;
+    u32 FileSize = 0;
+    HANDLE File = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (File != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER FileSizeEx = {};
+        if (GetFileSizeEx(File, &FileSizeEx) && FileSizeEx.HighPart == 0 && FileSizeEx.LowPart >= sizeof(vk_pipeline_manifest_header))
+        {
+            DWORD BytesRead = 0;
+            FileSize = FileSizeEx.LowPart;
+            FileData = PushArray(TempArena, u8, FileSize);
+            if (!ReadFile(File, FileData, FileSize, &BytesRead, 0) || BytesRead != FileSize)
+            {
+                FileData = 0;
+            }
+        }
+        
+        CloseHandle(File);
+    }
+
+    vk_manifest_reader Reader = VkManifestReaderCreate(FileData, FileData ? FileSize : 0);
+    vk_pipeline_manifest_header* Header = FileData ? VkManifestReadArray(&Reader, vk_pipeline_manifest_header, 1) : 0;
+    if (Header &&
+        Header->Magic == VK_PIPELINE_MANIFEST_MAGIC &&
+        Header->Version == VK_PIPELINE_MANIFEST_VERSION &&
+        Header->VkHeaderVersion == VK_HEADER_VERSION)
+    {
+        // NOTE: Recreate render passes and layouts that are compatible with the ones our pipelines were built with
+        for (u32 RenderPassId = 0; RenderPassId < Header->NumRenderPasses; ++RenderPassId)
+        {
+            u32 Size = VkManifestRead(&Reader, u32);
+            u8* Data = VkManifestReadArray(&Reader, u8, Size);
+            if (!VkPipelineRenderPassDescFind(Manager, VkHashBytes(VK_HASH_INIT, Data, Size)))
+            {
+                vk_manifest_reader DescReader = VkManifestReaderCreate(Data, Size);
+                VkRenderPass RenderPass = VkManifestReadRenderPass(Device, TempArena, &DescReader);
+                VkPipelineRenderPassDescAdd(Manager, RenderPass, Data, Size);
+            }
+        }
+
+        for (u32 LayoutId = 0; LayoutId < Header->NumDescriptorLayouts; ++LayoutId)
+        {
+            u32 Size = VkManifestRead(&Reader, u32);
+            u8* Data = VkManifestReadArray(&Reader, u8, Size);
+            if (!VkPipelineDescriptorLayoutDescFind(Manager, VkHashBytes(VK_HASH_INIT, Data, Size)))
+            {
+                vk_manifest_reader DescReader = VkManifestReaderCreate(Data, Size);
+                VkDescriptorSetLayout Layout = VkManifestReadDescriptorLayout(Device, TempArena, &DescReader);
+                VkPipelineDescriptorLayoutDescAdd(Manager, Layout, Data, Size);
+            }
+        }
+
+        vk_pipeline_warmup_queue Queue = {};
+        Queue.Device = Device;
+        Queue.Jobs = PushArray(TempArena, vk_pipeline_warmup_job, Header->NumPipelines);
+        for (u32 PipelineId = 0; PipelineId < Header->NumPipelines; ++PipelineId)
+        {
+            u32 Size = VkManifestRead(&Reader, u32);
+            u8* Data = VkManifestReadArray(&Reader, u8, Size);
+
+            vk_pipeline_warmup_job* Job = Queue.Jobs + Queue.NumJobs;
+            vk_manifest_reader EntryReader = VkManifestReaderCreate(Data, Size);
+            if (VkManifestReadPipelineEntry(Device, Manager, TempArena, &EntryReader, &Job->Entry))
+            {
+                // NOTE: Serializing the same state at runtime produces the same bytes, so the hashes line up
+                Job->StateHash = VkHashBytes(VK_HASH_INIT, Data, Size);
+                Queue.NumJobs += 1;
+            }
+        }
+
+        // NOTE: Build all pipelines in parallel, each thread gets its own arena for loading shader code
+        NumThreads = Max(1u, Min(NumThreads, u32(MAXIMUM_WAIT_OBJECTS)));
+        vk_pipeline_warmup_thread* Threads = PushArray(TempArena, vk_pipeline_warmup_thread, NumThreads);
+        HANDLE* ThreadHandles = PushArray(TempArena, HANDLE, NumThreads);
+        for (u32 ThreadId = 0; ThreadId < NumThreads; ++ThreadId)
+        {
+            Threads[ThreadId].Queue = &Queue;
+            Threads[ThreadId].Arena = LinearSubArena(TempArena, MegaBytes(4));
+            ThreadHandles[ThreadId] = CreateThread(0, 0, VkPipelineWarmupThreadEntry, Threads + ThreadId, 0, 0);
+            Assert(ThreadHandles[ThreadId]);
+        }
+
+        WaitForMultipleObjects(NumThreads, ThreadHandles, TRUE, INFINITE);
+        for (u32 ThreadId = 0; ThreadId < NumThreads; ++ThreadId)
+        {
+            CloseHandle(ThreadHandles[ThreadId]);
+        }
+
+        // NOTE: Built pipelines get claimed when the app creates a pipeline with the same state
+        for (u32 JobId = 0; JobId < Queue.NumJobs; ++JobId)
+        {
+            vk_pipeline_warmup_job* Job = Queue.Jobs + JobId;
+            
+            Assert(Manager->NumWarmPipelines < Manager->MaxNumPipelines);
+            vk_pipeline_warm_entry* WarmEntry = Manager->WarmPipelineArray + Manager->NumWarmPipelines++;
+            *WarmEntry = {};
+            WarmEntry->StateHash = Job->StateHash;
+            WarmEntry->Pipeline = Job->Entry.Pipeline;
+            for (u32 ShaderId = 0; ShaderId < Job->Entry.NumShaders; ++ShaderId)
+            {
+                WarmEntry->ModifiedTimes[ShaderId] = Job->Entry.ShaderRefs[ShaderId].ModifiedTime;
+            }
+        }
+
+        Result = true;
+    }
+
+    EndTempMem(TempMem);
+
+    return Result;
+}
+
+inline void VkPipelineWarmCacheDestroy(vk_pipeline_manager* Manager, VkDevice Device)
+{
+    // NOTE: Claimed pipelines belong to their entries now, anything left unclaimed was built for state the app never
+    // asked for. Call once all pipelines got created, or at shutdown
+    for (u32 WarmId = 0; WarmId < Manager->NumWarmPipelines; ++WarmId)
+    {
+        vk_pipeline_warm_entry* WarmEntry = Manager->WarmPipelineArray + WarmId;
+        if (!WarmEntry->Claimed)
+        {
+            vkDestroyPipeline(Device, WarmEntry->Pipeline.Handle, 0);
+            vkDestroyPipelineLayout(Device, WarmEntry->Pipeline.Layout, 0);
+        }
+    }
+
+    Manager->NumWarmPipelines = 0;
+}
+
 //
 // NOTE: Graphics Pipeline Builder
 //
@@ -403,12 +1903,14 @@ inline vk_pipeline_builder VkPipelineBuilderBegin(linear_arena* Arena)
     return Result;
 }
 
-inline void VkPipelineShaderAdd(vk_pipeline_builder* Builder, char* FileName, char* MainName, VkShaderStageFlagBits Stage)
+inline void VkPipelineShaderAdd(vk_pipeline_builder* Builder, char* FileName, char* MainName, VkShaderStageFlagBits Stage,
+                                char* Defines = 0)
 {
     Assert(Builder->NumShaders < ArrayCount(Builder->Shaders));
     vk_pipeline_builder_shader* Shader = Builder->Shaders + Builder->NumShaders++;
     Shader->FileName = FileName;
     Shader->MainName = MainName;
+    Shader->Defines = Defines;
     Shader->Stage = Stage;
 }
 
@@ -459,6 +1961,32 @@ inline void VkPipelineVertexAttributeAddOffset(vk_pipeline_builder* Builder, u32
     Builder->CurrVertexBindingSize += Offset;
 }
 
+inline void VkPipelineVertexLayoutAdd(vk_pipeline_builder* Builder, const vk_vertex_layout* Layout,
+                                      VkVertexInputRate InputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+{
+    // NOTE: Layout is built at compile time, we only rebase the binding and locations into the builder arrays
+    Assert(Layout->IsValid);
+    Assert(Builder->NumVertexBindings < Builder->MaxNumVertexBindings);
+    Assert((Builder->NumVertexAttributes + Layout->NumAttributes) <= Builder->MaxNumVertexAttributes);
+
+    u32 BindingId = Builder->NumVertexBindings++;
+    VkVertexInputBindingDescription* VertexBinding = Builder->VertexBindings + BindingId;
+    VertexBinding->binding = BindingId;
+    VertexBinding->stride = Layout->Stride;
+    VertexBinding->inputRate = InputRate;
+
+    VkVertexInputAttributeDescription* VertexAttributes = Builder->VertexAttributes + Builder->NumVertexAttributes;
+    Copy((void*)Layout->Attributes, VertexAttributes, sizeof(VkVertexInputAttributeDescription)*Layout->NumAttributes);
+    for (u32 AttributeId = 0; AttributeId < Layout->NumAttributes; ++AttributeId)
+    {
+        VertexAttributes[AttributeId].location += Builder->CurrVertexLocation;
+        VertexAttributes[AttributeId].binding = BindingId;
+    }
+    
+    Builder->NumVertexAttributes += Layout->NumAttributes;
+    Builder->CurrVertexLocation += Layout->NumAttributes;
+}
+
 inline void VkPipelineInputAssemblyAdd(vk_pipeline_builder* Builder, VkPrimitiveTopology Topology, VkBool32 PrimRestart)
 {
     Builder->InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
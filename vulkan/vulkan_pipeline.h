@@ -1,5 +1,22 @@
 #pragma once
 
+// NOTE: Define VK_SHADER_COMPILER as 1 to compile glsl/hlsl shaders at runtime (requires shaderc)
+#ifndef VK_SHADER_COMPILER
+#define VK_SHADER_COMPILER 0
+#endif
+
+#if VK_SHADER_COMPILER
+#include "shaderc\shaderc.h"
+#endif
+
+// NOTE: Compiled shaders get cached here, keyed by the hash of their source, includes and defines
+#ifndef VK_SHADER_CACHE_DIR
+#define VK_SHADER_CACHE_DIR "shader_cache\\"
+#endif
+
+#define VK_MAX_SHADER_INCLUDES 16
+#define VK_MAX_SHADER_PATH 256
+
 //
 // NOTE: Pipeline Manager
 //
@@ -8,14 +25,28 @@ struct vk_pipeline
 {
     VkPipeline Handle;
     VkPipelineLayout Layout;
+
+    // NOTE: Bumped every time Handle gets recreated, the driver can hand out the old handle value again
+    u32 Generation;
+};
+
+struct vk_shader_include
+{
+    char FileName[VK_MAX_SHADER_PATH];
+    FILETIME ModifiedTime;
 };
 
 struct vk_shader_ref
 {
     char* FileName;
     char* MainName;
+    char* Defines;
     FILETIME ModifiedTime;
     VkShaderStageFlagBits Stage;
+
+    // NOTE: Only used for shaders that we compile from source, changes to includes trigger a reload
+    u32 NumIncludes;
+    vk_shader_include* Includes;
 };
 
 enum vk_pipeline_entry_type
@@ -72,9 +103,96 @@ struct vk_pipeline_entry
     u32 NumShaders;
     vk_shader_ref ShaderRefs[VK_MAX_PIPELINE_STAGES];
 
+    // NOTE: Layout data, kept so that we can serialize the entry
+    u32 NumSetLayouts;
+    VkDescriptorSetLayout* SetLayouts;
+    u32 NumPushConstantRanges;
+    VkPushConstantRange* PushConstantRanges;
+
     vk_pipeline Pipeline;
 };
 
+//
+// NOTE: Pipeline Manifest
+//
+
+#define VK_PIPELINE_MANIFEST_MAGIC 0x4D504B56 // NOTE: "VKPM"
+#define VK_PIPELINE_MANIFEST_VERSION 3
+
+struct vk_pipeline_manifest_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 VkHeaderVersion;
+    u32 NumRenderPasses;
+    u32 NumDescriptorLayouts;
+    u32 NumPipelines;
+};
+
+struct vk_manifest_writer
+{
+    u8* Start;
+    u8* At;
+    u8* End;
+};
+
+struct vk_manifest_reader
+{
+    u8* At;
+    u8* End;
+};
+
+// NOTE: Handles change between runs so pipelines reference render passes and layouts by the hash of their description
+struct vk_render_pass_desc
+{
+    VkRenderPass Handle;
+    u64 Hash;
+    u32 Size;
+
+    // NOTE: Re-registering a handle reuses Data if it fits, the manager's arena never frees
+    u32 Capacity;
+    u8* Data;
+};
+
+struct vk_descriptor_layout_desc
+{
+    VkDescriptorSetLayout Handle;
+    u64 Hash;
+    u32 Size;
+
+    // NOTE: Re-registering a handle reuses Data if it fits, the manager's arena never frees
+    u32 Capacity;
+    u8* Data;
+};
+
+struct vk_pipeline_warm_entry
+{
+    u64 StateHash;
+    b32 Claimed;
+    vk_pipeline Pipeline;
+    FILETIME ModifiedTimes[VK_MAX_PIPELINE_STAGES];
+};
+
+struct vk_pipeline_warmup_job
+{
+    vk_pipeline_entry Entry;
+    u64 StateHash;
+};
+
+struct vk_pipeline_warmup_queue
+{
+    VkDevice Device;
+    volatile LONG NextJobId;
+    u32 NumJobs;
+    vk_pipeline_warmup_job* Jobs;
+};
+
+struct vk_pipeline_warmup_thread
+{
+    vk_pipeline_warmup_queue* Queue;
+    linear_arena Arena;
+};
+
 struct vk_pipeline_manager
 {
     linear_arena Arena;
@@ -82,8 +200,134 @@ struct vk_pipeline_manager
     u32 MaxNumPipelines;
     u32 NumPipelines;
     vk_pipeline_entry* PipelineArray;
+
+    // NOTE: Manifest data
+    u32 MaxNumRenderPassDescs;
+    u32 NumRenderPassDescs;
+    vk_render_pass_desc* RenderPassDescs;
+
+    u32 MaxNumDescriptorLayoutDescs;
+    u32 NumDescriptorLayoutDescs;
+    vk_descriptor_layout_desc* DescriptorLayoutDescs;
+
+    u32 NumWarmPipelines;
+    vk_pipeline_warm_entry* WarmPipelineArray;
+};
+
+//
+// NOTE: Vertex Layout
+//
+
+/*
+   NOTE: Vertex layouts get derived from the vertex struct at compile time so strides and offsets can't drift from the
+         C++ definition. Usage:
+
+         struct model_vertex
+         {
+             v3 Pos;
+             v3 Normal;
+             vk_unorm8x4 Color;
+         };
+
+         constexpr vk_vertex_layout ModelVertexLayout = VK_VERTEX_LAYOUT(model_vertex,
+                                                                         VK_VERTEX_ATTRIBUTE(model_vertex, Pos),
+                                                                         VK_VERTEX_ATTRIBUTE(model_vertex, Normal),
+                                                                         VK_VERTEX_ATTRIBUTE(model_vertex, Color));
+         static_assert(ModelVertexLayout.IsValid && ModelVertexLayout.PaddingSize == 0, "Bad vertex layout");
+*/
+
+// NOTE: Wrapper types for packed and normalized attributes, the format can't be derived from the storage type alone
+struct vk_unorm8x4 { u32 Packed; };
+struct vk_snorm8x4 { u32 Packed; };
+struct vk_unorm16x2 { u32 Packed; };
+struct vk_snorm16x2 { u32 Packed; };
+struct vk_unorm16x4 { u64 Packed; };
+struct vk_snorm16x4 { u64 Packed; };
+struct vk_f16x2 { u32 Packed; };
+struct vk_f16x4 { u64 Packed; };
+struct vk_unorm10x3 { u32 Packed; }; // NOTE: A2B10G10R10, alpha bits are ignored
+struct vk_snorm10x3 { u32 Packed; };
+
+// NOTE: No default, attributes with a type that isn't listed here fail to compile
+template<typename T> struct vk_vertex_format;
+#define VK_VERTEX_FORMAT(Type, Format) template<> struct vk_vertex_format<Type> { static constexpr VkFormat Value = Format; }
+
+VK_VERTEX_FORMAT(f32, VK_FORMAT_R32_SFLOAT);
+VK_VERTEX_FORMAT(v2, VK_FORMAT_R32G32_SFLOAT);
+VK_VERTEX_FORMAT(v3, VK_FORMAT_R32G32B32_SFLOAT);
+VK_VERTEX_FORMAT(v4, VK_FORMAT_R32G32B32A32_SFLOAT);
+VK_VERTEX_FORMAT(u32, VK_FORMAT_R32_UINT);
+VK_VERTEX_FORMAT(i32, VK_FORMAT_R32_SINT);
+VK_VERTEX_FORMAT(vk_unorm8x4, VK_FORMAT_R8G8B8A8_UNORM);
+VK_VERTEX_FORMAT(vk_snorm8x4, VK_FORMAT_R8G8B8A8_SNORM);
+VK_VERTEX_FORMAT(vk_unorm16x2, VK_FORMAT_R16G16_UNORM);
+VK_VERTEX_FORMAT(vk_snorm16x2, VK_FORMAT_R16G16_SNORM);
+VK_VERTEX_FORMAT(vk_unorm16x4, VK_FORMAT_R16G16B16A16_UNORM);
+VK_VERTEX_FORMAT(vk_snorm16x4, VK_FORMAT_R16G16B16A16_SNORM);
+VK_VERTEX_FORMAT(vk_f16x2, VK_FORMAT_R16G16_SFLOAT);
+VK_VERTEX_FORMAT(vk_f16x4, VK_FORMAT_R16G16B16A16_SFLOAT);
+VK_VERTEX_FORMAT(vk_unorm10x3, VK_FORMAT_A2B10G10R10_UNORM_PACK32);
+VK_VERTEX_FORMAT(vk_snorm10x3, VK_FORMAT_A2B10G10R10_SNORM_PACK32);
+
+struct vk_vertex_attribute
+{
+    VkFormat Format;
+    u32 Offset;
+    u32 Size;
+};
+
+#define VK_VERTEX_ATTRIBUTE(Type, Member) vk_vertex_attribute{ vk_vertex_format<decltype(Type::Member)>::Value, u32(offsetof(Type, Member)), u32(sizeof(Type::Member)) }
+
+#define VK_MAX_VERTEX_LAYOUT_ATTRIBUTES 16
+struct vk_vertex_layout
+{
+    u32 Stride;
+    u32 NumAttributes;
+
+    // NOTE: Stored as binding 0 with locations starting at 0, the builder rebases them when the layout is added
+    VkVertexInputAttributeDescription Attributes[VK_MAX_VERTEX_LAYOUT_ATTRIBUTES];
+
+    // NOTE: Bytes in the stride that no attribute reads, and whether any attribute overlaps another or the stride
+    u32 PaddingSize;
+    b32 IsValid;
 };
 
+template<u32 N>
+constexpr vk_vertex_layout VkVertexLayoutCreate(u32 Stride, const vk_vertex_attribute (&Attributes)[N])
+{
+    static_assert(N <= VK_MAX_VERTEX_LAYOUT_ATTRIBUTES, "Too many vertex attributes");
+    
+    vk_vertex_layout Result = {};
+    Result.Stride = Stride;
+    Result.NumAttributes = N;
+    Result.IsValid = true;
+
+    u32 UsedSize = 0;
+    for (u32 AttributeId = 0; AttributeId < N; ++AttributeId)
+    {
+        const vk_vertex_attribute& Attribute = Attributes[AttributeId];
+        Result.Attributes[AttributeId].location = AttributeId;
+        Result.Attributes[AttributeId].binding = 0;
+        Result.Attributes[AttributeId].format = Attribute.Format;
+        Result.Attributes[AttributeId].offset = Attribute.Offset;
+
+        UsedSize += Attribute.Size;
+        Result.IsValid = Result.IsValid && (Attribute.Offset + Attribute.Size) <= Stride;
+        for (u32 OtherId = 0; OtherId < AttributeId; ++OtherId)
+        {
+            const vk_vertex_attribute& Other = Attributes[OtherId];
+            b32 Overlaps = Attribute.Offset < (Other.Offset + Other.Size) && Other.Offset < (Attribute.Offset + Attribute.Size);
+            Result.IsValid = Result.IsValid && !Overlaps;
+        }
+    }
+
+    Result.PaddingSize = UsedSize <= Stride ? Stride - UsedSize : 0;
+    
+    return Result;
+}
+
+#define VK_VERTEX_LAYOUT(Type, ...) VkVertexLayoutCreate(u32(sizeof(Type)), { __VA_ARGS__ })
+
 //
 // NOTE: Pipline Builder
 //
@@ -97,6 +341,7 @@ struct vk_pipeline_builder_shader
 {
     char* FileName;
     char* MainName;
+    char* Defines;
     VkShaderStageFlagBits Stage;
 };
 
@@ -0,0 +1,570 @@
+
+//
+// NOTE: GPU Profiler
+//
+
+inline vk_gpu_profiler* VkGpuProfilerCreate(linear_arena* Arena, VkDevice Device, u32 NumFrames, f32 TimestampPeriod,
+                                            u32 TimestampValidBits)
+{
+    // NOTE: TimestampPeriod is VkPhysicalDeviceLimits::timestampPeriod, ValidBits comes from the queue family we submit on
+    Assert(NumFrames <= VK_PROFILER_MAX_FRAMES);
+
+    vk_gpu_profiler* Result = PushStruct(Arena, vk_gpu_profiler);
+    *Result = {};
+    Result->Enabled = TimestampValidBits > 0;
+    Result->TimestampPeriod = TimestampPeriod;
+    Result->TimestampMask = TimestampValidBits >= 64 ? 0xFFFFFFFFFFFFFFFFull : ((1ull << TimestampValidBits) - 1);
+    Result->NumFrames = NumFrames;
+    Result->CurrFrameId = NumFrames - 1;
+
+    for (u32 FrameId = 0; FrameId < NumFrames && Result->Enabled; ++FrameId)
+    {
+        VkQueryPoolCreateInfo CreateInfo = {};
+        CreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        CreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        CreateInfo.queryCount = VK_PROFILER_MAX_SCOPES * 2;
+        VkCheckResult(vkCreateQueryPool(Device, &CreateInfo, 0, &Result->Frames[FrameId].QueryPool));
+    }
+
+    return Result;
+}
+
+inline void VkGpuProfilerDestroy(vk_gpu_profiler* Profiler, VkDevice Device)
+{
+    for (u32 FrameId = 0; FrameId < Profiler->NumFrames && Profiler->Enabled; ++FrameId)
+    {
+        vkDestroyQueryPool(Device, Profiler->Frames[FrameId].QueryPool, 0);
+    }
+}
+
+inline u32 VkGpuProfilerNameGet(vk_gpu_profiler* Profiler, char* Name)
+{
+    // NOTE: Names are usually string literals so check pointers before comparing strings
+    u32 Result = 0xFFFFFFFF;
+    for (u32 NameId = 0; NameId < Profiler->NumNames; ++NameId)
+    {
+        char* CurrName = Profiler->Stats[NameId].Name;
+        if (CurrName == Name || strcmp(CurrName, Name) == 0)
+        {
+            Result = NameId;
+            break;
+        }
+    }
+
+    if (Result == 0xFFFFFFFF)
+    {
+        Assert(Profiler->NumNames < VK_PROFILER_MAX_NAMES);
+        Result = Profiler->NumNames++;
+        Profiler->Stats[Result] = {};
+        Profiler->Stats[Result].Name = Name;
+    }
+
+    return Result;
+}
+
+inline i64 VkGpuProfilerTickDelta(vk_gpu_profiler* Profiler, u64 FromTick, u64 ToTick)
+{
+    // NOTE: Ticks wrap at the valid bits of the queue, deltas past half the range are taken as negative
+    u64 Delta = (ToTick - FromTick) & Profiler->TimestampMask;
+    i64 Result = Delta > (Profiler->TimestampMask >> 1) ? -i64((FromTick - ToTick) & Profiler->TimestampMask) : i64(Delta);
+    return Result;
+}
+
+inline b32 VkGpuProfilerResolve(vk_gpu_profiler* Profiler, VkDevice Device, vk_gpu_profiler_frame* Frame)
+{
+    // NOTE: Never waits, returns false if the gpu hasn't written all the queries yet
+    if (!Frame->Pending)
+    {
+        return true;
+    }
+
+    if (Frame->NumQueries > 0)
+    {
+        u64 Timestamps[VK_PROFILER_MAX_SCOPES * 2];
+        VkResult Result = vkGetQueryPoolResults(Device, Frame->QueryPool, 0, Frame->NumQueries, sizeof(u64)*Frame->NumQueries,
+                                                Timestamps, sizeof(u64), VK_QUERY_RESULT_64_BIT);
+        if (Result == VK_NOT_READY)
+        {
+            return false;
+        }
+        VkCheckResult(Result);
+
+        if (!Profiler->HasTraceBase)
+        {
+            Profiler->HasTraceBase = true;
+            Profiler->TraceBaseTick = Timestamps[0] & Profiler->TimestampMask;
+        }
+
+        for (u32 ScopeId = 0; ScopeId < Frame->NumScopes; ++ScopeId)
+        {
+            vk_gpu_scope* Scope = Frame->Scopes + ScopeId;
+            u64 BeginTick = Timestamps[Scope->BeginQuery] & Profiler->TimestampMask;
+            u64 EndTick = Timestamps[Scope->EndQuery] & Profiler->TimestampMask;
+            f64 DurationNs = f64((EndTick - BeginTick) & Profiler->TimestampMask) * f64(Profiler->TimestampPeriod);
+
+            vk_gpu_scope_stats* Stats = Profiler->Stats + Scope->NameId;
+            Stats->Samples[Stats->NextSample] = f32(DurationNs / 1000000.0);
+            Stats->NextSample = (Stats->NextSample + 1) % VK_PROFILER_NUM_SAMPLES;
+            Stats->NumSamples = Min(Stats->NumSamples + 1, u32(VK_PROFILER_NUM_SAMPLES));
+
+            vk_gpu_trace_event* Event = Profiler->TraceEvents + Profiler->NextTraceEvent;
+            Event->NameId = Scope->NameId;
+            Event->Depth = Scope->Depth;
+            Event->FrameId = Frame->FrameId;
+            Event->BeginUs = f64(VkGpuProfilerTickDelta(Profiler, Profiler->TraceBaseTick, BeginTick)) * f64(Profiler->TimestampPeriod) / 1000.0;
+            Event->DurationUs = DurationNs / 1000.0;
+            Profiler->NextTraceEvent = (Profiler->NextTraceEvent + 1) % VK_PROFILER_MAX_TRACE_EVENTS;
+            Profiler->NumTraceEvents = Min(Profiler->NumTraceEvents + 1, u32(VK_PROFILER_MAX_TRACE_EVENTS));
+        }
+    }
+
+    Frame->Pending = false;
+    return true;
+}
+
+inline void VkGpuProfilerPoll(vk_gpu_profiler* Profiler, VkDevice Device)
+{
+    // NOTE: Optional, picks up results earlier than FrameBegin would. The current slot is still being recorded and the
+    // reset of a slot only runs on the gpu, so until its fence signaled the pool can still hold the previous results
+    // marked as available. Slots are walked oldest first so the trace base comes from the earliest frame.
+    for (u32 Offset = 1; Offset < Profiler->NumFrames && Profiler->Enabled; ++Offset)
+    {
+        vk_gpu_profiler_frame* Frame = Profiler->Frames + ((Profiler->CurrFrameId + Offset) % Profiler->NumFrames);
+        if (!Frame->Pending || vkGetFenceStatus(Device, Frame->Fence) != VK_SUCCESS)
+        {
+            continue;
+        }
+
+        VkGpuProfilerResolve(Profiler, Device, Frame);
+    }
+}
+
+inline void VkGpuProfilerFrameBegin(vk_gpu_profiler* Profiler, VkDevice Device, vk_commands* Commands)
+{
+    // IMPORTANT: Call after the fence of Commands signaled and outside of a render pass
+    Commands->Profiler = Profiler->Enabled ? Profiler : 0;
+    if (!Profiler->Enabled)
+    {
+        return;
+    }
+
+    Profiler->CurrFrameId = (Profiler->CurrFrameId + 1) % Profiler->NumFrames;
+    vk_gpu_profiler_frame* Frame = Profiler->Frames + Profiler->CurrFrameId;
+
+    // NOTE: This slot's fence signaled so results are available, if they somehow aren't we drop the frame
+    VkGpuProfilerResolve(Profiler, Device, Frame);
+
+    Frame->Fence = Commands->Fence;
+    Frame->Pending = false;
+    Frame->FrameId = Profiler->FrameCounter++;
+    Frame->NumQueries = 0;
+    Frame->NumScopes = 0;
+    Profiler->StackDepth = 0;
+    vkCmdResetQueryPool(Commands->Buffer, Frame->QueryPool, 0, VK_PROFILER_MAX_SCOPES * 2);
+}
+
+inline void VkGpuScopeBegin(vk_commands* Commands, char* Name)
+{
+    vk_gpu_profiler* Profiler = Commands->Profiler;
+    if (!Profiler)
+    {
+        return;
+    }
+
+    vk_gpu_profiler_frame* Frame = Profiler->Frames + Profiler->CurrFrameId;
+    Assert(Frame->NumScopes < VK_PROFILER_MAX_SCOPES);
+    Assert(Profiler->StackDepth < VK_PROFILER_MAX_DEPTH);
+
+    u32 ScopeId = Frame->NumScopes++;
+    vk_gpu_scope* Scope = Frame->Scopes + ScopeId;
+    Scope->NameId = VkGpuProfilerNameGet(Profiler, Name);
+    Scope->Depth = Profiler->StackDepth;
+    Scope->BeginQuery = Frame->NumQueries++;
+    Profiler->ScopeStack[Profiler->StackDepth++] = ScopeId;
+    Frame->Pending = true;
+
+    vkCmdWriteTimestamp(Commands->Buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Frame->QueryPool, Scope->BeginQuery);
+}
+
+inline void VkGpuScopeEnd(vk_commands* Commands)
+{
+    vk_gpu_profiler* Profiler = Commands->Profiler;
+    if (!Profiler)
+    {
+        return;
+    }
+
+    vk_gpu_profiler_frame* Frame = Profiler->Frames + Profiler->CurrFrameId;
+    Assert(Profiler->StackDepth > 0);
+
+    vk_gpu_scope* Scope = Frame->Scopes + Profiler->ScopeStack[--Profiler->StackDepth];
+    Scope->EndQuery = Frame->NumQueries++;
+
+    vkCmdWriteTimestamp(Commands->Buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Frame->QueryPool, Scope->EndQuery);
+}
+
+struct vk_gpu_scope_block
+{
+    vk_commands* Commands;
+
+    vk_gpu_scope_block(vk_commands* InCommands, char* Name)
+    {
+        Commands = InCommands;
+        VkGpuScopeBegin(Commands, Name);
+    }
+
+    ~vk_gpu_scope_block()
+    {
+        VkGpuScopeEnd(Commands);
+    }
+};
+
+#define VK_GPU_SCOPE_CONCAT_(A, B) A##B
+#define VK_GPU_SCOPE_CONCAT(A, B) VK_GPU_SCOPE_CONCAT_(A, B)
+#define VK_GPU_SCOPE(Commands, Name) vk_gpu_scope_block VK_GPU_SCOPE_CONCAT(GpuScope_, __LINE__)(Commands, Name)
+
+//
+// NOTE: GPU Profiler Stats
+//
+
+inline vk_gpu_percentiles VkPercentilesCompute(f32* Samples, u32 NumSamples)
+{
+    // NOTE: Sorts Samples in place, insertion sort is fine for the thousand or so samples our rings hold
+    vk_gpu_percentiles Result = {};
+
+    if (NumSamples > 0)
+    {
+        for (u32 SampleId = 1; SampleId < NumSamples; ++SampleId)
+        {
+            f32 Sample = Samples[SampleId];
+            i32 InsertId = i32(SampleId) - 1;
+            while (InsertId >= 0 && Samples[InsertId] > Sample)
+            {
+                Samples[InsertId + 1] = Samples[InsertId];
+                InsertId -= 1;
+            }
+            Samples[InsertId + 1] = Sample;
+        }
+
+        u32 LastId = NumSamples - 1;
+        Result.P50 = Samples[u32(f32(LastId) * 0.50f)];
+        Result.P95 = Samples[u32(f32(LastId) * 0.95f)];
+        Result.P99 = Samples[u32(f32(LastId) * 0.99f)];
+    }
+
+    return Result;
+}
+
+inline vk_gpu_percentiles VkGpuScopeStatsGet(vk_gpu_profiler* Profiler, char* Name)
+{
+    // NOTE: Sort a copy, the ring keeps its order so new samples keep replacing the oldest
+    vk_gpu_scope_stats* Stats = Profiler->Stats + VkGpuProfilerNameGet(Profiler, Name);
+    f32 Sorted[VK_PROFILER_NUM_SAMPLES];
+    Copy(Stats->Samples, Sorted, sizeof(f32) * Stats->NumSamples);
+
+    vk_gpu_percentiles Result = VkPercentilesCompute(Sorted, Stats->NumSamples);
+    return Result;
+}
+
+inline void VkGpuProfilerTraceWrite(vk_gpu_profiler* Profiler, linear_arena* TempArena, char* FileName)
+{
+    // NOTE: Chrome trace event format, load it in chrome://tracing or perfetto
+    temp_mem TempMem = BeginTempMem(TempArena);
+
+    mm MaxEventSize = 256;
+    mm BufferSize = MaxEventSize * (Profiler->NumTraceEvents + 1);
+    char* Buffer = PushArray(TempArena, char, BufferSize);
+    mm Used = 0;
+
+    Used += snprintf(Buffer + Used, BufferSize - Used, "{\"traceEvents\":[\n");
+    u32 FirstEvent = (Profiler->NextTraceEvent + VK_PROFILER_MAX_TRACE_EVENTS - Profiler->NumTraceEvents) % VK_PROFILER_MAX_TRACE_EVENTS;
+    for (u32 EventId = 0; EventId < Profiler->NumTraceEvents; ++EventId)
+    {
+        vk_gpu_trace_event* Event = Profiler->TraceEvents + ((FirstEvent + EventId) % VK_PROFILER_MAX_TRACE_EVENTS);
+        Used += snprintf(Buffer + Used, BufferSize - Used,
+                         "{\"name\":\"%.128s\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}%s\n",
+                         Profiler->Stats[Event->NameId].Name, Event->Depth, Event->BeginUs, Event->DurationUs, Event->FrameId,
+                         EventId + 1 < Profiler->NumTraceEvents ? "," : "");
+    }
+    Used += snprintf(Buffer + Used, BufferSize - Used, "]}\n");
+    Assert(Used < BufferSize);
+
+    HANDLE File = CreateFileA(FileName, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        DWORD Error = GetLastError();
+        InvalidCodePath;
+    }
+
+    DWORD BytesWritten = 0;
+    if (!WriteFile(File, Buffer, DWORD(Used), &BytesWritten, 0))
+    {
+        DWORD Error = GetLastError();
+        InvalidCodePath;
+    }
+    CloseHandle(File);
+
+    EndTempMem(TempMem);
+}
+
+//
+// NOTE: Query Allocator
+//
+
+#define VK_QUERY_STATISTICS_FLAGS (VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | \
+                                   VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | \
+                                   VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT | \
+                                   VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT)
+
+inline vk_query_allocator* VkQueryAllocatorCreate(linear_arena* Arena, VkDevice Device, u32 NumFrames, u32 ReadbackTypeId,
+                                                  b32 StatisticsEnabled)
+{
+    // NOTE: ReadbackTypeId should be host visible, preferably host cached. StatisticsEnabled requires the
+    // pipelineStatisticsQuery device feature
+    Assert(NumFrames <= VK_PROFILER_MAX_FRAMES);
+
+    vk_query_allocator* Result = PushStruct(Arena, vk_query_allocator);
+    *Result = {};
+    Result->StatisticsEnabled = StatisticsEnabled;
+    Result->NumFrames = NumFrames;
+    Result->CurrFrameId = NumFrames - 1;
+
+    u64 ResultSize = sizeof(u64) * VK_QUERY_MAX_OCCLUSION + sizeof(vk_pipeline_stats) * VK_QUERY_MAX_STATISTICS;
+    for (u32 FrameId = 0; FrameId < NumFrames; ++FrameId)
+    {
+        vk_query_frame* Frame = Result->Frames + FrameId;
+
+        {
+            VkQueryPoolCreateInfo CreateInfo = {};
+            CreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            CreateInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+            CreateInfo.queryCount = VK_QUERY_MAX_OCCLUSION;
+            VkCheckResult(vkCreateQueryPool(Device, &CreateInfo, 0, &Frame->OcclusionPool));
+        }
+
+        if (StatisticsEnabled)
+        {
+            VkQueryPoolCreateInfo CreateInfo = {};
+            CreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            CreateInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            CreateInfo.queryCount = VK_QUERY_MAX_STATISTICS;
+            CreateInfo.pipelineStatistics = VK_QUERY_STATISTICS_FLAGS;
+            VkCheckResult(vkCreateQueryPool(Device, &CreateInfo, 0, &Frame->StatisticsPool));
+        }
+
+        Frame->ResultBuffer = VkBufferHandleCreate(Device, VK_BUFFER_USAGE_TRANSFER_DST_BIT, ResultSize);
+        VkMemoryRequirements MemoryRequirements = VkBufferGetMemoryRequirements(Device, Frame->ResultBuffer);
+        Assert(MemoryRequirements.memoryTypeBits & (1 << ReadbackTypeId));
+        Frame->ResultMemory = VkMemoryAllocate(Device, ReadbackTypeId, MemoryRequirements.size);
+        VkCheckResult(vkBindBufferMemory(Device, Frame->ResultBuffer, Frame->ResultMemory, 0));
+        VkCheckResult(vkMapMemory(Device, Frame->ResultMemory, 0, VK_WHOLE_SIZE, 0, (void**)&Frame->ResultPtr));
+    }
+
+    return Result;
+}
+
+inline void VkQueryAllocatorDestroy(vk_query_allocator* Allocator, VkDevice Device)
+{
+    for (u32 FrameId = 0; FrameId < Allocator->NumFrames; ++FrameId)
+    {
+        vk_query_frame* Frame = Allocator->Frames + FrameId;
+        vkDestroyQueryPool(Device, Frame->OcclusionPool, 0);
+        if (Allocator->StatisticsEnabled)
+        {
+            vkDestroyQueryPool(Device, Frame->StatisticsPool, 0);
+        }
+        vkDestroyBuffer(Device, Frame->ResultBuffer, 0);
+        vkUnmapMemory(Device, Frame->ResultMemory);
+        vkFreeMemory(Device, Frame->ResultMemory, 0);
+    }
+}
+
+inline u32 VkQueryAllocatorNameGet(vk_query_allocator* Allocator, char* Name)
+{
+    u32 Result = 0xFFFFFFFF;
+    for (u32 NameId = 0; NameId < Allocator->NumNames; ++NameId)
+    {
+        char* CurrName = Allocator->NameStats[NameId].Name;
+        if (CurrName == Name || strcmp(CurrName, Name) == 0)
+        {
+            Result = NameId;
+            break;
+        }
+    }
+
+    if (Result == 0xFFFFFFFF)
+    {
+        Assert(Allocator->NumNames < VK_QUERY_MAX_NAMES);
+        Result = Allocator->NumNames++;
+        Allocator->NameStats[Result] = {};
+        Allocator->NameStats[Result].Name = Name;
+    }
+
+    return Result;
+}
+
+inline void VkQueryAllocatorResolve(vk_query_allocator* Allocator, VkDevice Device, vk_query_frame* Frame)
+{
+    // NOTE: Only valid once the fence of the frame that recorded the copy signaled
+    if (!Frame->Pending)
+    {
+        return;
+    }
+
+    VkMappedMemoryRange InvalidateRange = {};
+    InvalidateRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    InvalidateRange.memory = Frame->ResultMemory;
+    InvalidateRange.offset = 0;
+    InvalidateRange.size = VK_WHOLE_SIZE;
+    VkCheckResult(vkInvalidateMappedMemoryRanges(Device, 1, &InvalidateRange));
+
+    u64* OcclusionResults = (u64*)Frame->ResultPtr;
+    Copy(OcclusionResults, Allocator->OcclusionResults, sizeof(u64) * Frame->NumOcclusion);
+    Allocator->NumOcclusionResults = Frame->NumOcclusion;
+
+    // NOTE: Scopes with the same name get summed
+    for (u32 NameId = 0; NameId < Allocator->NumNames; ++NameId)
+    {
+        Allocator->NameStats[NameId].Stats = {};
+    }
+
+    vk_pipeline_stats* StatisticsResults = (vk_pipeline_stats*)(Frame->ResultPtr + sizeof(u64) * VK_QUERY_MAX_OCCLUSION);
+    for (u32 QueryId = 0; QueryId < Frame->NumStatistics; ++QueryId)
+    {
+        vk_pipeline_stats* Src = StatisticsResults + QueryId;
+        vk_pipeline_stats* Dst = &Allocator->NameStats[Frame->StatisticsNameIds[QueryId]].Stats;
+        Dst->VertexInvocations += Src->VertexInvocations;
+        Dst->ClippingPrimitives += Src->ClippingPrimitives;
+        Dst->FragmentInvocations += Src->FragmentInvocations;
+        Dst->ComputeInvocations += Src->ComputeInvocations;
+    }
+
+    Allocator->ResolvedFrameId = Frame->FrameId;
+    Frame->Pending = false;
+}
+
+inline void VkQueryAllocatorFrameBegin(vk_query_allocator* Allocator, VkDevice Device, vk_commands* Commands)
+{
+    // IMPORTANT: Call after the fence of Commands signaled and outside of a render pass
+    Allocator->CurrFrameId = (Allocator->CurrFrameId + 1) % Allocator->NumFrames;
+    vk_query_frame* Frame = Allocator->Frames + Allocator->CurrFrameId;
+
+    VkQueryAllocatorResolve(Allocator, Device, Frame);
+
+    Frame->FrameId = Allocator->FrameCounter++;
+    Frame->NumOcclusion = 0;
+    Frame->NumStatistics = 0;
+    vkCmdResetQueryPool(Commands->Buffer, Frame->OcclusionPool, 0, VK_QUERY_MAX_OCCLUSION);
+    if (Allocator->StatisticsEnabled)
+    {
+        vkCmdResetQueryPool(Commands->Buffer, Frame->StatisticsPool, 0, VK_QUERY_MAX_STATISTICS);
+    }
+
+    Commands->Queries = Allocator;
+}
+
+inline void VkQueryAllocatorFrameEnd(vk_commands* Commands)
+{
+    // IMPORTANT: Call outside of a render pass after the last query ended
+    vk_query_allocator* Allocator = Commands->Queries;
+    if (!Allocator)
+    {
+        return;
+    }
+
+    vk_query_frame* Frame = Allocator->Frames + Allocator->CurrFrameId;
+    if (Frame->NumOcclusion == 0 && Frame->NumStatistics == 0)
+    {
+        return;
+    }
+
+    // NOTE: WAIT_BIT makes the gpu wait for the queries, the cpu never does
+    if (Frame->NumOcclusion > 0)
+    {
+        vkCmdCopyQueryPoolResults(Commands->Buffer, Frame->OcclusionPool, 0, Frame->NumOcclusion, Frame->ResultBuffer, 0,
+                                  sizeof(u64), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    }
+    if (Frame->NumStatistics > 0)
+    {
+        vkCmdCopyQueryPoolResults(Commands->Buffer, Frame->StatisticsPool, 0, Frame->NumStatistics, Frame->ResultBuffer,
+                                  sizeof(u64) * VK_QUERY_MAX_OCCLUSION, sizeof(vk_pipeline_stats),
+                                  VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    }
+
+    VkBarrierBufferAdd(Commands, Frame->ResultBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_HOST_READ_BIT, VK_PIPELINE_STAGE_HOST_BIT);
+    VkCommandsBarrierFlush(Commands);
+
+    Frame->Pending = true;
+}
+
+inline u32 VkOcclusionQueryBegin(vk_commands* Commands, b32 Precise = false)
+{
+    // NOTE: Returns the id to look the result up with VkOcclusionQueryGetResult once the frame resolved
+    vk_query_allocator* Allocator = Commands->Queries;
+    if (!Allocator)
+    {
+        return 0xFFFFFFFF;
+    }
+
+    vk_query_frame* Frame = Allocator->Frames + Allocator->CurrFrameId;
+    Assert(Frame->NumOcclusion < VK_QUERY_MAX_OCCLUSION);
+    u32 Result = Frame->NumOcclusion++;
+    vkCmdBeginQuery(Commands->Buffer, Frame->OcclusionPool, Result, Precise ? VK_QUERY_CONTROL_PRECISE_BIT : 0);
+
+    return Result;
+}
+
+inline void VkOcclusionQueryEnd(vk_commands* Commands, u32 QueryId)
+{
+    vk_query_allocator* Allocator = Commands->Queries;
+    if (!Allocator)
+    {
+        return;
+    }
+
+    vk_query_frame* Frame = Allocator->Frames + Allocator->CurrFrameId;
+    vkCmdEndQuery(Commands->Buffer, Frame->OcclusionPool, QueryId);
+}
+
+inline u64 VkOcclusionQueryGetResult(vk_query_allocator* Allocator, u32 QueryId)
+{
+    // NOTE: Samples passed for QueryId in frame ResolvedFrameId, 0 if that frame didn't have the query
+    u64 Result = QueryId < Allocator->NumOcclusionResults ? Allocator->OcclusionResults[QueryId] : 0;
+    return Result;
+}
+
+inline u32 VkStatisticsQueryBegin(vk_commands* Commands, char* Name)
+{
+    vk_query_allocator* Allocator = Commands->Queries;
+    if (!Allocator || !Allocator->StatisticsEnabled)
+    {
+        return 0xFFFFFFFF;
+    }
+
+    vk_query_frame* Frame = Allocator->Frames + Allocator->CurrFrameId;
+    Assert(Frame->NumStatistics < VK_QUERY_MAX_STATISTICS);
+    u32 Result = Frame->NumStatistics++;
+    Frame->StatisticsNameIds[Result] = VkQueryAllocatorNameGet(Allocator, Name);
+    vkCmdBeginQuery(Commands->Buffer, Frame->StatisticsPool, Result, 0);
+
+    return Result;
+}
+
+inline void VkStatisticsQueryEnd(vk_commands* Commands, u32 QueryId)
+{
+    vk_query_allocator* Allocator = Commands->Queries;
+    if (!Allocator || !Allocator->StatisticsEnabled)
+    {
+        return;
+    }
+
+    vk_query_frame* Frame = Allocator->Frames + Allocator->CurrFrameId;
+    vkCmdEndQuery(Commands->Buffer, Frame->StatisticsPool, QueryId);
+}
+
+inline vk_pipeline_stats VkStatisticsQueryGetResult(vk_query_allocator* Allocator, char* Name)
+{
+    vk_pipeline_stats Result = Allocator->NameStats[VkQueryAllocatorNameGet(Allocator, Name)].Stats;
+    return Result;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+//
+// NOTE: GPU Profiler
+//
+
+/*
+   NOTE: Scopes write a timestamp at begin and end into a query pool owned by the current frame in flight. Results are
+         read back without waiting once the slot comes around again (its fence has signaled by then), so profiling
+         never stalls the cpu. Usage:
+
+         - VkGpuProfilerFrameBegin right after acquiring the frame's vk_commands (outside of a render pass)
+         - VkGpuScopeBegin/VkGpuScopeEnd around work, or VK_GPU_SCOPE for a whole block
+         - VkGpuScopeStatsGet for rolling percentiles, VkGpuProfilerTraceWrite for chrome://tracing
+*/
+
+#define VK_PROFILER_MAX_FRAMES 4
+#define VK_PROFILER_MAX_SCOPES 256
+#define VK_PROFILER_MAX_DEPTH 32
+#define VK_PROFILER_MAX_NAMES 64
+#define VK_PROFILER_NUM_SAMPLES 256
+#define VK_PROFILER_MAX_TRACE_EVENTS 8192
+
+struct vk_gpu_scope
+{
+    u32 NameId;
+    u32 Depth;
+    u32 BeginQuery;
+    u32 EndQuery;
+};
+
+struct vk_gpu_profiler_frame
+{
+    VkQueryPool QueryPool;
+    VkFence Fence;
+    b32 Pending;
+    u64 FrameId;
+
+    u32 NumQueries;
+    u32 NumScopes;
+    vk_gpu_scope Scopes[VK_PROFILER_MAX_SCOPES];
+};
+
+struct vk_gpu_scope_stats
+{
+    char* Name;
+
+    // NOTE: Ring buffer of the latest durations in ms
+    u32 NumSamples;
+    u32 NextSample;
+    f32 Samples[VK_PROFILER_NUM_SAMPLES];
+};
+
+struct vk_gpu_percentiles
+{
+    f32 P50;
+    f32 P95;
+    f32 P99;
+};
+
+struct vk_gpu_trace_event
+{
+    u32 NameId;
+    u32 Depth;
+    u64 FrameId;
+    f64 BeginUs;
+    f64 DurationUs;
+};
+
+struct vk_gpu_profiler
+{
+    b32 Enabled;
+    f32 TimestampPeriod;
+    u64 TimestampMask;
+
+    u64 FrameCounter;
+    u32 NumFrames;
+    u32 CurrFrameId;
+    vk_gpu_profiler_frame Frames[VK_PROFILER_MAX_FRAMES];
+
+    u32 StackDepth;
+    u32 ScopeStack[VK_PROFILER_MAX_DEPTH];
+
+    u32 NumNames;
+    vk_gpu_scope_stats Stats[VK_PROFILER_MAX_NAMES];
+
+    // NOTE: Ring buffer of resolved scopes for trace export, timestamps are relative to the first resolved frame and
+    // can be negative if an older frame resolves after it
+    b32 HasTraceBase;
+    u64 TraceBaseTick;
+    u32 NumTraceEvents;
+    u32 NextTraceEvent;
+    vk_gpu_trace_event TraceEvents[VK_PROFILER_MAX_TRACE_EVENTS];
+};
+
+//
+// NOTE: Query Allocator
+//
+
+/*
+   NOTE: Occlusion and pipeline statistics queries pooled per frame in flight. VkQueryAllocatorFrameEnd records
+         vkCmdCopyQueryPoolResults into a host visible buffer so reading results back is just a memory read once the
+         slot comes around again. Statistics queries that cover compute work have to begin and end outside of render
+         passes, occlusion queries have to begin and end inside the same subpass.
+*/
+
+#define VK_QUERY_MAX_OCCLUSION 1024
+#define VK_QUERY_MAX_STATISTICS 64
+#define VK_QUERY_MAX_NAMES 64
+
+// NOTE: Order matches the bit order of the statistics we request, results get written in that order
+struct vk_pipeline_stats
+{
+    u64 VertexInvocations;
+    u64 ClippingPrimitives;
+    u64 FragmentInvocations;
+    u64 ComputeInvocations;
+};
+
+struct vk_query_frame
+{
+    VkQueryPool OcclusionPool;
+    VkQueryPool StatisticsPool;
+
+    // NOTE: Occlusion results followed by statistics results
+    VkBuffer ResultBuffer;
+    VkDeviceMemory ResultMemory;
+    u8* ResultPtr;
+
+    b32 Pending;
+    u64 FrameId;
+
+    u32 NumOcclusion;
+    u32 NumStatistics;
+    u32 StatisticsNameIds[VK_QUERY_MAX_STATISTICS];
+};
+
+struct vk_query_name_stats
+{
+    char* Name;
+    vk_pipeline_stats Stats;
+};
+
+struct vk_query_allocator
+{
+    b32 StatisticsEnabled;
+
+    u64 FrameCounter;
+    u32 NumFrames;
+    u32 CurrFrameId;
+    vk_query_frame Frames[VK_PROFILER_MAX_FRAMES];
+
+    // NOTE: Results of the latest resolved frame, occlusion results are indexed by the id the query got that frame
+    u64 ResolvedFrameId;
+    u32 NumOcclusionResults;
+    u64 OcclusionResults[VK_QUERY_MAX_OCCLUSION];
+
+    u32 NumNames;
+    vk_query_name_stats NameStats[VK_QUERY_MAX_NAMES];
+};
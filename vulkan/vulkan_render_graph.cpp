@@ -0,0 +1,697 @@
+
+//
+// NOTE: Render Graph Helpers
+//
+
+#define VK_RENDER_GRAPH_WRITE_ACCESS (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | \
+                                      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | \
+                                      VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT)
+
+inline b32 VkRenderGraphAccessIsWrite(vk_render_graph_access Access)
+{
+    b32 Result = (Access == VkRgAccess_ColorWrite || Access == VkRgAccess_DepthWrite || Access == VkRgAccess_StorageWrite ||
+                  Access == VkRgAccess_TransferWrite);
+    return Result;
+}
+
+inline b32 VkRenderGraphAccessIsAttachment(vk_render_graph_access Access)
+{
+    b32 Result = Access == VkRgAccess_ColorWrite || Access == VkRgAccess_DepthWrite || Access == VkRgAccess_DepthRead;
+    return Result;
+}
+
+inline vk_render_graph_image_state VkRenderGraphAccessGetState(vk_render_graph_access Access)
+{
+    vk_render_graph_image_state Result = {};
+    switch (Access)
+    {
+        case VkRgAccess_ColorWrite:
+        {
+            Result.Layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            Result.AccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            Result.StageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        } break;
+
+        case VkRgAccess_DepthWrite:
+        {
+            Result.Layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            Result.AccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            Result.StageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        } break;
+
+        case VkRgAccess_DepthRead:
+        {
+            // NOTE: Read only depth can also be sampled in the same pass
+            Result.Layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+            Result.AccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+            Result.StageMask = (VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        } break;
+
+        case VkRgAccess_SampledRead:
+        {
+            Result.Layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            Result.AccessMask = VK_ACCESS_SHADER_READ_BIT;
+            Result.StageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        } break;
+
+        case VkRgAccess_StorageRead:
+        {
+            Result.Layout = VK_IMAGE_LAYOUT_GENERAL;
+            Result.AccessMask = VK_ACCESS_SHADER_READ_BIT;
+            Result.StageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        } break;
+
+        case VkRgAccess_StorageWrite:
+        {
+            Result.Layout = VK_IMAGE_LAYOUT_GENERAL;
+            Result.AccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            Result.StageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        } break;
+
+        case VkRgAccess_TransferRead:
+        {
+            Result.Layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            Result.AccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            Result.StageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        } break;
+
+        case VkRgAccess_TransferWrite:
+        {
+            Result.Layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            Result.AccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Result.StageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        } break;
+
+        default:
+        {
+            InvalidCodePath;
+        } break;
+    }
+
+    return Result;
+}
+
+inline VkImageUsageFlags VkRenderGraphAccessGetUsage(vk_render_graph_access Access)
+{
+    VkImageUsageFlags Result = 0;
+    switch (Access)
+    {
+        case VkRgAccess_ColorWrite: Result = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; break;
+        case VkRgAccess_DepthWrite: Result = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT; break;
+        case VkRgAccess_DepthRead: Result = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT; break;
+        case VkRgAccess_SampledRead: Result = VK_IMAGE_USAGE_SAMPLED_BIT; break;
+        case VkRgAccess_StorageRead: Result = VK_IMAGE_USAGE_STORAGE_BIT; break;
+        case VkRgAccess_StorageWrite: Result = VK_IMAGE_USAGE_STORAGE_BIT; break;
+        case VkRgAccess_TransferRead: Result = VK_IMAGE_USAGE_TRANSFER_SRC_BIT; break;
+        case VkRgAccess_TransferWrite: Result = VK_IMAGE_USAGE_TRANSFER_DST_BIT; break;
+        default: InvalidCodePath;
+    }
+
+    return Result;
+}
+
+//
+// NOTE: Render Graph Setup
+//
+
+inline vk_render_graph* VkRenderGraphCreate(linear_arena* Arena, VkDevice Device, VkPhysicalDeviceMemoryProperties* MemoryProperties,
+                                            vk_render_cache* RenderCache)
+{
+    vk_render_graph* Result = PushStruct(Arena, vk_render_graph);
+    *Result = {};
+    Result->Device = Device;
+    Result->MemoryProperties = MemoryProperties;
+    Result->RenderCache = RenderCache;
+
+    return Result;
+}
+
+inline u32 VkRenderGraphImageAdd(vk_render_graph* Graph, u32 Width, u32 Height, VkFormat Format, VkImageAspectFlags AspectMask,
+                                 VkSampleCountFlagBits SampleCount = VK_SAMPLE_COUNT_1_BIT)
+{
+    Assert(!Graph->Compiled);
+    Assert(Graph->NumImages < VK_RENDER_GRAPH_MAX_IMAGES);
+
+    u32 Result = Graph->NumImages++;
+    vk_render_graph_image* Image = Graph->Images + Result;
+    *Image = {};
+    Image->Width = Width;
+    Image->Height = Height;
+    Image->Format = Format;
+    Image->AspectMask = AspectMask;
+    Image->SampleCount = SampleCount;
+
+    return Result;
+}
+
+inline u32 VkRenderGraphImageImport(vk_render_graph* Graph, VkImage Image, VkImageView View, u32 Width, u32 Height, VkFormat Format,
+                                    VkImageAspectFlags AspectMask, barrier_mask InitialMask, VkImageLayout InitialLayout,
+                                    barrier_mask FinalMask, VkImageLayout FinalLayout)
+{
+    u32 Result = VkRenderGraphImageAdd(Graph, Width, Height, Format, AspectMask);
+    vk_render_graph_image* GraphImage = Graph->Images + Result;
+    GraphImage->Imported = true;
+    GraphImage->Image = Image;
+    GraphImage->View = View;
+
+    GraphImage->InitialState.Layout = InitialLayout;
+    GraphImage->InitialState.AccessMask = InitialMask.AccessMask;
+    GraphImage->InitialState.StageMask = InitialMask.StageMask;
+
+    GraphImage->FinalState.Layout = FinalLayout;
+    GraphImage->FinalState.AccessMask = FinalMask.AccessMask;
+    GraphImage->FinalState.StageMask = FinalMask.StageMask;
+
+    return Result;
+}
+
+inline void VkRenderGraphImportSet(vk_render_graph* Graph, u32 ImageId, VkImage Image, VkImageView View)
+{
+    // NOTE: Lets swapchain images change every frame without recompiling
+    Assert(Graph->Images[ImageId].Imported);
+    Graph->Images[ImageId].Image = Image;
+    Graph->Images[ImageId].View = View;
+}
+
+inline u32 VkRenderGraphPassAdd(vk_render_graph* Graph, char* Name, vk_render_graph_execute* Execute, void* Data)
+{
+    Assert(!Graph->Compiled);
+    Assert(Graph->NumPasses < VK_RENDER_GRAPH_MAX_PASSES);
+
+    u32 Result = Graph->NumPasses++;
+    vk_render_graph_pass* Pass = Graph->Passes + Result;
+    *Pass = {};
+    Pass->Name = Name;
+    Pass->Execute = Execute;
+    Pass->Data = Data;
+
+    return Result;
+}
+
+inline void VkRenderGraphPassUse(vk_render_graph* Graph, u32 PassId, u32 ImageId, vk_render_graph_access Access)
+{
+    vk_render_graph_pass* Pass = Graph->Passes + PassId;
+    Assert(Pass->NumUses < VK_RENDER_GRAPH_MAX_PASS_USES);
+    Assert(ImageId < Graph->NumImages);
+
+    // IMPORTANT: Only one use per image per pass, DepthRead already covers sampling depth while testing against it
+    for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+    {
+        Assert(Pass->Uses[UseId].ImageId != ImageId);
+    }
+
+    vk_render_graph_use* Use = Pass->Uses + Pass->NumUses++;
+    *Use = {};
+    Use->ImageId = ImageId;
+    Use->Access = Access;
+}
+
+inline void VkRenderGraphPassUseClear(vk_render_graph* Graph, u32 PassId, u32 ImageId, vk_render_graph_access Access,
+                                      VkClearValue ClearValue)
+{
+    Assert(Access == VkRgAccess_ColorWrite || Access == VkRgAccess_DepthWrite);
+
+    VkRenderGraphPassUse(Graph, PassId, ImageId, Access);
+    vk_render_graph_pass* Pass = Graph->Passes + PassId;
+    vk_render_graph_use* Use = Pass->Uses + Pass->NumUses - 1;
+    Use->Clear = true;
+    Use->ClearValue = ClearValue;
+}
+
+inline VkRenderPass VkRenderGraphPassGetRenderPass(vk_render_graph* Graph, u32 PassId)
+{
+    // NOTE: Pipelines used inside a pass need to be created against this render pass
+    Assert(Graph->Compiled);
+    VkRenderPass Result = Graph->Passes[PassId].RenderPass;
+    return Result;
+}
+
+inline VkImageView VkRenderGraphImageGetView(vk_render_graph* Graph, u32 ImageId)
+{
+    Assert(Graph->Compiled);
+    VkImageView Result = Graph->Images[ImageId].View;
+    return Result;
+}
+
+//
+// NOTE: Render Graph Compile
+//
+
+inline u32 VkRenderGraphSchedule(vk_render_graph* Graph)
+{
+    // NOTE: Passes depend on the last writer of every image they use, writers also depend on readers since the last write
+    u64 DependencyMasks[VK_RENDER_GRAPH_MAX_PASSES] = {};
+    u64 WriterMasks[VK_RENDER_GRAPH_MAX_PASSES] = {};
+    for (u32 ImageId = 0; ImageId < Graph->NumImages; ++ImageId)
+    {
+        i32 LastWriter = -1;
+        u64 ReaderMask = 0;
+        for (u32 PassId = 0; PassId < Graph->NumPasses; ++PassId)
+        {
+            vk_render_graph_pass* Pass = Graph->Passes + PassId;
+            for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+            {
+                vk_render_graph_use* Use = Pass->Uses + UseId;
+                if (Use->ImageId != ImageId)
+                {
+                    continue;
+                }
+
+                if (LastWriter != -1)
+                {
+                    DependencyMasks[PassId] |= 1ull << LastWriter;
+                }
+
+                if (VkRenderGraphAccessIsWrite(Use->Access))
+                {
+                    DependencyMasks[PassId] |= ReaderMask & ~(1ull << PassId);
+                    WriterMasks[PassId] |= 1ull << ImageId;
+                    LastWriter = PassId;
+                    ReaderMask = 0;
+                }
+                else
+                {
+                    ReaderMask |= 1ull << PassId;
+                }
+            }
+        }
+    }
+
+    // NOTE: Cull passes whose writes nobody reads, imported images and passes without image writes count as side effects
+    u64 LiveMask = 0;
+    u64 NeededImages = 0;
+    for (i32 PassId = Graph->NumPasses - 1; PassId >= 0; --PassId)
+    {
+        vk_render_graph_pass* Pass = Graph->Passes + PassId;
+
+        b32 IsLive = WriterMasks[PassId] == 0 || (WriterMasks[PassId] & NeededImages) != 0;
+        for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+        {
+            IsLive = IsLive || (VkRenderGraphAccessIsWrite(Pass->Uses[UseId].Access) && Graph->Images[Pass->Uses[UseId].ImageId].Imported);
+        }
+
+        if (IsLive)
+        {
+            LiveMask |= 1ull << PassId;
+            for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+            {
+                NeededImages |= 1ull << Pass->Uses[UseId].ImageId;
+            }
+        }
+    }
+
+    // NOTE: Kahn's algorithm, picking the earliest declared ready pass keeps the order stable between compiles
+    u32 NumScheduled = 0;
+    u64 ScheduledMask = ~LiveMask;
+    u32 NumLive = 0;
+    for (u32 PassId = 0; PassId < Graph->NumPasses; ++PassId)
+    {
+        NumLive += (LiveMask >> PassId) & 1;
+    }
+
+    while (NumScheduled < NumLive)
+    {
+        b32 Progress = false;
+        for (u32 PassId = 0; PassId < Graph->NumPasses; ++PassId)
+        {
+            b32 IsScheduled = (ScheduledMask >> PassId) & 1;
+            if (!IsScheduled && (DependencyMasks[PassId] & ~ScheduledMask) == 0)
+            {
+                Graph->PassOrder[NumScheduled++] = PassId;
+                ScheduledMask |= 1ull << PassId;
+                Progress = true;
+                break;
+            }
+        }
+
+        // NOTE: Dependencies only point to earlier passes so we can't have cycles
+        Assert(Progress);
+    }
+
+    return NumScheduled;
+}
+
+inline void VkRenderGraphAllocateImages(vk_render_graph* Graph, u32 NumOrderedPasses)
+{
+    VkDevice Device = Graph->Device;
+
+    // NOTE: Compute lifetimes and usage of every image in execution order
+    for (u32 ImageId = 0; ImageId < Graph->NumImages; ++ImageId)
+    {
+        vk_render_graph_image* Image = Graph->Images + ImageId;
+        Image->FirstPassId = 0xFFFFFFFF;
+        Image->LastPassId = 0;
+        Image->Usage = 0;
+    }
+
+    for (u32 OrderId = 0; OrderId < NumOrderedPasses; ++OrderId)
+    {
+        vk_render_graph_pass* Pass = Graph->Passes + Graph->PassOrder[OrderId];
+        for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+        {
+            vk_render_graph_image* Image = Graph->Images + Pass->Uses[UseId].ImageId;
+            Image->FirstPassId = Min(Image->FirstPassId, OrderId);
+            Image->LastPassId = Max(Image->LastPassId, OrderId);
+            Image->Usage |= VkRenderGraphAccessGetUsage(Pass->Uses[UseId].Access);
+        }
+    }
+
+    // NOTE: Create transient images so we can query their memory requirements
+    u32 NumTransients = 0;
+    u32 TransientIds[VK_RENDER_GRAPH_MAX_IMAGES];
+    u32 MemoryTypeBits = 0xFFFFFFFF;
+    Graph->UnaliasedMemorySize = 0;
+    for (u32 ImageId = 0; ImageId < Graph->NumImages; ++ImageId)
+    {
+        vk_render_graph_image* Image = Graph->Images + ImageId;
+        if (Image->Imported || Image->FirstPassId == 0xFFFFFFFF)
+        {
+            continue;
+        }
+
+        // NOTE: Attachments that live in a single pass never need to hit memory on tilers
+        VkImageUsageFlags AttachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (Image->FirstPassId == Image->LastPassId && (Image->Usage & ~AttachmentUsage) == 0)
+        {
+            Image->Usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+
+        Image->Image = VkImageHandleCreate(Device, Image->Width, Image->Height, Image->Format, Image->Usage, Image->SampleCount);
+        Image->MemoryRequirements = VkImageGetMemoryRequirements(Device, Image->Image);
+        MemoryTypeBits &= Image->MemoryRequirements.memoryTypeBits;
+        Graph->UnaliasedMemorySize += Image->MemoryRequirements.size;
+
+        TransientIds[NumTransients++] = ImageId;
+    }
+
+    // NOTE: Place biggest images first, each image goes to the lowest offset that doesn't overlap an image alive at the same time
+    for (u32 SortId = 0; SortId < NumTransients; ++SortId)
+    {
+        for (u32 OtherId = SortId + 1; OtherId < NumTransients; ++OtherId)
+        {
+            if (Graph->Images[TransientIds[OtherId]].MemoryRequirements.size > Graph->Images[TransientIds[SortId]].MemoryRequirements.size)
+            {
+                u32 Temp = TransientIds[SortId];
+                TransientIds[SortId] = TransientIds[OtherId];
+                TransientIds[OtherId] = Temp;
+            }
+        }
+    }
+
+    Graph->TransientMemorySize = 0;
+    for (u32 PlaceId = 0; PlaceId < NumTransients; ++PlaceId)
+    {
+        vk_render_graph_image* Image = Graph->Images + TransientIds[PlaceId];
+        Image->MemorySize = Image->MemoryRequirements.size;
+        Image->MemoryOffset = 0;
+
+        for (u32 PlacedId = 0; PlacedId < PlaceId; )
+        {
+            vk_render_graph_image* Placed = Graph->Images + TransientIds[PlacedId];
+            b32 LifetimeOverlaps = !(Placed->LastPassId < Image->FirstPassId || Image->LastPassId < Placed->FirstPassId);
+            b32 MemoryOverlaps = (Image->MemoryOffset < Placed->MemoryOffset + Placed->MemorySize &&
+                                  Placed->MemoryOffset < Image->MemoryOffset + Image->MemorySize);
+            if (LifetimeOverlaps && MemoryOverlaps)
+            {
+                // NOTE: Move past this image and recheck everything we placed
+                Image->MemoryOffset = AlignAddress(Placed->MemoryOffset + Placed->MemorySize, Image->MemoryRequirements.alignment);
+                PlacedId = 0;
+            }
+            else
+            {
+                PlacedId += 1;
+            }
+        }
+
+        Graph->TransientMemorySize = Max(Graph->TransientMemorySize, Image->MemoryOffset + Image->MemorySize);
+    }
+
+    // NOTE: Allocate one block for all transients and bind them
+    if (NumTransients > 0)
+    {
+        Assert(MemoryTypeBits != 0);
+        i32 MemoryType = VkGetMemoryType(Graph->MemoryProperties, MemoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        Assert(MemoryType != -1);
+        Graph->TransientMemory = VkMemoryAllocate(Device, MemoryType, Graph->TransientMemorySize);
+    }
+
+    for (u32 PlaceId = 0; PlaceId < NumTransients; ++PlaceId)
+    {
+        vk_render_graph_image* Image = Graph->Images + TransientIds[PlaceId];
+        VkCheckResult(vkBindImageMemory(Device, Image->Image, Graph->TransientMemory, Image->MemoryOffset));
+        Image->View = VkImageViewCreate(Device, Image->Image, VK_IMAGE_VIEW_TYPE_2D, Image->Format, Image->AspectMask, 0, 1);
+
+        // NOTE: The first use each frame has to wait on everything sharing our memory, including ourselves last frame
+        Image->AliasAccessMask = 0;
+        Image->AliasStageMask = 0;
+        for (u32 OtherId = 0; OtherId < NumTransients; ++OtherId)
+        {
+            vk_render_graph_image* Other = Graph->Images + TransientIds[OtherId];
+            b32 MemoryOverlaps = (Image->MemoryOffset < Other->MemoryOffset + Other->MemorySize &&
+                                  Other->MemoryOffset < Image->MemoryOffset + Image->MemorySize);
+            if (!MemoryOverlaps)
+            {
+                continue;
+            }
+
+            for (u32 PassId = 0; PassId < Graph->NumPasses; ++PassId)
+            {
+                vk_render_graph_pass* Pass = Graph->Passes + PassId;
+                for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+                {
+                    if (Pass->Uses[UseId].ImageId == TransientIds[OtherId])
+                    {
+                        vk_render_graph_image_state State = VkRenderGraphAccessGetState(Pass->Uses[UseId].Access);
+                        Image->AliasAccessMask |= State.AccessMask & VK_RENDER_GRAPH_WRITE_ACCESS;
+                        Image->AliasStageMask |= State.StageMask;
+                    }
+                }
+            }
+        }
+    }
+}
+
+inline void VkRenderGraphBuildRenderPasses(vk_render_graph* Graph, linear_arena* TempArena, u32 NumOrderedPasses)
+{
+    for (u32 OrderId = 0; OrderId < NumOrderedPasses; ++OrderId)
+    {
+        vk_render_graph_pass* Pass = Graph->Passes + Graph->PassOrder[OrderId];
+        Pass->NumAttachments = 0;
+        Pass->RenderPass = VK_NULL_HANDLE;
+
+        b32 HasAttachments = false;
+        for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+        {
+            HasAttachments = HasAttachments || VkRenderGraphAccessIsAttachment(Pass->Uses[UseId].Access);
+        }
+
+        if (!HasAttachments)
+        {
+            continue;
+        }
+
+        // NOTE: Barriers are emitted outside of the pass, so attachments start and end in their attachment layout
+        vk_render_pass_builder Builder = VkRenderPassBuilderBegin(TempArena);
+        for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+        {
+            vk_render_graph_use* Use = Pass->Uses + UseId;
+            if (!VkRenderGraphAccessIsAttachment(Use->Access))
+            {
+                continue;
+            }
+
+            vk_render_graph_image* Image = Graph->Images + Use->ImageId;
+            vk_render_graph_image_state State = VkRenderGraphAccessGetState(Use->Access);
+
+            b32 FirstUse = !Image->Imported && Image->FirstPassId == OrderId;
+            b32 LastUse = !Image->Imported && Image->LastPassId == OrderId;
+            VkAttachmentLoadOp LoadOp = Use->Clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : (FirstUse ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD);
+            VkAttachmentStoreOp StoreOp = LastUse ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+
+            u32 AttachmentId = VkRenderPassAttachmentAdd(&Builder, Image->Format, Image->SampleCount, LoadOp, StoreOp, State.Layout,
+                                                         State.Layout);
+            Pass->AttachmentImageIds[AttachmentId] = Use->ImageId;
+            Pass->ClearValues[AttachmentId] = Use->ClearValue;
+            Pass->NumAttachments += 1;
+        }
+
+        VkRenderPassSubPassBegin(&Builder, VK_PIPELINE_BIND_POINT_GRAPHICS);
+        for (u32 AttachmentId = 0; AttachmentId < Pass->NumAttachments; ++AttachmentId)
+        {
+            vk_render_graph_image* Image = Graph->Images + Pass->AttachmentImageIds[AttachmentId];
+            VkImageLayout Layout = Builder.Attachments[AttachmentId].initialLayout;
+            if (Image->AspectMask & VK_IMAGE_ASPECT_DEPTH_BIT)
+            {
+                VkRenderPassDepthRefAdd(&Builder, AttachmentId, Layout);
+            }
+            else
+            {
+                VkRenderPassColorRefAdd(&Builder, AttachmentId, Layout);
+            }
+        }
+        VkRenderPassSubPassEnd(&Builder);
+
+        // NOTE: Execute reuses the handle every frame without going through the cache, so LRU eviction must not touch it
+        Pass->RenderPass = VkRenderPassBuilderEnd(&Builder, Graph->Device, Graph->RenderCache);
+        VkRenderCacheRenderPassPin(Graph->RenderCache, Pass->RenderPass);
+    }
+}
+
+inline void VkRenderGraphCompile(vk_render_graph* Graph, linear_arena* TempArena)
+{
+    Assert(!Graph->Compiled);
+    Assert(Graph->RenderCache);
+
+    u32 NumOrderedPasses = VkRenderGraphSchedule(Graph);
+    VkRenderGraphAllocateImages(Graph, NumOrderedPasses);
+    VkRenderGraphBuildRenderPasses(Graph, TempArena, NumOrderedPasses);
+
+    // NOTE: Passes that got culled are marked with an empty slot at the end of the order
+    for (u32 OrderId = NumOrderedPasses; OrderId < Graph->NumPasses; ++OrderId)
+    {
+        Graph->PassOrder[OrderId] = 0xFFFFFFFF;
+    }
+
+    Graph->Compiled = true;
+}
+
+inline void VkRenderGraphDestroy(vk_render_graph* Graph)
+{
+    // IMPORTANT: Caller has to make sure the gpu is done with the graph images
+    for (u32 ImageId = 0; ImageId < Graph->NumImages; ++ImageId)
+    {
+        vk_render_graph_image* Image = Graph->Images + ImageId;
+        if (!Image->Imported && Image->Image != VK_NULL_HANDLE)
+        {
+            VkRenderCacheViewEvict(Graph->RenderCache, Image->View);
+            vkDestroyImageView(Graph->Device, Image->View, 0);
+            vkDestroyImage(Graph->Device, Image->Image, 0);
+        }
+    }
+
+    if (Graph->TransientMemory != VK_NULL_HANDLE)
+    {
+        vkFreeMemory(Graph->Device, Graph->TransientMemory, 0);
+    }
+
+    for (u32 PassId = 0; PassId < Graph->NumPasses && Graph->Compiled; ++PassId)
+    {
+        vk_render_graph_pass* Pass = Graph->Passes + PassId;
+        if (Pass->RenderPass != VK_NULL_HANDLE)
+        {
+            VkRenderCacheRenderPassUnpin(Graph->RenderCache, Pass->RenderPass);
+        }
+    }
+
+    // NOTE: Keep the device and cache so the graph can be rebuilt
+    VkDevice Device = Graph->Device;
+    VkPhysicalDeviceMemoryProperties* MemoryProperties = Graph->MemoryProperties;
+    vk_render_cache* RenderCache = Graph->RenderCache;
+    *Graph = {};
+    Graph->Device = Device;
+    Graph->MemoryProperties = MemoryProperties;
+    Graph->RenderCache = RenderCache;
+}
+
+//
+// NOTE: Render Graph Execute
+//
+
+inline void VkRenderGraphTransition(vk_commands* Commands, vk_render_graph_image* Image, vk_render_graph_image_state Target)
+{
+    vk_render_graph_image_state* Curr = &Image->CurrState;
+
+    b32 NeedsBarrier = (Curr->Layout != Target.Layout || (Curr->AccessMask & VK_RENDER_GRAPH_WRITE_ACCESS) ||
+                        (Target.AccessMask & VK_RENDER_GRAPH_WRITE_ACCESS));
+    if (NeedsBarrier)
+    {
+        VkPipelineStageFlags SrcStageMask = Curr->StageMask ? Curr->StageMask : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        VkBarrierImageAdd(Commands, Image->Image, Image->AspectMask, Curr->AccessMask, SrcStageMask, Curr->Layout, Target.AccessMask,
+                          Target.StageMask, Target.Layout);
+        *Curr = Target;
+    }
+    else
+    {
+        // NOTE: Read after read, accumulate so the next write waits on every reader
+        Curr->AccessMask |= Target.AccessMask;
+        Curr->StageMask |= Target.StageMask;
+    }
+}
+
+inline void VkRenderGraphExecute(vk_render_graph* Graph, vk_commands* Commands)
+{
+    Assert(Graph->Compiled);
+
+    for (u32 ImageId = 0; ImageId < Graph->NumImages; ++ImageId)
+    {
+        vk_render_graph_image* Image = Graph->Images + ImageId;
+        if (Image->Imported)
+        {
+            Image->CurrState = Image->InitialState;
+        }
+        else
+        {
+            Image->CurrState.Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            Image->CurrState.AccessMask = Image->AliasAccessMask;
+            Image->CurrState.StageMask = Image->AliasStageMask;
+        }
+    }
+
+    for (u32 OrderId = 0; OrderId < Graph->NumPasses && Graph->PassOrder[OrderId] != 0xFFFFFFFF; ++OrderId)
+    {
+        vk_render_graph_pass* Pass = Graph->Passes + Graph->PassOrder[OrderId];
+
+        // NOTE: All transitions for the pass go out in one barrier call
+        for (u32 UseId = 0; UseId < Pass->NumUses; ++UseId)
+        {
+            vk_render_graph_use* Use = Pass->Uses + UseId;
+            VkRenderGraphTransition(Commands, Graph->Images + Use->ImageId, VkRenderGraphAccessGetState(Use->Access));
+        }
+        VkCommandsBarrierFlush(Commands);
+
+        if (Pass->RenderPass != VK_NULL_HANDLE)
+        {
+            VkImageView Views[VK_RENDER_GRAPH_MAX_PASS_USES];
+            for (u32 AttachmentId = 0; AttachmentId < Pass->NumAttachments; ++AttachmentId)
+            {
+                Views[AttachmentId] = Graph->Images[Pass->AttachmentImageIds[AttachmentId]].View;
+            }
+
+            vk_render_graph_image* FirstImage = Graph->Images + Pass->AttachmentImageIds[0];
+            VkFramebuffer Fbo = VkRenderCacheFboGet(Graph->RenderCache, Graph->Device, Pass->RenderPass, Views, Pass->NumAttachments,
+                                                    FirstImage->Width, FirstImage->Height);
+
+            VkRenderPassBeginInfo BeginInfo = {};
+            BeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            BeginInfo.renderPass = Pass->RenderPass;
+            BeginInfo.framebuffer = Fbo;
+            BeginInfo.renderArea.extent.width = FirstImage->Width;
+            BeginInfo.renderArea.extent.height = FirstImage->Height;
+            BeginInfo.clearValueCount = Pass->NumAttachments;
+            BeginInfo.pClearValues = Pass->ClearValues;
+            vkCmdBeginRenderPass(Commands->Buffer, &BeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+            Pass->Execute(Commands, Pass->Data);
+
+            vkCmdEndRenderPass(Commands->Buffer);
+        }
+        else
+        {
+            Pass->Execute(Commands, Pass->Data);
+        }
+    }
+
+    // NOTE: Hand imported images back in the state the rest of the frame expects
+    for (u32 ImageId = 0; ImageId < Graph->NumImages; ++ImageId)
+    {
+        vk_render_graph_image* Image = Graph->Images + ImageId;
+        if (Image->Imported && Image->FirstPassId != 0xFFFFFFFF)
+        {
+            vk_render_graph_image_state* Curr = &Image->CurrState;
+            VkBarrierImageAdd(Commands, Image->Image, Image->AspectMask, Curr->AccessMask, Curr->StageMask, Curr->Layout,
+                              Image->FinalState.AccessMask, Image->FinalState.StageMask, Image->FinalState.Layout);
+        }
+    }
+    VkCommandsBarrierFlush(Commands);
+}
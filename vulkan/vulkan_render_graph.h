@@ -0,0 +1,120 @@
+#pragma once
+
+//
+// NOTE: Render Graph
+//
+
+/*
+   NOTE: The render graph sits on top of vk_commands, the render pass builder and the render cache. Passes declare which
+         images they read and write, compile orders them, creates transient images that alias memory when their
+         lifetimes don't overlap and builds render passes for passes that write attachments. Execute emits the
+         barriers for each pass as one batch, begins the render pass and calls the pass callback.
+
+         The graph is meant to be built once and executed every frame, rebuild it when sizes change. Imported images
+         (swapchain, history buffers) can swap their handles every frame with VkRenderGraphImportSet.
+*/
+
+#define VK_RENDER_GRAPH_EXECUTE(name) void name(vk_commands* Commands, void* Data)
+typedef VK_RENDER_GRAPH_EXECUTE(vk_render_graph_execute);
+
+#define VK_RENDER_GRAPH_MAX_PASSES 64
+#define VK_RENDER_GRAPH_MAX_IMAGES 64
+#define VK_RENDER_GRAPH_MAX_PASS_USES 16
+
+enum vk_render_graph_access
+{
+    VkRgAccess_None,
+
+    VkRgAccess_ColorWrite,
+    VkRgAccess_DepthWrite,
+    VkRgAccess_DepthRead,
+    VkRgAccess_SampledRead,
+    VkRgAccess_StorageRead,
+    VkRgAccess_StorageWrite,
+    VkRgAccess_TransferRead,
+    VkRgAccess_TransferWrite,
+};
+
+struct vk_render_graph_image_state
+{
+    VkImageLayout Layout;
+    VkAccessFlags AccessMask;
+    VkPipelineStageFlags StageMask;
+};
+
+struct vk_render_graph_image
+{
+    b32 Imported;
+
+    u32 Width;
+    u32 Height;
+    VkFormat Format;
+    VkImageAspectFlags AspectMask;
+    VkSampleCountFlagBits SampleCount;
+    VkImageUsageFlags Usage;
+
+    VkImage Image;
+    VkImageView View;
+
+    // NOTE: Lifetime in execution order, transient images only exist between these passes
+    u32 FirstPassId;
+    u32 LastPassId;
+
+    // NOTE: Memory placement for transient images
+    u64 MemoryOffset;
+    u64 MemorySize;
+    VkMemoryRequirements MemoryRequirements;
+
+    // NOTE: Accesses of images that previously used our memory, the first barrier has to wait on them
+    VkAccessFlags AliasAccessMask;
+    VkPipelineStageFlags AliasStageMask;
+
+    // NOTE: Imported images start each frame in InitialState and get transitioned to FinalState at the end
+    vk_render_graph_image_state InitialState;
+    vk_render_graph_image_state FinalState;
+    vk_render_graph_image_state CurrState;
+};
+
+struct vk_render_graph_use
+{
+    u32 ImageId;
+    vk_render_graph_access Access;
+    b32 Clear;
+    VkClearValue ClearValue;
+};
+
+struct vk_render_graph_pass
+{
+    char* Name;
+    vk_render_graph_execute* Execute;
+    void* Data;
+
+    u32 NumUses;
+    vk_render_graph_use Uses[VK_RENDER_GRAPH_MAX_PASS_USES];
+
+    // NOTE: Set by compile for passes that write attachments
+    VkRenderPass RenderPass;
+    u32 NumAttachments;
+    u32 AttachmentImageIds[VK_RENDER_GRAPH_MAX_PASS_USES];
+    VkClearValue ClearValues[VK_RENDER_GRAPH_MAX_PASS_USES];
+};
+
+struct vk_render_graph
+{
+    VkDevice Device;
+    VkPhysicalDeviceMemoryProperties* MemoryProperties;
+    vk_render_cache* RenderCache;
+
+    u32 NumPasses;
+    vk_render_graph_pass Passes[VK_RENDER_GRAPH_MAX_PASSES];
+
+    u32 NumImages;
+    vk_render_graph_image Images[VK_RENDER_GRAPH_MAX_IMAGES];
+
+    // NOTE: Compile results
+    b32 Compiled;
+    u32 PassOrder[VK_RENDER_GRAPH_MAX_PASSES];
+    VkDeviceMemory TransientMemory;
+    u64 TransientMemorySize;
+    u64 UnaliasedMemorySize;
+};
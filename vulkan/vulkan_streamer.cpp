@@ -0,0 +1,373 @@
+
+//
+// NOTE: Upload Streamer
+//
+
+inline vk_upload_streamer VkUploadStreamerCreate(VkDevice Device, VkQueue Queue, u32 QueueFamilyIndex, u32 StagingTypeId,
+                                                 u64 FlushAlignment, b32 IsCoherent, u32 NumChunks = 4,
+                                                 u64 ChunkSize = MegaBytes(8), vk_submit_queue* SubmitQueue = 0)
+{
+    // IMPORTANT: Queue must be the queue the uploaded resources get used on, see the notes in vulkan_streamer.h
+    Assert(NumChunks > 0 && NumChunks <= VK_UPLOAD_STREAMER_MAX_CHUNKS);
+    Assert(!SubmitQueue || SubmitQueue->Queue == Queue);
+
+    vk_upload_streamer Result = {};
+    Result.Device = Device;
+    Result.Queue = Queue;
+    Result.SubmitQueue = SubmitQueue;
+    Result.ChunkSize = AlignAddress(ChunkSize, FlushAlignment);
+    Result.FlushAlignment = FlushAlignment;
+    Result.IsCoherent = IsCoherent;
+    Result.NumChunks = NumChunks;
+
+    VkCommandPoolCreateInfo PoolCreateInfo = {};
+    PoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    PoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    PoolCreateInfo.queueFamilyIndex = QueueFamilyIndex;
+    VkCheckResult(vkCreateCommandPool(Device, &PoolCreateInfo, 0, &Result.Pool));
+
+    for (u32 ChunkId = 0; ChunkId < NumChunks; ++ChunkId)
+    {
+        vk_upload_chunk* Chunk = Result.Chunks + ChunkId;
+
+        // NOTE: Staging memory is allocated once here, the ring never grows
+        Chunk->StagingBuffer = VkBufferHandleCreate(Device, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, Result.ChunkSize);
+        VkMemoryRequirements MemoryRequirements = VkBufferGetMemoryRequirements(Device, Chunk->StagingBuffer);
+        Assert(MemoryRequirements.memoryTypeBits & (1 << StagingTypeId));
+        Chunk->StagingMemory = VkMemoryAllocate(Device, StagingTypeId, MemoryRequirements.size);
+        VkCheckResult(vkBindBufferMemory(Device, Chunk->StagingBuffer, Chunk->StagingMemory, 0));
+        VkCheckResult(vkMapMemory(Device, Chunk->StagingMemory, 0, VK_WHOLE_SIZE, 0, (void**)&Chunk->MappedPtr));
+
+        VkCommandBufferAllocateInfo CmdBufferAllocateInfo = {};
+        CmdBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        CmdBufferAllocateInfo.commandPool = Result.Pool;
+        CmdBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        CmdBufferAllocateInfo.commandBufferCount = 1;
+        VkCheckResult(vkAllocateCommandBuffers(Device, &CmdBufferAllocateInfo, &Chunk->Buffer));
+
+        VkFenceCreateInfo FenceCreateInfo = {};
+        FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        FenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        VkCheckResult(vkCreateFence(Device, &FenceCreateInfo, 0, &Chunk->Fence));
+    }
+
+    return Result;
+}
+
+inline void VkUploadStreamerChunkRetire(vk_upload_streamer* Streamer, vk_upload_chunk* Chunk)
+{
+    Chunk->InFlight = false;
+    Streamer->CompletedToken = Max(Streamer->CompletedToken, Chunk->Token);
+}
+
+inline void VkUploadStreamerSubmit(vk_upload_streamer* Streamer)
+{
+    vk_upload_chunk* Chunk = Streamer->OpenChunk;
+    if (!Chunk)
+    {
+        return;
+    }
+
+    VkCheckResult(vkEndCommandBuffer(Chunk->Buffer));
+
+    if (!Streamer->IsCoherent)
+    {
+        VkMappedMemoryRange FlushRange = {};
+        FlushRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        FlushRange.memory = Chunk->StagingMemory;
+        FlushRange.offset = 0;
+        FlushRange.size = Min(AlignAddress(Chunk->Used, Streamer->FlushAlignment), Streamer->ChunkSize);
+        VkCheckResult(vkFlushMappedMemoryRanges(Streamer->Device, 1, &FlushRange));
+    }
+
+    if (Streamer->SubmitQueue)
+    {
+        // NOTE: Waiting on the fence before the submit thread got to it is fine, it just waits longer
+        VkSubmitQueuePush(Streamer->SubmitQueue, Chunk->Buffer, Chunk->Fence);
+    }
+    else
+    {
+        VkSubmitInfo SubmitInfo = {};
+        SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        SubmitInfo.commandBufferCount = 1;
+        SubmitInfo.pCommandBuffers = &Chunk->Buffer;
+        VkCheckResult(vkQueueSubmit(Streamer->Queue, 1, &SubmitInfo, Chunk->Fence));
+    }
+
+    Chunk->InFlight = true;
+    Streamer->OpenChunk = 0;
+    Streamer->Stats.NumChunksSubmitted += 1;
+}
+
+inline vk_upload_chunk* VkUploadStreamerChunkAcquire(vk_upload_streamer* Streamer)
+{
+    if (Streamer->OpenChunk)
+    {
+        return Streamer->OpenChunk;
+    }
+
+    // NOTE: Chunks get reused oldest first, if the oldest is still in flight we have to wait for the gpu
+    vk_upload_chunk* Result = Streamer->Chunks + Streamer->NextChunkId;
+    Streamer->NextChunkId = (Streamer->NextChunkId + 1) % Streamer->NumChunks;
+
+    if (Result->InFlight)
+    {
+        if (vkGetFenceStatus(Streamer->Device, Result->Fence) == VK_NOT_READY)
+        {
+            Streamer->Stats.NumStalls += 1;
+            VkCheckResult(vkWaitForFences(Streamer->Device, 1, &Result->Fence, VK_TRUE, 0xFFFFFFFF));
+        }
+        VkUploadStreamerChunkRetire(Streamer, Result);
+    }
+    VkCheckResult(vkResetFences(Streamer->Device, 1, &Result->Fence));
+
+    VkCheckResult(vkResetCommandBuffer(Result->Buffer, 0));
+    VkCommandBufferBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VkCheckResult(vkBeginCommandBuffer(Result->Buffer, &BeginInfo));
+
+    Result->Used = 0;
+    Result->Token = ++Streamer->LastToken;
+    Streamer->OpenChunk = Result;
+
+    return Result;
+}
+
+inline vk_upload_chunk* VkUploadStreamerChunkReserve(vk_upload_streamer* Streamer, u64 MinSize, u64 Alignment, u64* OutOffset)
+{
+    // NOTE: Returns a chunk with at least MinSize bytes left after aligning, submits the open one if it can't fit
+    Assert(MinSize <= Streamer->ChunkSize);
+
+    vk_upload_chunk* Result = VkUploadStreamerChunkAcquire(Streamer);
+
+    // NOTE: Image alignments aren't always a power of 2 (12 byte texels)
+    u64 AlignedOffset = ((Result->Used + Alignment - 1) / Alignment) * Alignment;
+    if (AlignedOffset + MinSize > Streamer->ChunkSize)
+    {
+        VkUploadStreamerSubmit(Streamer);
+        Result = VkUploadStreamerChunkAcquire(Streamer);
+        AlignedOffset = 0;
+    }
+
+    *OutOffset = AlignedOffset;
+    return Result;
+}
+
+inline void VkUploadStreamerPoll(vk_upload_streamer* Streamer)
+{
+    for (u32 ChunkId = 0; ChunkId < Streamer->NumChunks; ++ChunkId)
+    {
+        vk_upload_chunk* Chunk = Streamer->Chunks + ChunkId;
+        if (Chunk->InFlight && vkGetFenceStatus(Streamer->Device, Chunk->Fence) == VK_SUCCESS)
+        {
+            VkUploadStreamerChunkRetire(Streamer, Chunk);
+        }
+    }
+}
+
+inline b32 VkUploadStreamerIsComplete(vk_upload_streamer* Streamer, u64 Token)
+{
+    // NOTE: Data still sitting in the open chunk only completes after a flush
+    if (Streamer->CompletedToken < Token)
+    {
+        VkUploadStreamerPoll(Streamer);
+    }
+
+    b32 Result = Streamer->CompletedToken >= Token;
+    return Result;
+}
+
+inline void VkUploadStreamerFlush(vk_upload_streamer* Streamer)
+{
+    VkUploadStreamerSubmit(Streamer);
+}
+
+inline void VkUploadStreamerWait(vk_upload_streamer* Streamer, u64 Token)
+{
+    if (Streamer->OpenChunk && Streamer->OpenChunk->Token <= Token)
+    {
+        VkUploadStreamerSubmit(Streamer);
+    }
+
+    for (u32 ChunkId = 0; ChunkId < Streamer->NumChunks; ++ChunkId)
+    {
+        vk_upload_chunk* Chunk = Streamer->Chunks + ChunkId;
+        if (Chunk->InFlight && Chunk->Token <= Token)
+        {
+            VkCheckResult(vkWaitForFences(Streamer->Device, 1, &Chunk->Fence, VK_TRUE, 0xFFFFFFFF));
+            VkUploadStreamerChunkRetire(Streamer, Chunk);
+        }
+    }
+}
+
+inline u64 VkUploadStreamerWriteBuffer(vk_upload_streamer* Streamer, VkBuffer Buffer, u64 DstOffset, void* Data, u64 Size,
+                                       barrier_mask InputMask, barrier_mask OutputMask)
+{
+    // NOTE: Copies Data into the ring chunk by chunk. The input barrier goes in the first chunk and the output barrier
+    // in the last, queue submission order covers the copies in between
+    Assert(Size > 0);
+
+    u8* SrcPtr = (u8*)Data;
+    u64 Remaining = Size;
+    u64 CurrDstOffset = DstOffset;
+    b32 First = true;
+    vk_upload_chunk* Chunk = 0;
+    while (Remaining > 0)
+    {
+        // IMPORTANT: Default Alignment = 4 since ARM requires it
+        u64 StagingOffset = 0;
+        Chunk = VkUploadStreamerChunkReserve(Streamer, Min(Remaining, u64(4)), 4, &StagingOffset);
+        u64 CopySize = Min(Remaining, Streamer->ChunkSize - StagingOffset);
+
+        if (First)
+        {
+            VkBufferMemoryBarrier Barrier = {};
+            Barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            Barrier.srcAccessMask = InputMask.AccessMask;
+            Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.buffer = Buffer;
+            Barrier.offset = DstOffset;
+            Barrier.size = Size;
+            vkCmdPipelineBarrier(Chunk->Buffer, InputMask.StageMask, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 1, &Barrier, 0, 0);
+            First = false;
+        }
+
+        Copy(SrcPtr, Chunk->MappedPtr + StagingOffset, CopySize);
+
+        VkBufferCopy Region = {};
+        Region.srcOffset = StagingOffset;
+        Region.dstOffset = CurrDstOffset;
+        Region.size = CopySize;
+        vkCmdCopyBuffer(Chunk->Buffer, Chunk->StagingBuffer, Buffer, 1, &Region);
+
+        Chunk->Used = StagingOffset + CopySize;
+        SrcPtr += CopySize;
+        CurrDstOffset += CopySize;
+        Remaining -= CopySize;
+    }
+
+    {
+        VkBufferMemoryBarrier Barrier = {};
+        Barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        Barrier.dstAccessMask = OutputMask.AccessMask;
+        Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.buffer = Buffer;
+        Barrier.offset = DstOffset;
+        Barrier.size = Size;
+        vkCmdPipelineBarrier(Chunk->Buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, OutputMask.StageMask, 0, 0, 0, 1, &Barrier, 0, 0);
+    }
+
+    Streamer->Stats.NumBytesStreamed += Size;
+
+    u64 Result = Chunk->Token;
+    return Result;
+}
+
+inline u64 VkUploadStreamerWriteImage(vk_upload_streamer* Streamer, VkImage Image, u32 Width, u32 Height, u32 TexelSize,
+                                      VkImageAspectFlags AspectMask, barrier_mask InputMask, VkImageLayout InputLayout,
+                                      barrier_mask OutputMask, VkImageLayout OutputLayout, void* Data)
+{
+    // NOTE: Uploads mip 0, layer 0 of a 2D image in bands of whole rows. The image stays in TRANSFER_DST between bands
+    // and only transitions to OutputLayout after the last one
+    u64 RowSize = u64(Width) * u64(TexelSize);
+    Assert(RowSize <= Streamer->ChunkSize);
+
+    VkImageSubresourceRange Range = {};
+    Range.aspectMask = AspectMask;
+    Range.baseMipLevel = 0;
+    Range.levelCount = 1;
+    Range.baseArrayLayer = 0;
+    Range.layerCount = 1;
+
+    // NOTE: bufferOffset has to be a multiple of 4 and of the texel size
+    u64 Alignment = u64(TexelSize) * 4;
+
+    u8* SrcPtr = (u8*)Data;
+    u32 CurrRow = 0;
+    b32 First = true;
+    vk_upload_chunk* Chunk = 0;
+    while (CurrRow < Height)
+    {
+        u64 StagingOffset = 0;
+        Chunk = VkUploadStreamerChunkReserve(Streamer, RowSize, Alignment, &StagingOffset);
+        u32 NumRows = Min(u32((Streamer->ChunkSize - StagingOffset) / RowSize), Height - CurrRow);
+        u64 CopySize = u64(NumRows) * RowSize;
+
+        if (First)
+        {
+            VkImageMemoryBarrier Barrier = {};
+            Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            Barrier.srcAccessMask = InputMask.AccessMask;
+            Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            Barrier.oldLayout = InputLayout;
+            Barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            Barrier.image = Image;
+            Barrier.subresourceRange = Range;
+            vkCmdPipelineBarrier(Chunk->Buffer, InputMask.StageMask, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, 0, 0, 0, 1, &Barrier);
+            First = false;
+        }
+
+        Copy(SrcPtr, Chunk->MappedPtr + StagingOffset, CopySize);
+
+        VkBufferImageCopy Region = {};
+        Region.bufferOffset = StagingOffset;
+        Region.bufferRowLength = 0;
+        Region.bufferImageHeight = 0;
+        Region.imageSubresource.aspectMask = AspectMask;
+        Region.imageSubresource.mipLevel = 0;
+        Region.imageSubresource.baseArrayLayer = 0;
+        Region.imageSubresource.layerCount = 1;
+        Region.imageOffset.x = 0;
+        Region.imageOffset.y = CurrRow;
+        Region.imageOffset.z = 0;
+        Region.imageExtent.width = Width;
+        Region.imageExtent.height = NumRows;
+        Region.imageExtent.depth = 1;
+        vkCmdCopyBufferToImage(Chunk->Buffer, Chunk->StagingBuffer, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
+
+        Chunk->Used = StagingOffset + CopySize;
+        SrcPtr += CopySize;
+        CurrRow += NumRows;
+    }
+
+    {
+        VkImageMemoryBarrier Barrier = {};
+        Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        Barrier.dstAccessMask = OutputMask.AccessMask;
+        Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        Barrier.newLayout = OutputLayout;
+        Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        Barrier.image = Image;
+        Barrier.subresourceRange = Range;
+        vkCmdPipelineBarrier(Chunk->Buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, OutputMask.StageMask, 0, 0, 0, 0, 0, 1, &Barrier);
+    }
+
+    Streamer->Stats.NumBytesStreamed += RowSize * Height;
+
+    u64 Result = Chunk->Token;
+    return Result;
+}
+
+inline void VkUploadStreamerDestroy(vk_upload_streamer* Streamer)
+{
+    VkUploadStreamerWait(Streamer, Streamer->LastToken);
+
+    for (u32 ChunkId = 0; ChunkId < Streamer->NumChunks; ++ChunkId)
+    {
+        vk_upload_chunk* Chunk = Streamer->Chunks + ChunkId;
+        vkDestroyFence(Streamer->Device, Chunk->Fence, 0);
+        vkDestroyBuffer(Streamer->Device, Chunk->StagingBuffer, 0);
+        vkUnmapMemory(Streamer->Device, Chunk->StagingMemory);
+        vkFreeMemory(Streamer->Device, Chunk->StagingMemory, 0);
+    }
+    vkDestroyCommandPool(Streamer->Device, Streamer->Pool, 0);
+}
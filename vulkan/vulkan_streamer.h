@@ -0,0 +1,72 @@
+#pragma once
+
+//
+// NOTE: Upload Streamer
+//
+
+/*
+   NOTE: Streams large buffer and image uploads through a fixed ring of staging chunks so peak staging memory is
+         NumChunks * ChunkSize no matter how big the asset is. Buffers get split into chunk sized pieces, images into
+         bands of whole rows. When a chunk fills up it gets submitted with its own fence and the next chunk in the ring
+         is reused once its fence signals, so the cpu only blocks when every chunk is still in flight.
+
+         Every write returns a token, VkUploadStreamerIsComplete and VkUploadStreamerWait tell you when the data landed.
+         Tokens complete in order since every chunk goes to the same queue.
+
+         IMPORTANT: The streamer has to submit to the same queue that consumes the data, which means a graphics (or
+         compute) queue. The barriers of each write use InputMask and OutputMask stages that a transfer only queue
+         doesn't support, and the streamer does no queue family ownership transfer and signals no semaphore. Queue
+         submission order plus those barriers is what makes the data visible to later submits.
+
+         Without a vk_submit_queue the streamer calls vkQueueSubmit itself, so only use it from the thread that owns the
+         queue. If the queue is driven by a vk_submit_queue, pass it to VkUploadStreamerCreate and the chunks get pushed
+         through it instead, in order with everything else pushed to it. Then the streamer can live on any one thread,
+         as long as VkUploadStreamerSubmit returns before the commands consuming the data get pushed.
+*/
+
+#define VK_UPLOAD_STREAMER_MAX_CHUNKS 16
+
+struct vk_upload_chunk
+{
+    VkBuffer StagingBuffer;
+    VkDeviceMemory StagingMemory;
+    u8* MappedPtr;
+    u64 Used;
+
+    VkCommandBuffer Buffer;
+    VkFence Fence;
+    b32 InFlight;
+    u64 Token;
+};
+
+struct vk_upload_streamer_stats
+{
+    u32 NumChunksSubmitted;
+    u32 NumStalls;
+    u64 NumBytesStreamed;
+};
+
+struct vk_upload_streamer
+{
+    VkDevice Device;
+    VkQueue Queue;
+    VkCommandPool Pool;
+
+    // NOTE: Optional, owns Queue when set so chunks get pushed through it
+    vk_submit_queue* SubmitQueue;
+
+    u64 ChunkSize;
+    u64 FlushAlignment;
+    b32 IsCoherent;
+
+    // NOTE: OpenChunk is the chunk we are recording into or null, NextChunkId is the oldest chunk in the ring
+    u32 NumChunks;
+    u32 NextChunkId;
+    vk_upload_chunk* OpenChunk;
+    vk_upload_chunk Chunks[VK_UPLOAD_STREAMER_MAX_CHUNKS];
+
+    u64 LastToken;
+    u64 CompletedToken;
+
+    vk_upload_streamer_stats Stats;
+};
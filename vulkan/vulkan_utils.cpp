@@ -11,6 +11,107 @@ internal void VkCheckResult(VkResult Result)
     }
 }
 
+inline u64 VkHashBytes(u64 Hash, void* Data, mm Size)
+{
+    // NOTE: FNV-1a, pass VK_HASH_INIT to start a new hash or a previous result to chain data
+    u64 Result = Hash;
+    u8* Bytes = (u8*)Data;
+    for (mm ByteId = 0; ByteId < Size; ++ByteId)
+    {
+        Result ^= Bytes[ByteId];
+        Result *= 1099511628211ull;
+    }
+
+    return Result;
+}
+
+inline u32 VkFormatGetSize(VkFormat Format)
+{
+    // NOTE: Size of one texel in bytes, block compressed formats aren't handled
+    u32 Result = 0;
+    switch (Format)
+    {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SNORM:
+        case VK_FORMAT_R8_UINT:
+        case VK_FORMAT_R8_SINT:
+        case VK_FORMAT_S8_UINT:
+        {
+            Result = 1;
+        } break;
+
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R8G8_SNORM:
+        case VK_FORMAT_R16_UNORM:
+        case VK_FORMAT_R16_SFLOAT:
+        case VK_FORMAT_R16_UINT:
+        case VK_FORMAT_D16_UNORM:
+        {
+            Result = 2;
+        } break;
+
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        {
+            Result = 3;
+        } break;
+        
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_D32_SFLOAT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        {
+            Result = 4;
+        } break;
+
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        {
+            Result = 5;
+        } break;
+
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R16G16B16A16_UINT:
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R32G32_UINT:
+        {
+            Result = 8;
+        } break;
+
+        case VK_FORMAT_R32G32B32_SFLOAT:
+        {
+            Result = 12;
+        } break;
+        
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_UINT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+        {
+            Result = 16;
+        } break;
+
+        // TODO: Add formats as we need them, unknown formats report 0 bytes
+        default:
+        {
+        } break;
+    }
+
+    return Result;
+}
+
 inline VkClearValue VkClearColorCreate(f32 R, f32 G, f32 B, f32 A)
 {
     VkClearValue Result = {};
@@ -369,6 +470,60 @@ inline vk_image VkImageCreate(VkDevice Device, vk_linear_arena* Arena, u32 Width
     return Result;
 }
 
+inline vk_image VkTransientImageCreate(VkDevice Device, vk_linear_arena* Arena, u32 Width, u32 Height, VkFormat Format,
+                                       VkImageUsageFlags Usage, VkImageAspectFlags AspectMask,
+                                       VkSampleCountFlagBits SampleCount = VK_SAMPLE_COUNT_1_BIT)
+{
+    // IMPORTANT: Arena should use the memory type from VkGetTransientMemoryType, and the image can only be used as an
+    // attachment inside a single render pass (color, depth or input)
+    Assert((Usage & ~(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT)) == 0);
+    vk_image Result = VkImageCreate(Device, Arena, Width, Height, Format, Usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, AspectMask,
+                                    SampleCount);
+
+    return Result;
+}
+
+//
+// NOTE: Image Array Helpers
+//
+
+inline VkImage VkImageArrayCreate(VkDevice Device, vk_linear_arena* Arena, u32 Width, u32 Height, u32 NumLayers, VkFormat Format,
+                                  VkImageUsageFlags Usage)
+{
+    VkImage Result = {};
+    
+    VkImageCreateInfo ImageCreateInfo = {};
+    ImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ImageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    ImageCreateInfo.format = Format;
+    ImageCreateInfo.extent.width = Width;
+    ImageCreateInfo.extent.height = Height;
+    ImageCreateInfo.extent.depth = 1;
+    ImageCreateInfo.mipLevels = 1;
+    ImageCreateInfo.arrayLayers = NumLayers;
+    ImageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    ImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ImageCreateInfo.usage = Usage;
+    ImageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkCheckResult(vkCreateImage(Device, &ImageCreateInfo, 0, &Result));
+
+    VkMemoryRequirements MemoryRequirements = VkImageGetMemoryRequirements(Device, Result);
+    VkImageBindMemory(Device, Arena, Result, MemoryRequirements);
+
+    return Result;
+}
+
+inline vk_image VkImageArrayCreate(VkDevice Device, vk_linear_arena* Arena, u32 Width, u32 Height, u32 NumLayers, VkFormat Format,
+                                   VkImageUsageFlags Usage, VkImageAspectFlags AspectMask)
+{
+    vk_image Result = {};
+    Result.Image = VkImageArrayCreate(Device, Arena, Width, Height, NumLayers, Format, Usage);
+    Result.View = VkImageViewCreate(Device, Result.Image, VK_IMAGE_VIEW_TYPE_2D_ARRAY, Format, AspectMask, 0, NumLayers);
+
+    return Result;
+}
+
 //
 // NOTE: Cube Map Helpers
 //
@@ -413,6 +568,14 @@ inline vk_image VkCubeMapCreate(VkDevice Device, vk_linear_arena* Arena, u32 Wid
     return Result;
 }
 
+inline VkImageView VkCubeMapAttachmentViewCreate(VkDevice Device, VkImage CubeMap, VkFormat Format, VkImageAspectFlags AspectMask,
+                                                 u32 MipLevel)
+{
+    // NOTE: Cube views can't be attachments, render all 6 faces of a mip through a 2d array view with view mask 0x3F
+    VkImageView Result = VkImageViewCreate(Device, CubeMap, VK_IMAGE_VIEW_TYPE_2D_ARRAY, Format, AspectMask, MipLevel, 6);
+    return Result;
+}
+
 //
 // NOTE: Sampler Helpers
 //
@@ -474,8 +637,9 @@ inline VkSampler VkSamplerMipMapCreate(VkDevice Device, VkFilter Filter, VkSampl
 //
 
 inline VkFramebuffer VkFboCreate(VkDevice Device, VkRenderPass Rp, VkImageView* Views, u32 NumViews,
-                                 u32 Width, u32 Height)
+                                 u32 Width, u32 Height, u32 Layers = 1)
 {
+    // NOTE: Layers > 1 is for layered rendering selected in the shader, multiview render passes require Layers = 1
     VkFramebuffer Result = {};
     
     VkFramebufferCreateInfo FrameBufferCreateInfo = {};
@@ -485,21 +649,395 @@ inline VkFramebuffer VkFboCreate(VkDevice Device, VkRenderPass Rp, VkImageView*
     FrameBufferCreateInfo.pAttachments = Views;
     FrameBufferCreateInfo.width = Width;
     FrameBufferCreateInfo.height = Height;
-    FrameBufferCreateInfo.layers = 1;
+    FrameBufferCreateInfo.layers = Layers;
     VkCheckResult(vkCreateFramebuffer(Device, &FrameBufferCreateInfo, 0, &Result));
 
     return Result;
 }
 
 inline void VkFboReCreate(VkDevice Device, VkRenderPass Rp, VkImageView* Views, u32 NumViews,
-                          VkFramebuffer* Fbo, u32 Width, u32 Height)
+                          VkFramebuffer* Fbo, u32 Width, u32 Height, u32 Layers = 1)
 {
     if (*Fbo != VK_NULL_HANDLE)
     {
         vkDestroyFramebuffer(Device, *Fbo, 0);
     }
 
-    *Fbo = VkFboCreate(Device, Rp, Views, NumViews, Width, Height);
+    *Fbo = VkFboCreate(Device, Rp, Views, NumViews, Width, Height, Layers);
+}
+
+//
+// NOTE: Render Pass + Framebuffer Cache
+//
+
+/*
+   NOTE: The cache hands out render passes and framebuffers keyed on their full description so identical requests
+         share one driver object. Objects are evicted least recently used first and only destroyed once every frame
+         that could have recorded them has retired. Expected usage:
+
+         - Call VkRenderCacheFrameBegin after waiting on the fence of the frame slot we are about to record
+         - Call VkRenderCacheViewEvict before destroying an image view, since handles get recycled by the driver
+         - Handles are only valid for the frame they were returned in, query the cache again every frame
+*/
+
+inline vk_render_cache VkRenderCacheCreate(linear_arena* Arena, u32 MaxNumRenderPasses, u32 MaxNumFbos, u32 NumFramesInFlight)
+{
+    vk_render_cache Result = {};
+    Result.NumFramesInFlight = NumFramesInFlight;
+
+    Result.MaxNumRenderPasses = MaxNumRenderPasses;
+    Result.RenderPasses = PushArray(Arena, vk_cached_object, MaxNumRenderPasses);
+
+    Result.MaxNumFbos = MaxNumFbos;
+    Result.Fbos = PushArray(Arena, vk_cached_object, MaxNumFbos);
+
+    // NOTE: Worst case every cached object gets evicted within the frames in flight window
+    Result.MaxNumRetired = MaxNumRenderPasses + MaxNumFbos;
+    Result.RetiredArray = PushArray(Arena, vk_cached_object, Result.MaxNumRetired);
+    
+    return Result;
+}
+
+inline void VkRenderCacheObjectDestroy(VkDevice Device, vk_cached_object* Object)
+{
+    switch (Object->Type)
+    {
+        case VkCachedObject_RenderPass:
+        {
+            vkDestroyRenderPass(Device, Object->RenderPass, 0);
+        } break;
+
+        case VkCachedObject_Framebuffer:
+        {
+            vkDestroyFramebuffer(Device, Object->Framebuffer, 0);
+        } break;
+
+        default:
+        {
+            InvalidCodePath;
+        } break;
+    }
+}
+
+inline void VkRenderCacheRetire(vk_render_cache* Cache, vk_cached_object* Objects, u32* NumObjects, u32 ObjectId)
+{
+    Assert(Cache->NumRetired < Cache->MaxNumRetired);
+    Cache->RetiredArray[Cache->NumRetired++] = Objects[ObjectId];
+
+    // NOTE: Swap remove, order in the cache doesn't matter
+    *NumObjects -= 1;
+    Objects[ObjectId] = Objects[*NumObjects];
+}
+
+inline u32 VkRenderCacheFindLru(vk_cached_object* Objects, u32 NumObjects)
+{
+    // IMPORTANT: The cache has to be big enough that not every object is pinned
+    u32 Result = 0xFFFFFFFF;
+    for (u32 ObjectId = 0; ObjectId < NumObjects; ++ObjectId)
+    {
+        if (Objects[ObjectId].NumPins > 0)
+        {
+            continue;
+        }
+        
+        if (Result == 0xFFFFFFFF || Objects[ObjectId].LastUsedFrame < Objects[Result].LastUsedFrame)
+        {
+            Result = ObjectId;
+        }
+    }
+
+    Assert(Result != 0xFFFFFFFF);
+    return Result;
+}
+
+inline void VkRenderCacheEvictLru(vk_render_cache* Cache, vk_cached_object* Objects, u32* NumObjects)
+{
+    u32 LruId = VkRenderCacheFindLru(Objects, *NumObjects);
+    VkRenderCacheRetire(Cache, Objects, NumObjects, LruId);
+}
+
+inline vk_cached_object* VkRenderCacheFind(vk_render_cache* Cache, vk_cached_object* Objects, u32 NumObjects, u64 Hash)
+{
+    vk_cached_object* Result = 0;
+    for (u32 ObjectId = 0; ObjectId < NumObjects; ++ObjectId)
+    {
+        if (Objects[ObjectId].Hash == Hash)
+        {
+            Result = Objects + ObjectId;
+            Result->LastUsedFrame = Cache->CurrFrame;
+            break;
+        }
+    }
+
+    return Result;
+}
+
+inline u64 VkRenderPassHash(VkRenderPassCreateInfo* CreateInfo)
+{
+    // NOTE: Hash the full description (not just compatibility) since load/store ops and layouts change behavior
+    u64 Result = VK_HASH_INIT;
+    Result = VkHashBytes(Result, &CreateInfo->flags, sizeof(CreateInfo->flags));
+    Result = VkHashBytes(Result, &CreateInfo->attachmentCount, sizeof(CreateInfo->attachmentCount));
+    Result = VkHashBytes(Result, (void*)CreateInfo->pAttachments, sizeof(VkAttachmentDescription)*CreateInfo->attachmentCount);
+
+    Result = VkHashBytes(Result, &CreateInfo->subpassCount, sizeof(CreateInfo->subpassCount));
+    for (u32 SubPassId = 0; SubPassId < CreateInfo->subpassCount; ++SubPassId)
+    {
+        const VkSubpassDescription* SubPass = CreateInfo->pSubpasses + SubPassId;
+        Result = VkHashBytes(Result, (void*)&SubPass->flags, sizeof(SubPass->flags));
+        Result = VkHashBytes(Result, (void*)&SubPass->pipelineBindPoint, sizeof(SubPass->pipelineBindPoint));
+        
+        Result = VkHashBytes(Result, (void*)&SubPass->inputAttachmentCount, sizeof(SubPass->inputAttachmentCount));
+        Result = VkHashBytes(Result, (void*)SubPass->pInputAttachments, sizeof(VkAttachmentReference)*SubPass->inputAttachmentCount);
+
+        Result = VkHashBytes(Result, (void*)&SubPass->colorAttachmentCount, sizeof(SubPass->colorAttachmentCount));
+        Result = VkHashBytes(Result, (void*)SubPass->pColorAttachments, sizeof(VkAttachmentReference)*SubPass->colorAttachmentCount);
+
+        b32 HasResolve = SubPass->pResolveAttachments != 0;
+        Result = VkHashBytes(Result, &HasResolve, sizeof(HasResolve));
+        if (HasResolve)
+        {
+            Result = VkHashBytes(Result, (void*)SubPass->pResolveAttachments, sizeof(VkAttachmentReference)*SubPass->colorAttachmentCount);
+        }
+
+        b32 HasDepth = SubPass->pDepthStencilAttachment != 0;
+        Result = VkHashBytes(Result, &HasDepth, sizeof(HasDepth));
+        if (HasDepth)
+        {
+            Result = VkHashBytes(Result, (void*)SubPass->pDepthStencilAttachment, sizeof(VkAttachmentReference));
+        }
+
+        Result = VkHashBytes(Result, (void*)&SubPass->preserveAttachmentCount, sizeof(SubPass->preserveAttachmentCount));
+        Result = VkHashBytes(Result, (void*)SubPass->pPreserveAttachments, sizeof(u32)*SubPass->preserveAttachmentCount);
+    }
+
+    Result = VkHashBytes(Result, &CreateInfo->dependencyCount, sizeof(CreateInfo->dependencyCount));
+    Result = VkHashBytes(Result, (void*)CreateInfo->pDependencies, sizeof(VkSubpassDependency)*CreateInfo->dependencyCount);
+
+    VkRenderPassMultiviewCreateInfo* Multiview = VkRenderPassGetMultiview(CreateInfo);
+    if (Multiview)
+    {
+        Result = VkHashBytes(Result, (void*)Multiview->pViewMasks, sizeof(u32)*Multiview->subpassCount);
+        if (Multiview->pViewOffsets)
+        {
+            Result = VkHashBytes(Result, (void*)Multiview->pViewOffsets, sizeof(i32)*Multiview->dependencyCount);
+        }
+        Result = VkHashBytes(Result, (void*)Multiview->pCorrelationMasks, sizeof(u32)*Multiview->correlationMaskCount);
+    }
+
+    return Result;
+}
+
+inline void VkRenderCacheRenderPassEvict(vk_render_cache* Cache, VkRenderPass RenderPass)
+{
+    for (i32 FboId = i32(Cache->NumFbos) - 1; FboId >= 0; --FboId)
+    {
+        if (Cache->Fbos[FboId].FboRenderPass == RenderPass)
+        {
+            VkRenderCacheRetire(Cache, Cache->Fbos, &Cache->NumFbos, u32(FboId));
+        }
+    }
+
+    for (i32 RenderPassId = i32(Cache->NumRenderPasses) - 1; RenderPassId >= 0; --RenderPassId)
+    {
+        if (Cache->RenderPasses[RenderPassId].RenderPass == RenderPass)
+        {
+            VkRenderCacheRetire(Cache, Cache->RenderPasses, &Cache->NumRenderPasses, u32(RenderPassId));
+        }
+    }
+}
+
+inline VkRenderPass VkRenderCacheRenderPassGet(vk_render_cache* Cache, VkDevice Device, VkRenderPassCreateInfo* CreateInfo,
+                                               vk_pipeline_manager* Manager = 0)
+{
+    u64 Hash = VkRenderPassHash(CreateInfo);
+    vk_cached_object* Object = VkRenderCacheFind(Cache, Cache->RenderPasses, Cache->NumRenderPasses, Hash);
+    if (!Object)
+    {
+        if (Cache->NumRenderPasses == Cache->MaxNumRenderPasses)
+        {
+            // NOTE: Framebuffers are keyed on the raw render pass handle, which the driver can hand out again, so they
+            // have to go with it
+            u32 LruId = VkRenderCacheFindLru(Cache->RenderPasses, Cache->NumRenderPasses);
+            VkRenderCacheRenderPassEvict(Cache, Cache->RenderPasses[LruId].RenderPass);
+        }
+
+        Object = Cache->RenderPasses + Cache->NumRenderPasses++;
+        *Object = {};
+        Object->Type = VkCachedObject_RenderPass;
+        Object->Hash = Hash;
+        Object->LastUsedFrame = Cache->CurrFrame;
+        VkCheckResult(vkCreateRenderPass(Device, CreateInfo, 0, &Object->RenderPass));
+
+        // NOTE: Pipelines can only be saved to the manifest if the manager knows their render pass
+        if (Manager)
+        {
+            VkPipelineRenderPassAdd(Manager, Object->RenderPass, CreateInfo);
+        }
+    }
+
+    return Object->RenderPass;
+}
+
+inline void VkRenderCacheRenderPassPin(vk_render_cache* Cache, VkRenderPass RenderPass)
+{
+    for (u32 RenderPassId = 0; RenderPassId < Cache->NumRenderPasses; ++RenderPassId)
+    {
+        if (Cache->RenderPasses[RenderPassId].RenderPass == RenderPass)
+        {
+            Cache->RenderPasses[RenderPassId].NumPins += 1;
+            return;
+        }
+    }
+
+    InvalidCodePath;
+}
+
+inline void VkRenderCacheRenderPassUnpin(vk_render_cache* Cache, VkRenderPass RenderPass)
+{
+    for (u32 RenderPassId = 0; RenderPassId < Cache->NumRenderPasses; ++RenderPassId)
+    {
+        if (Cache->RenderPasses[RenderPassId].RenderPass == RenderPass)
+        {
+            Assert(Cache->RenderPasses[RenderPassId].NumPins > 0);
+            Cache->RenderPasses[RenderPassId].NumPins -= 1;
+            return;
+        }
+    }
+
+    InvalidCodePath;
+}
+
+inline VkFramebuffer VkRenderCacheFboGet(vk_render_cache* Cache, VkDevice Device, VkRenderPass RenderPass, VkImageView* Views,
+                                         u32 NumViews, u32 Width, u32 Height, u32 Layers = 1)
+{
+    Assert(NumViews <= VK_MAX_FBO_ATTACHMENTS);
+    
+    u64 Hash = VK_HASH_INIT;
+    Hash = VkHashBytes(Hash, &RenderPass, sizeof(RenderPass));
+    Hash = VkHashBytes(Hash, Views, sizeof(VkImageView)*NumViews);
+    Hash = VkHashBytes(Hash, &NumViews, sizeof(NumViews));
+    Hash = VkHashBytes(Hash, &Width, sizeof(Width));
+    Hash = VkHashBytes(Hash, &Height, sizeof(Height));
+    Hash = VkHashBytes(Hash, &Layers, sizeof(Layers));
+    
+    vk_cached_object* Object = VkRenderCacheFind(Cache, Cache->Fbos, Cache->NumFbos, Hash);
+    if (!Object)
+    {
+        if (Cache->NumFbos == Cache->MaxNumFbos)
+        {
+            VkRenderCacheEvictLru(Cache, Cache->Fbos, &Cache->NumFbos);
+        }
+
+        Object = Cache->Fbos + Cache->NumFbos++;
+        *Object = {};
+        Object->Type = VkCachedObject_Framebuffer;
+        Object->Hash = Hash;
+        Object->LastUsedFrame = Cache->CurrFrame;
+        Object->FboRenderPass = RenderPass;
+        Object->NumViews = NumViews;
+        Copy(Views, Object->Views, sizeof(VkImageView)*NumViews);
+        Object->Framebuffer = VkFboCreate(Device, RenderPass, Views, NumViews, Width, Height, Layers);
+    }
+
+    return Object->Framebuffer;
+}
+
+inline void VkRenderCacheFboPin(vk_render_cache* Cache, VkFramebuffer Framebuffer)
+{
+    for (u32 FboId = 0; FboId < Cache->NumFbos; ++FboId)
+    {
+        if (Cache->Fbos[FboId].Framebuffer == Framebuffer)
+        {
+            Cache->Fbos[FboId].NumPins += 1;
+            return;
+        }
+    }
+
+    InvalidCodePath;
+}
+
+inline void VkRenderCacheFboUnpin(vk_render_cache* Cache, VkFramebuffer Framebuffer)
+{
+    // NOTE: Evicting its views or render pass retires a framebuffer even if it is pinned, then there is nothing to unpin
+    for (u32 FboId = 0; FboId < Cache->NumFbos; ++FboId)
+    {
+        if (Cache->Fbos[FboId].Framebuffer == Framebuffer)
+        {
+            Assert(Cache->Fbos[FboId].NumPins > 0);
+            Cache->Fbos[FboId].NumPins -= 1;
+            return;
+        }
+    }
+}
+
+inline void VkFboReCreate(VkDevice Device, vk_render_cache* Cache, VkRenderPass Rp, VkImageView* Views, u32 NumViews,
+                          VkFramebuffer* Fbo, u32 Width, u32 Height, u32 Layers = 1)
+{
+    // NOTE: Callers keep *Fbo across frames without touching the cache, so it stays pinned until the next recreate or
+    // until they pass it to VkRenderCacheFboUnpin. The old one stays in the cache and gets evicted once unused
+    VkFramebuffer NewFbo = VkRenderCacheFboGet(Cache, Device, Rp, Views, NumViews, Width, Height, Layers);
+    VkRenderCacheFboPin(Cache, NewFbo);
+    if (*Fbo != VK_NULL_HANDLE)
+    {
+        VkRenderCacheFboUnpin(Cache, *Fbo);
+    }
+    *Fbo = NewFbo;
+}
+
+inline void VkRenderCacheViewEvict(vk_render_cache* Cache, VkImageView View)
+{
+    // NOTE: Iterate backwards since retiring swaps the last object into the current slot
+    for (i32 FboId = i32(Cache->NumFbos) - 1; FboId >= 0; --FboId)
+    {
+        vk_cached_object* Fbo = Cache->Fbos + FboId;
+        for (u32 ViewId = 0; ViewId < Fbo->NumViews; ++ViewId)
+        {
+            if (Fbo->Views[ViewId] == View)
+            {
+                VkRenderCacheRetire(Cache, Cache->Fbos, &Cache->NumFbos, u32(FboId));
+                break;
+            }
+        }
+    }
+}
+
+inline void VkRenderCacheFrameBegin(vk_render_cache* Cache, VkDevice Device)
+{
+    // IMPORTANT: Must be called after waiting on the fence of the frame slot we are about to reuse
+    Cache->CurrFrame += 1;
+    
+    for (i32 RetiredId = i32(Cache->NumRetired) - 1; RetiredId >= 0; --RetiredId)
+    {
+        vk_cached_object* Retired = Cache->RetiredArray + RetiredId;
+        if ((Retired->LastUsedFrame + Cache->NumFramesInFlight) <= Cache->CurrFrame)
+        {
+            VkRenderCacheObjectDestroy(Device, Retired);
+            Cache->NumRetired -= 1;
+            *Retired = Cache->RetiredArray[Cache->NumRetired];
+        }
+    }
+}
+
+inline void VkRenderCacheDestroy(vk_render_cache* Cache, VkDevice Device)
+{
+    // IMPORTANT: Caller has to make sure the device is idle
+    for (u32 FboId = 0; FboId < Cache->NumFbos; ++FboId)
+    {
+        VkRenderCacheObjectDestroy(Device, Cache->Fbos + FboId);
+    }
+    for (u32 RenderPassId = 0; RenderPassId < Cache->NumRenderPasses; ++RenderPassId)
+    {
+        VkRenderCacheObjectDestroy(Device, Cache->RenderPasses + RenderPassId);
+    }
+    for (u32 RetiredId = 0; RetiredId < Cache->NumRetired; ++RetiredId)
+    {
+        VkRenderCacheObjectDestroy(Device, Cache->RetiredArray + RetiredId);
+    }
+
+    Cache->NumFbos = 0;
+    Cache->NumRenderPasses = 0;
+    Cache->NumRetired = 0;
 }
 
 //
@@ -540,13 +1078,19 @@ inline void VkDescriptorLayoutAdd(vk_descriptor_layout_builder* Builder, VkDescr
     Builder->Bindings[Id].stageFlags = StageFlags;
 }
 
-inline void VkDescriptorLayoutEnd(VkDevice Device, vk_descriptor_layout_builder* Builder)
+inline void VkDescriptorLayoutEnd(VkDevice Device, vk_descriptor_layout_builder* Builder, vk_pipeline_manager* Manager = 0)
 {
     VkDescriptorSetLayoutCreateInfo DSLayoutCreateInfo = {};
     DSLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     DSLayoutCreateInfo.bindingCount = Builder->CurrNumBindings;
     DSLayoutCreateInfo.pBindings = Builder->Bindings;
     VkCheckResult(vkCreateDescriptorSetLayout(Device, &DSLayoutCreateInfo, 0, Builder->Layout));
+
+    // NOTE: Pipelines can only be saved to the manifest if the manager knows their layouts
+    if (Manager)
+    {
+        VkPipelineDescriptorLayoutAdd(Manager, *Builder->Layout, &DSLayoutCreateInfo);
+    }
 }
 
 //
@@ -649,6 +1193,7 @@ inline vk_render_pass_builder VkRenderPassBuilderBegin(linear_arena* Arena)
     // IMPORTANT: These arrays should be larger if these sizes aren't enough
     Result.MaxNumAttachments = 10;
     Result.Attachments = PushArray(Arena, VkAttachmentDescription, Result.MaxNumAttachments);
+    Result.AttachmentHints = PushArray(Arena, u32, Result.MaxNumAttachments);
 
     Result.MaxNumDependencies = 10;
     Result.Dependencies = PushArray(Arena, VkSubpassDependency, Result.MaxNumDependencies);
@@ -667,6 +1212,10 @@ inline vk_render_pass_builder VkRenderPassBuilderBegin(linear_arena* Arena)
 
     Result.MaxNumSubPasses = 10;
     Result.SubPasses = PushArray(Arena, VkSubpassDescription, Result.MaxNumSubPasses);
+    Result.SubPassViewMasks = PushArray(Arena, u32, Result.MaxNumSubPasses);
+
+    Result.MaxNumCorrelationMasks = 10;
+    Result.CorrelationMasks = PushArray(Arena, u32, Result.MaxNumCorrelationMasks);
     
     return Result;
 }
@@ -688,6 +1237,7 @@ inline u32 VkRenderPassAttachmentAdd(vk_render_pass_builder* Builder, VkFormat F
     Color->stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     Color->initialLayout = InitialLayout;
     Color->finalLayout = FinalLayout;
+    Builder->AttachmentHints[Id] = 0;
 
     return Id;
 }
@@ -699,6 +1249,55 @@ inline u32 VkRenderPassAttachmentAdd(vk_render_pass_builder* Builder, VkFormat F
     return Result;
 }
 
+inline void VkRenderPassAttachmentHint(vk_render_pass_builder* Builder, u32 AttachmentId, u32 HintFlags)
+{
+    Assert(AttachmentId < Builder->NumAttachments);
+    Builder->AttachmentHints[AttachmentId] |= HintFlags;
+}
+
+inline u32 VkFrameUsageResourceAdd(vk_frame_usage* Usage, u32 Flags)
+{
+    Assert(Usage->NumResources < VK_MAX_FRAME_RESOURCES);
+
+    u32 Result = Usage->NumResources++;
+    vk_frame_resource_usage* Resource = Usage->Resources + Result;
+    Resource->Flags = Flags;
+    Resource->FirstPassId = 0xFFFFFFFF;
+    Resource->LastPassId = 0;
+
+    return Result;
+}
+
+inline void VkFrameUsageMark(vk_frame_usage* Usage, u32 ResourceId, u32 PassId)
+{
+    // NOTE: Mark every pass that reads or writes the resource, including sampling and copies outside render passes
+    Assert(ResourceId < Usage->NumResources);
+    vk_frame_resource_usage* Resource = Usage->Resources + ResourceId;
+    Resource->FirstPassId = Min(Resource->FirstPassId, PassId);
+    Resource->LastPassId = Max(Resource->LastPassId, PassId);
+}
+
+inline void VkRenderPassAttachmentResource(vk_render_pass_builder* Builder, u32 AttachmentId, vk_frame_usage* Usage, u32 ResourceId,
+                                           u32 PassId)
+{
+    // NOTE: Derives hints from the whole frame, so the frame usage has to be fully marked before building passes
+    Assert(ResourceId < Usage->NumResources);
+    vk_frame_resource_usage* Resource = Usage->Resources + ResourceId;
+    Assert(Resource->FirstPassId <= PassId && PassId <= Resource->LastPassId);
+
+    u32 HintFlags = 0;
+    if (Resource->FirstPassId == PassId && !(Resource->Flags & VkFrameResource_Imported))
+    {
+        HintFlags |= VkAttachmentHint_NoPriorContents;
+    }
+    if (Resource->LastPassId == PassId && !(Resource->Flags & VkFrameResource_Exported))
+    {
+        HintFlags |= VkAttachmentHint_NoLaterReads;
+    }
+
+    VkRenderPassAttachmentHint(Builder, AttachmentId, HintFlags);
+}
+
 inline void VkRenderPassSubPassBegin(vk_render_pass_builder* Builder, VkPipelineBindPoint BindPoint)
 {
     Assert(Builder->NumSubPasses < Builder->MaxNumSubPasses);
@@ -706,6 +1305,7 @@ inline void VkRenderPassSubPassBegin(vk_render_pass_builder* Builder, VkPipeline
     VkSubpassDescription* SubPass = Builder->SubPasses + Builder->NumSubPasses;
     *SubPass = {};
     SubPass->pipelineBindPoint = BindPoint;
+    Builder->SubPassViewMasks[Builder->NumSubPasses] = 0;
     SubPass->pColorAttachments = Builder->ColorAttachmentRefs + Builder->NumColorAttachmentRefs;
     SubPass->pInputAttachments = Builder->InputAttachmentRefs + Builder->NumInputAttachmentRefs;
 }
@@ -777,6 +1377,19 @@ inline void VkRenderPassDepthRefAdd(vk_render_pass_builder* Builder, u32 Attachm
     Reference->layout = Layout;
 }
 
+inline void VkRenderPassViewMaskSet(vk_render_pass_builder* Builder, u32 ViewMask)
+{
+    // NOTE: Bit N renders the subpass to layer N of every attachment, e.g. 0x3F renders all cube faces in one draw
+    Builder->SubPassViewMasks[Builder->NumSubPasses] = ViewMask;
+}
+
+inline void VkRenderPassCorrelationMaskAdd(vk_render_pass_builder* Builder, u32 CorrelationMask)
+{
+    // NOTE: Hints that these views are spatially close (stereo eyes) so the driver can share work between them
+    Assert(Builder->NumCorrelationMasks < Builder->MaxNumCorrelationMasks);
+    Builder->CorrelationMasks[Builder->NumCorrelationMasks++] = CorrelationMask;
+}
+
 inline void VkRenderPassSubPassEnd(vk_render_pass_builder* Builder)
 {
     Builder->NumSubPasses++;
@@ -807,7 +1420,68 @@ inline void VkRenderPassDependency(vk_render_pass_builder* Builder, VkPipelineSt
     Dependency->dependencyFlags = DependencyFlags;
 }
 
-inline VkRenderPass VkRenderPassBuilderEnd(vk_render_pass_builder* Builder, VkDevice Device)
+inline void VkRenderPassOptimizeOps(vk_render_pass_builder* Builder)
+{
+    // NOTE: Downgrade loads/stores that can't be observed to DONT_CARE so tilers skip the memory traffic
+    vk_render_pass_report* Report = &Builder->Report;
+    *Report = {};
+    
+    for (u32 AttachmentId = 0; AttachmentId < Builder->NumAttachments; ++AttachmentId)
+    {
+        VkAttachmentDescription* Attachment = Builder->Attachments + AttachmentId;
+        u32 Hints = Builder->AttachmentHints[AttachmentId];
+        u32 PixelSize = VkFormatGetSize(Attachment->format) * u32(Attachment->samples);
+
+        // NOTE: Loading from an undefined layout gives undefined contents anyway
+        b32 NoPriorContents = (Hints & VkAttachmentHint_NoPriorContents) || Attachment->initialLayout == VK_IMAGE_LAYOUT_UNDEFINED;
+        if (NoPriorContents && Attachment->loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+        {
+            Attachment->loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            Report->NumLoadsSkipped += 1;
+            Report->BytesPerPixelSaved += PixelSize;
+        }
+        if (NoPriorContents && Attachment->stencilLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+        {
+            Attachment->stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            Report->NumLoadsSkipped += 1;
+        }
+
+        b32 NoLaterReads = (Hints & VkAttachmentHint_NoLaterReads) != 0;
+        if (NoLaterReads && Attachment->storeOp == VK_ATTACHMENT_STORE_OP_STORE)
+        {
+            Attachment->storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            Report->NumStoresSkipped += 1;
+            Report->BytesPerPixelSaved += PixelSize;
+        }
+        if (NoLaterReads && Attachment->stencilStoreOp == VK_ATTACHMENT_STORE_OP_STORE)
+        {
+            Attachment->stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            Report->NumStoresSkipped += 1;
+        }
+
+        // NOTE: Never loaded or stored means the attachment only lives inside this pass
+        b32 IsTransient = (Attachment->loadOp != VK_ATTACHMENT_LOAD_OP_LOAD && Attachment->storeOp != VK_ATTACHMENT_STORE_OP_STORE &&
+                           Attachment->stencilLoadOp != VK_ATTACHMENT_LOAD_OP_LOAD &&
+                           Attachment->stencilStoreOp != VK_ATTACHMENT_STORE_OP_STORE);
+        if (IsTransient)
+        {
+            Report->TransientMask |= 1 << AttachmentId;
+            Report->TransientBytesPerPixel += PixelSize;
+        }
+    }
+}
+
+inline void VkRenderPassReportPrint(vk_render_pass_report* Report, char* Name, u32 Width, u32 Height)
+{
+    char Buffer[512];
+    snprintf(Buffer, sizeof(Buffer), "%s: skipped %u loads, %u stores, saving %.2fMB/frame at %ux%u. Transient mask 0x%x (%.2fMB could be lazily allocated)\n",
+             Name, Report->NumLoadsSkipped, Report->NumStoresSkipped, f32(Report->BytesPerPixelSaved) * f32(Width*Height) / f32(MegaBytes(1)),
+             Width, Height, Report->TransientMask, f32(Report->TransientBytesPerPixel) * f32(Width*Height) / f32(MegaBytes(1)));
+    OutputDebugStringA(Buffer);
+}
+
+inline VkRenderPass VkRenderPassBuilderEnd(vk_render_pass_builder* Builder, VkDevice Device, vk_render_cache* Cache,
+                                           vk_pipeline_manager* Manager = 0)
 {
     VkRenderPass Result = {};
 
@@ -819,6 +1493,8 @@ inline VkRenderPass VkRenderPassBuilderEnd(vk_render_pass_builder* Builder, VkDe
             Builder->Dependencies[DependencyId].dstSubpass = VK_SUBPASS_EXTERNAL;
         }
     }
+
+    VkRenderPassOptimizeOps(Builder);
     
     VkRenderPassCreateInfo RenderPassCreateInfo = {};
     RenderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -828,13 +1504,52 @@ inline VkRenderPass VkRenderPassBuilderEnd(vk_render_pass_builder* Builder, VkDe
     RenderPassCreateInfo.pSubpasses = Builder->SubPasses;
     RenderPassCreateInfo.dependencyCount = Builder->NumDependencies;
     RenderPassCreateInfo.pDependencies = Builder->Dependencies;
-    VkCheckResult(vkCreateRenderPass(Device, &RenderPassCreateInfo, 0, &Result));
 
+    // NOTE: Multiview has to be on for all subpasses or none of them
+    u32 NumMultiviewSubPasses = 0;
+    for (u32 SubPassId = 0; SubPassId < Builder->NumSubPasses; ++SubPassId)
+    {
+        NumMultiviewSubPasses += Builder->SubPassViewMasks[SubPassId] != 0;
+    }
+    Assert(NumMultiviewSubPasses == 0 || NumMultiviewSubPasses == Builder->NumSubPasses);
+
+    VkRenderPassMultiviewCreateInfo MultiviewCreateInfo = {};
+    if (NumMultiviewSubPasses > 0)
+    {
+        MultiviewCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO;
+        MultiviewCreateInfo.subpassCount = Builder->NumSubPasses;
+        MultiviewCreateInfo.pViewMasks = Builder->SubPassViewMasks;
+        MultiviewCreateInfo.correlationMaskCount = Builder->NumCorrelationMasks;
+        MultiviewCreateInfo.pCorrelationMasks = Builder->CorrelationMasks;
+        RenderPassCreateInfo.pNext = &MultiviewCreateInfo;
+    }
+
+    if (Cache)
+    {
+        Result = VkRenderCacheRenderPassGet(Cache, Device, &RenderPassCreateInfo, Manager);
+    }
+    else
+    {
+        VkCheckResult(vkCreateRenderPass(Device, &RenderPassCreateInfo, 0, &Result));
+
+        // NOTE: Pipelines can only be saved to the manifest if the manager knows their render pass
+        if (Manager)
+        {
+            VkPipelineRenderPassAdd(Manager, Result, &RenderPassCreateInfo);
+        }
+    }
+    
     EndTempMem(Builder->TempMem);
     
     return Result;
 }
 
+inline VkRenderPass VkRenderPassBuilderEnd(vk_render_pass_builder* Builder, VkDevice Device, vk_pipeline_manager* Manager = 0)
+{
+    VkRenderPass Result = VkRenderPassBuilderEnd(Builder, Device, (vk_render_cache*)0, Manager);
+    return Result;
+}
+
 //
 // NOTE: Compute Shader Helpers
 //
@@ -842,8 +1557,9 @@ inline VkRenderPass VkRenderPassBuilderEnd(vk_render_pass_builder* Builder, VkDe
 inline void VkComputeDispatch(vk_commands* Commands, vk_pipeline* Pipeline, VkDescriptorSet* DescriptorSets, u32 NumDescriptorSets, u32 DispatchX,
                               u32 DispatchY, u32 DispatchZ)
 {
-    vkCmdBindPipeline(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
-    vkCmdBindDescriptorSets(Commands->Buffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0,
-                            NumDescriptorSets, DescriptorSets, 0, 0);
+    VkGpuScopeBegin(Commands, "ComputeDispatch");
+    VkCommandsBindPipeline(Commands, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Handle);
+    VkCommandsBindDescriptorSets(Commands, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline->Layout, 0, NumDescriptorSets, DescriptorSets);
     vkCmdDispatch(Commands->Buffer, DispatchX, DispatchY, DispatchZ);
+    VkGpuScopeEnd(Commands);
 }
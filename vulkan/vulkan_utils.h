@@ -3,7 +3,12 @@
 #include "math\math.h"
 #include "vulkan_memory.h"
 #include "vulkan_pipeline.h"
+#include "vulkan_profiler.h"
 #include "vulkan_cmd_buffer.h"
+#include "vulkan_packets.h"
+#include "vulkan_indirect.h"
+#include "vulkan_streamer.h"
+#include "vulkan_mips.h"
 
 //
 // NOTE: Descriptor Layout Builder
@@ -21,6 +26,49 @@ struct vk_descriptor_layout_builder
 // NOTE: Render Pass Builder
 //
 
+// NOTE: Hints that let VkRenderPassBuilderEnd downgrade load/store ops to DONT_CARE
+enum vk_attachment_hint_flags
+{
+    VkAttachmentHint_NoPriorContents = 1 << 0, // NOTE: Nothing before this pass wrote data that this pass needs
+    VkAttachmentHint_NoLaterReads = 1 << 1, // NOTE: Nothing after this pass reads the attachment
+
+    VkAttachmentHint_Transient = VkAttachmentHint_NoPriorContents | VkAttachmentHint_NoLaterReads,
+};
+
+enum vk_frame_resource_flags
+{
+    VkFrameResource_Imported = 1 << 0, // NOTE: Contents from before the frame are used (history buffers, etc)
+    VkFrameResource_Exported = 1 << 1, // NOTE: Contents are used after the frame (swapchain, history buffers, etc)
+};
+
+// NOTE: Per frame description of which passes touch which images, used to derive hints across multiple render passes
+#define VK_MAX_FRAME_RESOURCES 64
+struct vk_frame_resource_usage
+{
+    u32 Flags;
+    u32 FirstPassId;
+    u32 LastPassId;
+};
+
+struct vk_frame_usage
+{
+    u32 NumResources;
+    vk_frame_resource_usage Resources[VK_MAX_FRAME_RESOURCES];
+};
+
+struct vk_render_pass_report
+{
+    u32 NumLoadsSkipped;
+    u32 NumStoresSkipped;
+
+    // NOTE: Bit per attachment, these can be created with VkTransientImageCreate
+    u32 TransientMask;
+
+    // NOTE: Multiply by the render area to get bytes saved per frame
+    u32 BytesPerPixelSaved;
+    u32 TransientBytesPerPixel;
+};
+
 struct vk_render_pass_builder
 {
     temp_mem TempMem;
@@ -30,6 +78,7 @@ struct vk_render_pass_builder
     u32 MaxNumAttachments;
     u32 NumAttachments;
     VkAttachmentDescription* Attachments;
+    u32* AttachmentHints;
 
     // NOTE: Dependencies
     u32 MaxNumDependencies;
@@ -55,7 +104,69 @@ struct vk_render_pass_builder
     u32 MaxNumSubPasses;
     u32 NumSubPasses;
     VkSubpassDescription* SubPasses;
+
+    // NOTE: Multiview data, a view mask of 0 for every subpass means multiview is off
+    u32* SubPassViewMasks;
+    u32 MaxNumCorrelationMasks;
+    u32 NumCorrelationMasks;
+    u32* CorrelationMasks;
+
+    // NOTE: Filled in by VkRenderPassBuilderEnd
+    vk_render_pass_report Report;
+};
+
+//
+// NOTE: Render Pass + Framebuffer Cache
+//
+
+#define VK_MAX_FBO_ATTACHMENTS 8
+
+enum vk_cached_object_type
+{
+    VkCachedObject_None,
+
+    VkCachedObject_RenderPass,
+    VkCachedObject_Framebuffer,
+};
+
+struct vk_cached_object
+{
+    vk_cached_object_type Type;
+    u64 Hash;
+    u64 LastUsedFrame;
+
+    // NOTE: Pinned objects are skipped by LRU eviction, for users that hold on to the handle across frames
+    u32 NumPins;
     
+    union
+    {
+        VkRenderPass RenderPass;
+        VkFramebuffer Framebuffer;
+    };
+
+    // NOTE: Only set for framebuffers, used to evict them when a view gets destroyed
+    VkRenderPass FboRenderPass;
+    u32 NumViews;
+    VkImageView Views[VK_MAX_FBO_ATTACHMENTS];
+};
+
+struct vk_render_cache
+{
+    u64 CurrFrame;
+    u32 NumFramesInFlight;
+
+    u32 MaxNumRenderPasses;
+    u32 NumRenderPasses;
+    vk_cached_object* RenderPasses;
+
+    u32 MaxNumFbos;
+    u32 NumFbos;
+    vk_cached_object* Fbos;
+
+    // NOTE: Evicted objects wait here until no frame in flight can reference them
+    u32 MaxNumRetired;
+    u32 NumRetired;
+    vk_cached_object* RetiredArray;
 };
 
 //
@@ -81,11 +192,24 @@ struct vk_image
     VkImageView View;
 };
 
+#include "vulkan_render_graph.h"
+#include "vulkan_headless.h"
+
+#define VK_HASH_INIT 14695981039346656037ull
+
 internal void VkCheckResult(VkResult Result);
+inline u64 VkHashBytes(u64 Hash, void* Data, mm Size);
 inline VkBuffer VkBufferHandleCreate(VkDevice Device, VkBufferUsageFlags Usage, u64 BufferSize);
 inline VkMemoryRequirements VkBufferGetMemoryRequirements(VkDevice Device, VkBuffer Buffer);
 
 #include "vulkan_memory.cpp"
 #include "vulkan_pipeline.cpp"
+#include "vulkan_profiler.cpp"
 #include "vulkan_cmd_buffer.cpp"
+#include "vulkan_packets.cpp"
 #include "vulkan_utils.cpp"
+#include "vulkan_indirect.cpp"
+#include "vulkan_streamer.cpp"
+#include "vulkan_mips.cpp"
+#include "vulkan_render_graph.cpp"
+#include "vulkan_headless.cpp"